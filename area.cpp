@@ -16,25 +16,83 @@
 #include <iostream>
 #include <unordered_map>
 #include <map>
+#include <memory_resource>
+#include <algorithm>
+#include <vector>
+#include <utility>
 
 #include "lib_json.hpp"
 #include "area.h"
 #include "bethyw.h"
+#include "jsonwriter.h"
+#include "intern.h"
+#include "splice.h"
+#include "stats.h"
 
 /*
   An alias for the imported JSON parsing library.
 */
 using json = nlohmann::json;
 
+/*Returns a copy of the given local authority code in uppercase, allocated with the given allocator.*/
+static std::pmr::string upperCaseCode(std::string_view localAuthorityCode, const Area::allocator_type& alloc) {
+    std::pmr::string code(localAuthorityCode, alloc);
+    std::for_each(code.begin(), code.end(), [](char& c) {
+        c = ::toupper(c);
+    });
+
+    return code;
+}
+
 /*
   Construct an Area with a given local authority code.
 
   @param localAuthorityCode
     The local authority code of the Area
+
+  @param alloc
+    The allocator of the code, names and measures, e.g. one using the arena of
+    the Areas object the area is stored in (see areas.h); the default one if
+    not given
 */
-Area::Area(const std::string& localAuthorityCode) : authorityCode(BethYw::toUpper(localAuthorityCode)),
-                                                    names(std::unordered_map<std::string, std::string>()),
-                                                    measures(std::map<std::string, Measure>()) {
+Area::Area(std::string_view localAuthorityCode, const allocator_type& alloc) :
+        authorityCode(upperCaseCode(localAuthorityCode, alloc)),
+        names(alloc),
+        measures(alloc) {
+
+}
+
+/*
+  Construct a copy of an Area whose names and measures are allocated with the
+  given allocator. Containers that use a polymorphic allocator call this to
+  copy an Area into their own memory.
+
+  @param other
+    The Area to copy
+
+  @param alloc
+    The allocator of the code, names and measures of the copy
+*/
+Area::Area(const Area& other, const allocator_type& alloc) : authorityCode(other.authorityCode, alloc),
+                                                             names(other.names, alloc),
+                                                             measures(other.measures, alloc) {
+
+}
+
+/*
+  Construct an Area from another one whose names and measures are allocated
+  with the given allocator. The nodes of the other Area are taken over if it
+  uses the same allocator, and their contents moved into new nodes otherwise.
+
+  @param other
+    The Area to move from, which is left in a valid but unspecified state
+
+  @param alloc
+    The allocator of the code, names and measures of the new Area
+*/
+Area::Area(Area&& other, const allocator_type& alloc) : authorityCode(other.authorityCode, alloc),
+                                                        names(std::move(other.names), alloc),
+                                                        measures(std::move(other.measures), alloc) {
 
 }
 
@@ -43,10 +101,10 @@ Area::Area(const std::string& localAuthorityCode) : authorityCode(BethYw::toUppe
   callable from a constant context and not modify the state of the instance.
   
   @return
-    The Area's local authority code
+    A copy of the Area's local authority code
 */
-const std::string& Area::getLocalAuthorityCode() const noexcept {
-    return authorityCode;
+std::string Area::getLocalAuthorityCode() const {
+    return std::string(authorityCode);
 }
 
 /*
@@ -57,14 +115,20 @@ const std::string& Area::getLocalAuthorityCode() const noexcept {
     A three-leter language code in ISO 639-3 format, e.g. cym or eng
 
   @return
-    The name for the area in the given language
+    A copy of the name for the area in the given language
 
   @throws
     std::out_of_range if lang does not correspond to a language of a name stored
     inside the Area instance
 */
-const std::string& Area::getName(const std::string& langCode) const {
-    return names.at(langCode);
+std::string Area::getName(const std::string& langCode) const {
+    return std::string(name(langCode));
+}
+
+/*Returns the name for the area in the given language as it is stored, like getName() but without copying it.*/
+const std::pmr::string& Area::name(const std::string& langCode) const {
+    //a three-letter key fits inside the string, so it allocates nothing
+    return names.at(std::pmr::string(langCode));
 }
 
 /*
@@ -77,7 +141,25 @@ const std::string& Area::getName(const std::string& langCode) const {
     True if the area has a name for that language code.
 */
 bool Area::hasName(const std::string& langCode) const {
-    return names.find(langCode) != names.end();
+    return names.find(std::pmr::string(langCode)) != names.end();
+}
+
+/*Returns the name the area is output with: its English and Welsh names separated by a slash, whichever one it has,
+ * or "Unnamed".*/
+std::string Area::displayName() const {
+    bool hasEnglishName = hasName("eng");
+    bool hasWelshName = hasName("cym");
+
+    if (hasEnglishName && hasWelshName) {
+        std::string displayName(name("eng"));
+        return displayName.append(" / ").append(name("cym"));
+    } else if (hasEnglishName) {
+        return std::string(name("eng"));
+    } else if (hasWelshName) {
+        return std::string(name("cym"));
+    } else {
+        return "Unnamed";
+    }
 }
 
 /*
@@ -111,7 +193,7 @@ void Area::setName(const std::string& lang, const std::string& name) {
 
     /*param reference could be to a string outside the function we should not
      *change, therefore we make a copy before we make the string lower case.*/
-    std::string lowerCaseLanguageCode = BethYw::toLower(lang);
+    std::pmr::string lowerCaseLanguageCode(BethYw::toLower(lang), names.get_allocator());
     names[lowerCaseLanguageCode] = name;
 }
 
@@ -135,11 +217,16 @@ Measure& Area::getMeasure(const std::string& key) {
      *change, therefore we make a copy before we make the string lower case.*/
     std::string lowerCaseKey = BethYw::toLower(key);
 
-    try {
-        return measures.at(key);
-    } catch (std::out_of_range& ex) {
-        throw std::out_of_range(std::string("No measure found matching ") + key);
+    //a codename that was never interned can not be the key of a measure
+    BethYw::Intern::Id id;
+    if (BethYw::Intern::find(lowerCaseKey, id)) {
+        auto it = measures.find(id);
+        if (it != measures.end()) {
+            return it->second;
+        }
     }
+
+    throw std::out_of_range(std::string("No measure found matching ") + key);
 }
 
 /*
@@ -165,11 +252,85 @@ void Area::setMeasure(const std::string& codename, const Measure& measure) noexc
      *change, therefore we make a copy before we make the string lower case.*/
     std::string lowerCaseName = BethYw::toLower(codename);
 
-    if (measures.find(lowerCaseName) == measures.end()) {
-        measures.insert(std::pair<std::string, Measure>(lowerCaseName, measure));
-    } else {
-        measures.find(lowerCaseName)->second = measure;
+    setMeasure(BethYw::Intern::intern(lowerCaseName), measure);
+}
+
+/*
+  Add a particular Measure to this Area object, like setMeasure() above, but
+  taking over the values of the Measure instead of copying them where it can:
+  a new Measure is moved into this Area, and a Measure with the same codename
+  is merged with Measure::mergeFrom().
+
+  @param codename
+    The codename for the Measure
+
+  @param measure
+    The Measure object, which is left in a valid but unspecified state
+
+  @return
+    void
+*/
+void Area::setMeasure(const std::string& codename, Measure&& measure) noexcept {
+    std::string lowerCaseName = BethYw::toLower(codename);
+
+    setMeasure(BethYw::Intern::intern(lowerCaseName), std::move(measure));
+}
+
+/*Adds or merges a Measure like setMeasure() above, with the ID of its lowercase codename as the key. try_emplace()
+ * only constructs the Measure when the key is not there yet, so the key is looked up once either way.*/
+void Area::setMeasure(BethYw::Intern::Id key, const Measure& measure) noexcept {
+    auto result = measures.try_emplace(key, measure);
+
+    if (!result.second) {
+        result.first->second = measure;
+    }
+}
+
+/*Moves or merges a Measure like setMeasure() above, with the ID of its lowercase codename as the key.*/
+void Area::setMeasure(BethYw::Intern::Id key, Measure&& measure) noexcept {
+    auto result = measures.try_emplace(key, std::move(measure));
+
+    if (!result.second) {
+        result.first->second.mergeFrom(std::move(measure));
+    }
+}
+
+/*
+  Set the value of a Measure for a given year, creating the Measure in place if
+  this Area does not have one with the given codename yet. This gives the same
+  result as building a Measure with a single value and passing it to
+  setMeasure(), but without constructing and merging a temporary Measure, so no
+  memory is allocated when the Measure already exists.
+
+  @param codename
+    The codename for the Measure, which will be converted to lowercase
+
+  @param label
+    Human-readable label for the Measure, only used if it has to be created
+
+  @param year
+    The year to set a value for
+
+  @param value
+    The value for the given year
+*/
+void Area::upsertValue(const std::string& codename, const std::string& label, unsigned int year, double value) {
+    /*The lowercase codename is kept between calls so that its memory is reused, instead of making a new string for
+     * every value like BethYw::toLower does.*/
+    thread_local std::string lowerCaseName;
+    lowerCaseName.assign(codename);
+    std::for_each(lowerCaseName.begin(), lowerCaseName.end(), [](char& c) {
+        c = ::tolower(c);
+    });
+
+    const BethYw::Intern::Id key = BethYw::Intern::intern(lowerCaseName);
+
+    auto it = measures.find(key);
+    if (it == measures.end()) {
+        it = measures.try_emplace(key, codename, label).first;
     }
+
+    it->second.setValue(year, value);
 }
 
 /*
@@ -184,6 +345,23 @@ int Area::size() const noexcept {
     return measures.size();
 }
 
+/*Returns the measures of this area with their (lowercase) codenames, sorted by codename, which is the order they are
+ * output in.*/
+std::vector<std::pair<const std::string*, const Measure*>> Area::sortedMeasures() const {
+    std::vector<std::pair<const std::string*, const Measure*>> sorted;
+    sorted.reserve(measures.size());
+
+    for (auto it = measures.begin(); it != measures.end(); it++) {
+        sorted.emplace_back(&BethYw::Intern::lookup(it->first), &it->second);
+    }
+
+    std::sort(sorted.begin(), sorted.end(), [](const auto& lhs, const auto& rhs) {
+        return *lhs.first < *rhs.first;
+    });
+
+    return sorted;
+}
+
 /*
   Overload the stream output operator as a free/global function.
 
@@ -209,31 +387,33 @@ int Area::size() const noexcept {
     Reference to the output stream
 */
 std::ostream& operator<<(std::ostream& stream, const Area& area) {
-    bool hasEnglishName = area.hasName("eng");
-    bool hasWelshName = area.hasName("cym");
+    area.writeTables(stream, nullptr);
+    return stream;
+}
 
-    if (hasEnglishName && hasWelshName) {
-        stream << area.getName("eng") << " / " << area.getName("cym");
-    } else if (hasEnglishName) {
-        stream << area.getName("eng");
-    } else if (hasWelshName) {
-        stream << area.getName("cym");
-    } else {
-        stream << "Unnamed";
-    }
+/*
+  Write the Area like the << operator does, optionally with the statistics of
+  every measure as more columns of its table (see Measure::writeTable()).
 
-    stream << " (" << area.getLocalAuthorityCode() << ")" << std::endl;
+  @param stream
+    The output stream to write to
 
-    if(!area.measures.empty()) {
-        for (auto it = area.measures.begin(); it != area.measures.end(); it++) {
-            stream << it->second << std::endl;
+  @param stats
+    The statistics of the measures of this Area, or nullptr to write the
+    tables without them
+*/
+void Area::writeTables(std::ostream& stream, const StatsTable* stats) const {
+    stream << displayName() << " (" << authorityCode << ")" << '\n';
+
+    if(!measures.empty()) {
+        auto sorted = sortedMeasures();
+        for (auto it = sorted.begin(); it != sorted.end(); it++) {
+            it->second->writeTable(stream, stats == nullptr ? nullptr : stats->find(*it->second));
+            stream << '\n';
         }
     } else {
-        stream << "<no measures>" << std::endl << std::endl;
+        stream << "<no measures>" << '\n' << '\n';
     }
-
-
-    return stream;
 }
 
 /*
@@ -252,7 +432,7 @@ std::ostream& operator<<(std::ostream& stream, const Area& area) {
     and data; false otherwise.
 */
 bool operator==(const Area& lhs, const Area& rhs) {
-    if (lhs.getLocalAuthorityCode() == rhs.getLocalAuthorityCode()) {
+    if (lhs.authorityCode == rhs.authorityCode) {
         if (lhs.names == rhs.names) {
             if (lhs.measures == rhs.measures) {
                 return true;
@@ -280,27 +460,158 @@ Area& Area::operator=(const Area& other) {
     }
 
     for (auto it = other.measures.begin(); it != other.measures.end(); it++) {
-        /*We need to check if each measure of other is already in this area. This is because Measure has no constructor
-         * with no arguments, and therefore it can not be called if we just did this->measure[it->first] = it->second.
-         * When the measure is not already in this area, we need to manually make a pair and insert it.*/
-        if (this->measures.find(it->first) != this->measures.end()) {
-            this->measures.at(it->first) = it->second;
-        } else {
-            this->measures.insert(std::make_pair(it->first, it->second));
-        }
+        //Measure has no constructor with no arguments, so setMeasure() inserts or merges it for us
+        setMeasure(it->first, it->second);
     }
 
     return *this;
 }
 
+/*
+  Merge another Area into this one, with the same result as the copy
+  assignment operator above, but without copying the other Area. If both areas
+  use the same allocator (e.g. the same arena, see areas.h), the nodes of the
+  names and measures that this area does not have yet are moved over as they
+  are, and the measures both areas have are merged with Measure::mergeFrom().
+
+  @param other
+    The Area to merge into this one, which is left without names or measures
+
+  @return
+    void
+*/
+void Area::mergeFrom(Area&& other) {
+    BethYw::spliceOrMerge(names, other.names, [](std::pmr::string& name, std::pmr::string&& otherName) {
+        name = std::move(otherName);
+    });
+
+    BethYw::spliceOrMerge(measures, other.measures, [](Measure& measure, Measure&& otherMeasure) {
+        measure.mergeFrom(std::move(otherMeasure));
+    });
+}
+
 /*Function that converts this to json and saves it in the given json object. It is specified in the documentation of
  * the nlohmann::json library.*/
 void to_json(json& j, const Area& area) {
+    json measures = json::object();
+    for (auto it = area.measures.begin(); it != area.measures.end(); it++) {
+        measures[BethYw::Intern::lookup(it->first)] = it->second;
+    }
+
+    json names = json::object();
+    for (auto it = area.names.begin(); it != area.names.end(); it++) {
+        names[std::string(it->first)] = std::string(it->second);
+    }
+
     if (!area.names.empty() && !area.measures.empty()) {
-        j = json{{"names", area.names}, {"measures", area.measures}};
+        j = json{{"names", names}, {"measures", measures}};
     } else if (!area.names.empty()) {
-        j = json{{"names", area.names}};
+        j = json{{"names", names}};
     } else if (!area.measures.empty()) {
-        j = json{{"measures", area.measures}};
+        j = json{{"measures", measures}};
     }
+}
+
+/*
+  Write this Area as JSON, the same way to_json() and dump() would write it:
+  an object with its "measures" and "names" (in that order, as the keys of a
+  JSON object are sorted), leaving out whichever is empty, or null if both are.
+
+  With statistics, a "stats" object follows with the statistics of every
+  measure by codename (see stats.h), as an object with the keys "cagr" (the
+  compound annual growth rate as a percentage), "max", "min", "sd", "slope"
+  and "variance".
+
+  @param out
+    The writer to write the JSON to
+
+  @param stats
+    The statistics of the measures of this Area, or nullptr to leave them out
+*/
+void Area::writeJSON(JsonWriter& out, const StatsTable* stats) const {
+    if (names.empty() && measures.empty()) {
+        out.raw("null");
+        return;
+    }
+
+    out.raw('{');
+
+    if (!measures.empty()) {
+        auto sorted = sortedMeasures();
+
+        out.raw("\"measures\":{");
+        for (auto it = sorted.begin(); it != sorted.end(); it++) {
+            if (it != sorted.begin()) {
+                out.raw(',');
+            }
+
+            out.string(*it->first);
+            out.raw(':');
+            it->second->writeJSON(out);
+        }
+        out.raw('}');
+
+        if (!names.empty()) {
+            out.raw(',');
+        }
+    }
+
+    if (!names.empty()) {
+        //names are not kept in order, so they are sorted by language code like a JSON object would be
+        std::vector<const std::pair<const std::pmr::string, std::pmr::string>*> sortedNames;
+        for (auto it = names.begin(); it != names.end(); it++) {
+            sortedNames.push_back(&*it);
+        }
+        std::sort(sortedNames.begin(), sortedNames.end(), [](const auto* lhs, const auto* rhs) {
+            return lhs->first < rhs->first;
+        });
+
+        out.raw("\"names\":{");
+        for (auto it = sortedNames.begin(); it != sortedNames.end(); it++) {
+            if (it != sortedNames.begin()) {
+                out.raw(',');
+            }
+
+            out.string((*it)->first);
+            out.raw(':');
+            out.string((*it)->second);
+        }
+        out.raw('}');
+    }
+
+    if (stats != nullptr && !measures.empty()) {
+        auto sorted = sortedMeasures();
+        //a measure added to the area after the statistics were computed has none
+        const MeasureStats none = {0, 0, 0, 0, 0, 0};
+
+        out.raw(",\"stats\":{");
+        for (auto it = sorted.begin(); it != sorted.end(); it++) {
+            if (it != sorted.begin()) {
+                out.raw(',');
+            }
+
+            const MeasureStats* measureStats = stats->find(*it->second);
+            if (measureStats == nullptr) {
+                measureStats = &none;
+            }
+
+            out.string(*it->first);
+            out.raw(":{\"cagr\":");
+            out.number(measureStats->growth);
+            out.raw(",\"max\":");
+            out.number(measureStats->max);
+            out.raw(",\"min\":");
+            out.number(measureStats->min);
+            out.raw(",\"sd\":");
+            out.number(measureStats->standardDeviation);
+            out.raw(",\"slope\":");
+            out.number(measureStats->slope);
+            out.raw(",\"variance\":");
+            out.number(measureStats->variance);
+            out.raw('}');
+        }
+        out.raw('}');
+    }
+
+    out.raw('}');
 }
\ No newline at end of file
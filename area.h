@@ -14,13 +14,21 @@
  */
 
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <map>
 #include <iostream>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+#include "intern.h"
 #include "measure.h"
+#include "jsonwriter.h"
 
 #include "lib_json.hpp"
 
+class StatsTable;
+
 /*
   An alias for the imported JSON parsing library.
 */
@@ -30,34 +38,66 @@ using json = nlohmann::json;
   An Area object consists of a unique authority code, a container for names
   for the area in any number of different languages, and a container for the
   Measures objects.
+
+  The containers use a polymorphic allocator, which they pass on to the
+  Measure objects in them, so that everything in an Area stored in an arena
+  (see areas.h) is allocated from that arena. This includes the authority
+  code and the names, however long they are, so getLocalAuthorityCode() and
+  getName() return copies of them as std::strings, and the output functions
+  use them as they are.
 */
 class Area {
 private:
-    const std::string authorityCode;
-    std::unordered_map<std::string, std::string> names;
-    std::map<std::string, Measure> measures;
+    const std::pmr::string authorityCode;
+    std::pmr::unordered_map<std::pmr::string, std::pmr::string> names;
+    /*Measures are keyed by the ID of their lowercase codename, so finding one
+     * compares integers. An area only has a few measures, so they are sorted
+     * by codename when they are output instead.*/
+    std::pmr::map<BethYw::Intern::Id, Measure> measures;
 
     //private function to help me
     bool hasName(const std::string& langCode) const;
+    const std::pmr::string& name(const std::string& langCode) const;
+    std::string displayName() const;
+
+    void setMeasure(BethYw::Intern::Id key, const Measure& measure) noexcept;
+    void setMeasure(BethYw::Intern::Id key, Measure&& measure) noexcept;
+    std::vector<std::pair<const std::string*, const Measure*>> sortedMeasures() const;
 
 public:
-    Area(const std::string& localAuthorityCode);
+    using allocator_type = Measure::allocator_type;
+
+    Area(std::string_view localAuthorityCode, const allocator_type& alloc = allocator_type());
+    Area(const Area& other) = default;
+    Area(const Area& other, const allocator_type& alloc);
+    Area(Area&& other) = default;
+    Area(Area&& other, const allocator_type& alloc);
 
     //public method required by the cw
-    const std::string& getLocalAuthorityCode() const noexcept;
+    std::string getLocalAuthorityCode() const;
 
-    const std::string& getName(const std::string& langCode) const;
+    std::string getName(const std::string& langCode) const;
     void setName(const std::string& lang, const std::string& name);
 
     Measure& getMeasure(const std::string& key);
     void setMeasure(const std::string& codename, const Measure& measure) noexcept;
+    void setMeasure(const std::string& codename, Measure&& measure) noexcept;
+    void upsertValue(const std::string& codename, const std::string& label, unsigned int year, double value);
 
     int size() const noexcept;
 
     Area& operator=(const Area& other);
+    void mergeFrom(Area&& other);
     friend std::ostream& operator<<(std::ostream& stream, const Area& area);
+    void writeTables(std::ostream& stream, const StatsTable* stats) const;
     friend bool operator==(const Area& lhs, const Area& rhs);
     friend void to_json(json& j, const Area& area);
+    void writeJSON(JsonWriter& out, const StatsTable* stats = nullptr) const;
+
+    friend class Areas;
+    friend class Snapshot;
+    friend class StatsTable;
+    friend class QueryIndex;
 };
 
 #endif // AREA_H_
\ No newline at end of file
@@ -15,17 +15,31 @@
 #include <stdexcept>
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <stdexcept>
 #include <tuple>
 #include <unordered_set>
 #include <map>
+#include <algorithm>
+#include <vector>
+#include <utility>
 
 #include "lib_json.hpp"
 #include "datasets.h"
 #include "areas.h"
 #include "measure.h"
 #include "bethyw.h"
+#include "jsonstream.h"
+#include "csv.h"
+#include "filter.h"
+#include "jsonwriter.h"
+#include "input.h"
+#include "profile.h"
+#include "intern.h"
+#include "numbers.h"
+#include "parallel.h"
+#include "splice.h"
 
 /*
   An alias for the imported JSON parsing library.
@@ -35,7 +49,28 @@ using json = nlohmann::json;
 /*
   Constructor for an Areas object.
 */
-Areas::Areas() : areas(std::map<std::string, Area>()) {
+Areas::Areas() : areas(AreasContainer()) {
+
+}
+
+/*
+  Constructor for an Areas object whose Area and Measure objects are all
+  allocated from the given memory resource.
+
+  When datasets are loaded into an Areas object on several threads, each
+  thread fills an Areas object of its own that allocates from the same
+  resource, so that they can be merged without copying (see merge()). The
+  resource must then be thread safe, e.g. a synchronized_pool_resource; a
+  monotonic_buffer_resource is only suitable when loading on one thread.
+
+  @param resource
+    The memory resource, which must outlive this Areas object
+
+  @example
+    std::pmr::synchronized_pool_resource arena;
+    Areas areas(&arena);
+*/
+Areas::Areas(std::pmr::memory_resource* resource) : areas(resource) {
 
 }
 
@@ -57,10 +92,229 @@ Areas::Areas() : areas(std::map<std::string, Area>()) {
     void
 */
 void Areas::setArea(const std::string& localAuthorityCode, const Area& area) noexcept {
-    if (areas.find(localAuthorityCode) == areas.end()) {
-        areas.insert(std::pair<std::string, Area>(localAuthorityCode, area));
-    } else {
-        areas.find(localAuthorityCode)->second = area;
+    //try_emplace() only constructs the Area when the key is not there yet, so the key is looked up once either way
+    auto result = areas.try_emplace(std::pmr::string(localAuthorityCode, areas.get_allocator()), area);
+
+    if (!result.second) {
+        result.first->second = area;
+    }
+}
+
+/*
+  Add a particular Area to the Areas object, like setArea() above, but taking
+  over the names and measures of the Area instead of copying them where it
+  can: a new Area is moved into this object, and an Area with the same local
+  authority code is merged with Area::mergeFrom().
+
+  @param localAuthorityCode
+    The local authority code of the Area
+
+  @param area
+    The Area object, which is left in a valid but unspecified state
+
+  @return
+    void
+*/
+void Areas::setArea(const std::string& localAuthorityCode, Area&& area) noexcept {
+    auto result = areas.try_emplace(std::pmr::string(localAuthorityCode, areas.get_allocator()), std::move(area));
+
+    if (!result.second) {
+        result.first->second.mergeFrom(std::move(area));
+    }
+}
+
+/*Returns the Area with the given local authority code, creating it if there is none yet. The code is only copied
+ * into the arena when the Area is created, and the files list the areas in order of code, so the hint is usually
+ * where the new Area goes.*/
+Area& Areas::areaFor(std::string_view localAuthorityCode) {
+    auto it = areas.lower_bound(localAuthorityCode);
+    if (it == areas.end() || it->first != localAuthorityCode) {
+        it = areas.emplace_hint(it, std::piecewise_construct, std::forward_as_tuple(localAuthorityCode),
+                                std::forward_as_tuple(localAuthorityCode));
+    }
+
+    return it->second;
+}
+
+/*
+  Add all the Area objects of another Areas object to this one. Each Area is inserted or merged exactly as if it
+  was passed to setArea(), so loading datasets into separate Areas objects and
+  merging them in the order the datasets would have been loaded gives the same
+  result as loading them all into one Areas object.
+
+  @param other
+    The Areas object whose Area objects will be added to this one
+
+  @return
+    void
+*/
+void Areas::merge(const Areas& other) noexcept {
+    for (auto it = other.areas.begin(); it != other.areas.end(); it++) {
+        setArea(std::string(it->first), it->second);
+    }
+}
+
+/*
+  Add all the Area objects of another Areas object to this one, like merge()
+  above, but without copying them. If both Areas objects allocate from the
+  same memory resource (see resource()), the nodes of the areas this object
+  does not have yet are moved over as they are, and the areas both have are
+  merged with Area::mergeFrom(), which does the same with their measures. This
+  is why the shards that datasets are loaded into on several threads are
+  constructed with the memory resource of the Areas object they are merged
+  into.
+
+  @param other
+    The Areas object whose Area objects will be moved to this one, which is
+    left empty
+
+  @return
+    void
+*/
+void Areas::merge(Areas&& other) noexcept {
+    BethYw::spliceOrMerge(areas, other.areas, [](Area& area, Area&& otherArea) {
+        area.mergeFrom(std::move(otherArea));
+    });
+}
+
+/*
+  Retrieve the memory resource the Area and Measure objects of this Areas
+  object are allocated from.
+
+  @return
+    The memory resource given to the constructor, or the default one
+*/
+std::pmr::memory_resource* Areas::resource() const noexcept {
+    return areas.get_allocator().resource();
+}
+
+/*
+  Create empty Areas objects that allocate from the same memory resource as
+  this one, for threads to load data into before it is merged into this
+  object with merge(Areas&&), which then moves the nodes over as they are.
+  Copying an Areas object would not do, as copies use the default resource.
+
+  @param count
+    The number of Areas objects to create
+
+  @return
+    The Areas objects
+*/
+std::vector<Areas> Areas::makeShards(std::size_t count) const {
+    std::vector<Areas> shards;
+    shards.reserve(count);
+
+    for (std::size_t i = 0; i < count; i++) {
+        shards.emplace_back(resource());
+    }
+
+    return shards;
+}
+
+/*
+  Add the Area objects of another Areas object that was populated from a single
+  dataset without any filters, keeping only the data that populate() would
+  have imported from that dataset with the given filters. This lets us keep an
+  unfiltered copy of a dataset (e.g. in a snapshot) and still answer any query
+  on it without parsing the file again.
+
+  The filters are applied the same way as by the populate functions for the
+  given type of dataset:
+   - AuthorityCodeCSV: Areas whose code is in areasFilter
+   - WelshStatsJSON: Areas whose code or English name matches areasFilter,
+     with the Measures that match measuresFilter and have at least one value
+     in yearsFilter
+   - AuthorityByYearCSV: Areas whose code matches areasFilter, with their
+     Measure if it matches measuresFilter, even if it has no values in
+     yearsFilter
+
+  The result is the same as populating from the dataset with the filters,
+  provided that an area has the same English name, and a measure the same
+  label, on every row of the dataset, which is the case for all StatsWales
+  datasets.
+
+  @param other
+    An Areas object populated from a single dataset without filters
+
+  @param type
+    The type of the dataset `other` was populated from
+
+  @param areasFilter
+    An umodifiable pointer to set of umodifiable strings for areas to import,
+    or an empty set if all areas should be imported
+
+  @param measuresFilter
+    An umodifiable pointer to set of umodifiable strings for measures to import,
+    or an empty set if all measures should be imported
+
+  @param yearsFilter
+    An umodifiable pointer to an umodifiable tuple of two unsigned integers,
+    where if both values are 0, then all years should be imported, otherwise
+    they should be treated as a the range of years to be imported
+
+  @return
+    void
+
+  @throws
+    std::runtime_error if an unexpected type is passed in
+*/
+void Areas::mergeFiltered(const Areas& other, const BethYw::SourceDataType& type,
+                          const StringFilterSet* const areasFilter,
+                          const StringFilterSet* const measuresFilter,
+                          const YearFilterTuple* const yearsFilter) {
+
+    if (type != BethYw::AuthorityCodeCSV && type != BethYw::WelshStatsJSON && type != BethYw::AuthorityByYearCSV) {
+        throw std::runtime_error("Areas::mergeFiltered: Unexpected data type");
+    }
+
+    const FilterMatcher areasMatcher(areasFilter, FilterMatcher::UPPER);
+    const FilterMatcher measuresMatcher(measuresFilter, FilterMatcher::LOWER);
+
+    for (auto it = other.areas.begin(); it != other.areas.end(); it++) {
+        const std::string authorityCode(it->first);
+        const Area& area = it->second;
+
+        if (type == BethYw::AuthorityCodeCSV) {
+            if (areasFilter == nullptr || areasFilter->empty() || areasFilter->find(authorityCode) != areasFilter->end()) {
+                setArea(authorityCode, area);
+            }
+            continue;
+        }
+
+        bool areaIncluded = areasMatcher.matches(authorityCode);
+        if (!areaIncluded && type == BethYw::WelshStatsJSON && area.hasName("eng")) {
+            areaIncluded = areasMatcher.matches(area.name("eng"));
+        }
+
+        if (!areaIncluded) {
+            continue;
+        }
+
+        //both are built with the allocator of this object, so moving them in below does not copy them again
+        Area filteredArea = Area(authorityCode, areas.get_allocator());
+        for (auto measureIt = area.measures.begin(); measureIt != area.measures.end(); measureIt++) {
+            const Measure& measure = measureIt->second;
+
+            if (measuresMatcher.matches(measure.getCodename())) {
+                Measure filteredMeasure = Measure(measure.getCodename(), measure.getLabel(), areas.get_allocator());
+
+                for (auto valueIt = measure.values.begin(); valueIt != measure.values.end(); valueIt++) {
+                    if (Areas::isInYearRange(yearsFilter, valueIt->first)) {
+                        filteredMeasure.setValue(valueIt->first, valueIt->second);
+                    }
+                }
+
+                //the JSON parser only creates a Measure when it imports a value for it
+                if (type == BethYw::AuthorityByYearCSV || filteredMeasure.size() > 0) {
+                    filteredArea.setMeasure(measureIt->first, std::move(filteredMeasure));
+                }
+            }
+        }
+
+        if (filteredArea.size() > 0) {
+            filteredArea.names = area.names;
+            setArea(authorityCode, std::move(filteredArea));
+        }
     }
 }
 
@@ -78,11 +332,49 @@ void Areas::setArea(const std::string& localAuthorityCode, const Area& area) noe
     exist in this Areas instance
 */
 Area& Areas::getArea(const std::string& localAuthorityCode) {
-    try {
-        return areas.at(localAuthorityCode);
-    } catch (std::out_of_range& ex) {
-        throw std::out_of_range(std::string("No area found matching ") + localAuthorityCode);
+    auto it = areas.find(std::string_view(localAuthorityCode));
+    if (it != areas.end()) {
+        return it->second;
     }
+
+    throw std::out_of_range(std::string("No area found matching ") + localAuthorityCode);
+}
+
+/*
+  Set a single value for an Area and Measure, creating the Area and the Measure
+  in place if they do not exist yet. The result is the same as calling setArea()
+  with a new Area holding the English name and a Measure with this one value,
+  but no temporary Area or Measure is built and merged, and nothing is copied
+  or allocated when the Area and Measure already exist.
+
+  @param localAuthorityCode
+    The local authority code of the Area
+
+  @param engName
+    The English name of the Area, which replaces any previous English name
+
+  @param measureCode
+    The codename of the Measure, which will be converted to lowercase
+
+  @param measureLabel
+    The human-readable label of the Measure, only used if it has to be created
+
+  @param year
+    The year to set a value for
+
+  @param value
+    The value for the given year
+
+  @return
+    void
+*/
+void Areas::upsertValue(const std::string& localAuthorityCode, const std::string& engName,
+                        const std::string& measureCode, const std::string& measureLabel,
+                        unsigned int year, double value) {
+    Area& area = areaFor(localAuthorityCode);
+
+    area.setName("eng", engName);
+    area.upsertValue(measureCode, measureLabel, year, value);
 }
 
 /*
@@ -97,6 +389,29 @@ int Areas::size() const noexcept {
     return areas.size();
 }
 
+/*
+  Retrieve the codenames of all the measures of all the Areas in the
+  container, each once.
+
+  @return
+    The lowercase codenames, in no particular order
+*/
+std::vector<std::string> Areas::measureCodes() const {
+    std::unordered_set<BethYw::Intern::Id> ids;
+    for (auto it = areas.begin(); it != areas.end(); it++) {
+        for (auto measureIt = it->second.measures.begin(); measureIt != it->second.measures.end(); measureIt++) {
+            ids.insert(measureIt->first);
+        }
+    }
+
+    std::vector<std::string> codes;
+    for (auto it = ids.begin(); it != ids.end(); it++) {
+        codes.push_back(BethYw::Intern::lookup(*it));
+    }
+
+    return codes;
+}
+
 /*
   This function specifically parses the compiled areas.csv file of local
   authority codes, and their names in English and Welsh.
@@ -136,36 +451,40 @@ void Areas::populateFromAuthorityCodeCSV(std::istream& is, const BethYw::SourceC
         throw std::out_of_range("Not enough columns in cols mapping!");
     }
 
-    std::string line;
-    std::stringstream lineStream;
+    /*The tokenizer gives us views straight into the file contents, which are not copied at all if the stream reads
+     * from a memory mapped file.*/
+    std::string storage;
+    CsvTokenizer csv(MemoryStreamBuffer::unread(is, storage));
 
-    //read and throw away first line, containing headings
-    std::getline(is, line);
+    //throw away first line, containing headings
+    csv.nextRow();
 
-    while (std::getline(is, line)) {
-        lineStream.str(line);
-        lineStream.clear();
+    std::string authorityCode;
+    while (csv.nextRow()) {
+        BethYw::Profile::countRowParsed();
 
-        std::string authorityCode;
-        std::string englishName;
-        std::string welshName;
+        std::string_view code;
+        std::string_view englishName;
+        std::string_view welshName;
 
-        std::getline(lineStream, authorityCode, ',');
-        std::getline(lineStream, englishName, ',');
-        std::getline(lineStream, welshName, ',');
+        csv.nextField(code);
+        csv.nextField(englishName);
+        csv.nextField(welshName);
 
-        if (authorityCode.empty() || englishName.empty() || welshName.empty()) {
+        if (code.empty() || englishName.empty() || welshName.empty()) {
             throw std::runtime_error("Line does not have three comma separated values!");
         }
 
+        authorityCode.assign(code);
+
         /*We only add the area if we should all areas or if the filter specified this area code. We make sure to
          * put the condition for the null pointer first so we do not dereference it later on.*/
         if (areasFilter == nullptr || areasFilter->empty() || areasFilter->find(authorityCode) != areasFilter->end()) {
-            Area newArea = Area(authorityCode);
-            newArea.setName("eng", englishName);
-            newArea.setName("cym", welshName);
-
-            setArea(authorityCode, newArea);
+            Area& area = areaFor(authorityCode);
+            area.setName("eng", std::string(englishName));
+            area.setName("cym", std::string(welshName));
+        } else {
+            BethYw::Profile::countRowFilteredOut();
         }
     }
 }
@@ -228,106 +547,195 @@ void Areas::populateFromWelshStatsJSON(std::istream& is, const BethYw::SourceCol
                                        const std::unordered_set<std::string>* const areasFilter,
                                        const std::unordered_set<std::string>* const measuresFilter,
                                        const std::tuple<unsigned int, unsigned int>* const yearsFilter) {
-    json j;
-    is >> j;
-
-    bool isTrainDataset = cols == BethYw::InputFiles::TRAINS.COLS;
-    auto& jsonUsefulData = Areas::safeGet(j, "value");
+    /*Datasets with a single measure (e.g. the trains one) have its code and label in cols instead of in each row. As
+     *this is known before reading any row, each kind of dataset gets its own instantiation of the row loop, so the
+     *check is not made for every row.*/
+    if (cols.find(BethYw::SourceColumn::SINGLE_MEASURE_CODE) != cols.end()) {
+        populateFromWelshStatsJSONRows<true>(is, cols, areasFilter, measuresFilter, yearsFilter);
+    } else {
+        populateFromWelshStatsJSONRows<false>(is, cols, areasFilter, measuresFilter, yearsFilter);
+    }
+}
 
-    for (auto& element: jsonUsefulData.items()) {
-        auto& data = element.value();
-        const std::string& authorityCode = Areas::safeGet(data, cols.at(BethYw::SourceColumn::AUTH_CODE));
-        const std::string& areaEngName = Areas::safeGet(data, cols.at(BethYw::SourceColumn::AUTH_NAME_ENG));
+/*
+  The smallest chunk a file is split into to be parsed on several threads. A
+  file is split into several chunks per thread, to even out the work when some
+  rows take longer to parse (or are filtered out more quickly) than others,
+  while each chunk is still big enough for its Areas object to be worth merging.
+*/
+static const std::size_t MIN_CHUNK_BYTES = 1 << 20;
 
-        if (Areas::isIncludedInFilter(areasFilter, authorityCode, true) ||
-                Areas::isIncludedInFilter(areasFilter, areaEngName, true)) {
+/*
+  Import a StatsWales JSON file like the function above, but parse it on
+  several threads. The rows are split into chunks (see
+  JsonRowReader::splitRows()), each chunk is parsed with the filters into its
+  own Areas object, and these are merged into this one in the order of the
+  chunks, so the rows that come later in the file still overwrite the earlier
+  ones exactly as when parsing the file in one piece.
+
+  Each chunk is read straight from `text` through a ChainedStreamBuffer, so
+  the file is never copied. If the file can not be split, it is parsed in one
+  piece instead. An error in a chunk is not retried: the error of the first
+  failing chunk is thrown, which is the first error in the file, as it would
+  be without threads.
+
+  @param text
+    The contents of the file, e.g. from MmapInputFile::bytes()
 
-            /*I wanted to have the measure code be a const reference, and thus it needs to be initialized when it is
-             * declared. Therefore, I could only do it with a ternary operator. If the dataset file is the train one,
-             * the measure code is a hardcoded value, else it is a value we need to read from the json data.*/
-            const std::string& measureCode = isTrainDataset ? BethYw::InputFiles::TRAINS.COLS.at(BethYw::SourceColumn::SINGLE_MEASURE_CODE)
-                    : (const std::string&) Areas::safeGet(data, cols.at(BethYw::SourceColumn::MEASURE_CODE));
-            const std::string& measureLabel = isTrainDataset ? BethYw::InputFiles::TRAINS.COLS.at(BethYw::SourceColumn::SINGLE_MEASURE_NAME)
-                    : (const std::string&) Areas::safeGet(data, cols.at(BethYw::SourceColumn::MEASURE_NAME));
+  @param cols
+    The column mapping of the dataset
 
-            if (Areas::isIncludedInFilter(measuresFilter, measureCode, false)) {
+  @param areasFilter
+    The areas to import, or an empty set or nullptr for all of them
 
-                unsigned int year = Areas::parseYear(Areas::safeGet(data, cols.at(BethYw::SourceColumn::YEAR)));
+  @param measuresFilter
+    The measures to import, or an empty set or nullptr for all of them
 
-                if (Areas::isInYearRange(yearsFilter, year)) {
-                    double value = 0;
-                    //unlike the others, environment data set stores the double values as strings. We need to account for that.
-                    if(cols == BethYw::InputFiles::AQI.COLS) {
-                        std::string valueAsString = Areas::safeGet(data, cols.at(BethYw::SourceColumn::VALUE));
-                        value = std::stod(valueAsString);
-                    } else {
-                        value = Areas::safeGet(data, cols.at(BethYw::SourceColumn::VALUE));
-                    }
+  @param yearsFilter
+    The range of years to import, or <0,0> or nullptr for all of them
 
-                    /* we use the logic in the overloaded copy assignment operators to insert the new area/measure, or
-                     * merge them with existing objects.*/
-                    Area newArea = Area(authorityCode);
-                    newArea.setName("eng", areaEngName);
+  @param threads
+    The number of threads to parse the file on, or 0 to use one per core
 
-                    Measure newMeasure = Measure(measureCode, measureLabel);
-                    newMeasure.setValue(year, value);
-                    newArea.setMeasure(measureCode, newMeasure);
+  @throws
+    std::runtime_error if a parsing error occurs (e.g. due to a malformed file)
+    std::out_of_range if there are not enough columns in cols
 
-                    this->setArea(authorityCode, newArea);
-                }
-            }
+  @example
+    MmapInputFile file("datasets/popu1009.json");
+    file.open();
+    Areas data = Areas();
+    data.populateFromWelshStatsJSON(file.bytes(), BethYw::InputFiles::POPDEN.COLS,
+                                    nullptr, nullptr, nullptr, 4);
+*/
+void Areas::populateFromWelshStatsJSON(std::string_view text, const BethYw::SourceColumnMapping& cols,
+                                       const std::unordered_set<std::string>* const areasFilter,
+                                       const std::unordered_set<std::string>* const measuresFilter,
+                                       const std::tuple<unsigned int, unsigned int>* const yearsFilter,
+                                       unsigned int threads) {
+    const unsigned int workers = BethYw::threadsFor(text.size() / MIN_CHUNK_BYTES, threads);
+    const std::size_t numChunks = std::min<std::size_t>(workers * 4, text.size() / MIN_CHUNK_BYTES);
+
+    const std::vector<JsonRowSpan> chunks = workers > 1 ? JsonRowReader::splitRows(text, numChunks, workers)
+                                                        : std::vector<JsonRowSpan>();
+
+    if (chunks.size() > 1) {
+        std::vector<Areas> shards = makeShards(chunks.size());
+
+        //the chunk is read straight from the file's memory, with the top level object around it read from elsewhere
+        BethYw::parallelFor(chunks.size(), workers, [&](size_t i) {
+            ChainedStreamBuffer buffer({"{\"value\":[", text.substr(chunks[i].begin, chunks[i].end - chunks[i].begin),
+                                        "]}"});
+            std::istream is(&buffer);
+            shards[i].populateFromWelshStatsJSON(is, cols, areasFilter, measuresFilter, yearsFilter);
+        });
+
+        for (auto it = shards.begin(); it != shards.end(); it++) {
+            this->merge(std::move(*it));
         }
+        return;
     }
+
+    MemoryStreamBuffer buffer;
+    buffer.reset(text.data(), text.size());
+    std::istream is(&buffer);
+    populateFromWelshStatsJSON(is, cols, areasFilter, measuresFilter, yearsFilter);
 }
 
 /*
- * Thin wrapper over the json.at method. The block comment for loadFromWelshStats requires that runtime_error be thrown
- * when the json file is malformed. The json.at() method throws out_of_range when trying to access a key that does not
- * exist. This method catches that error and throws runtime_error in its place, to conform to the specifications.*/
-const json& Areas::safeGet(const json& data, const std::string& key) {
-    try {
-        return data.at(key);
-    } catch (const std::out_of_range& ex) {
-        throw std::runtime_error(std::string("Malformed JSON file! No value for key:") + key);
-    }
-}
-
-/*Checks if the given filter allows for the given data to be included in the program output. The booleas flag says if
- * the given string data should be made to be lowercase or uppercase before the check happens.*/
-bool Areas::isIncludedInFilter(const std::unordered_set<std::string>* const filter, const std::string& data,
-                               bool toUpper) {
-    if (toUpper) {
-        std::string upperCaseData = BethYw::toUpper(data);
-        return Areas::isIncludedInFilter(filter, upperCaseData);
-    } else {
-        std::string lowerCaseData = BethYw::toLower(data);
-        return Areas::isIncludedInFilter(filter, lowerCaseData);
-    }
-}
+  The row loop of populateFromWelshStatsJSON(), for datasets that either have
+  a measure code and label in every row (SingleMeasure is false), or have a
+  single measure whose code and label are in cols (SingleMeasure is true).
 
-/*Checks if the given filter allows for the given data to be included in the program output. If the filter is null or
- * empty, all data is included. Otherwise, the data is included if it is in the filter, or if the filter contains a
- * string that is a substring of the data.*/
-bool Areas::isIncludedInFilter(const std::unordered_set<std::string>* const filter, const std::string& data) {
-    if (filter == nullptr || filter->empty()) {
-        return true;
-    } else {
-        if (filter->find(data) != filter->end()) {
-            return true;
-        } else {
-            for (auto it = filter->begin(); it != filter->end(); it++) {
-                if (data.find(*it) != std::string::npos) {
-                    return true;
+  The columns are resolved to slots of a JsonRowSchema once, so reading a row
+  fills a fixed array of values rather than building a json object, and each
+  column is then found by its index instead of a string lookup. Values stored
+  as strings (e.g. in the AQI dataset) are recognised from the type the
+  parser reads, so no dataset needs to be special cased for them.
+
+  @param is
+    The input stream from InputSource
+
+  @param cols
+    The column mapping of the dataset
+
+  @param areasFilter
+    The areas to import, or an empty set or nullptr for all of them
+
+  @param measuresFilter
+    The measures to import, or an empty set or nullptr for all of them
+
+  @param yearsFilter
+    The range of years to import, or <0,0> or nullptr for all of them
+
+  @throws
+    std::runtime_error if a parsing error occurs (e.g. due to a malformed file)
+    std::out_of_range if there are not enough columns in cols
+*/
+template <bool SingleMeasure>
+void Areas::populateFromWelshStatsJSONRows(std::istream& is, const BethYw::SourceColumnMapping& cols,
+                                           const std::unordered_set<std::string>* const areasFilter,
+                                           const std::unordered_set<std::string>* const measuresFilter,
+                                           const std::tuple<unsigned int, unsigned int>* const yearsFilter) {
+    const JsonRowSchema schema = SingleMeasure
+            ? JsonRowSchema(cols, {BethYw::SourceColumn::AUTH_CODE, BethYw::SourceColumn::AUTH_NAME_ENG,
+                                   BethYw::SourceColumn::YEAR, BethYw::SourceColumn::VALUE})
+            : JsonRowSchema(cols, {BethYw::SourceColumn::AUTH_CODE, BethYw::SourceColumn::AUTH_NAME_ENG,
+                                   BethYw::SourceColumn::MEASURE_CODE, BethYw::SourceColumn::MEASURE_NAME,
+                                   BethYw::SourceColumn::YEAR, BethYw::SourceColumn::VALUE});
+
+    const std::size_t authorityCodeSlot = schema.slot(BethYw::SourceColumn::AUTH_CODE);
+    const std::size_t areaEngNameSlot = schema.slot(BethYw::SourceColumn::AUTH_NAME_ENG);
+    const std::size_t yearSlot = schema.slot(BethYw::SourceColumn::YEAR);
+    const std::size_t valueSlot = schema.slot(BethYw::SourceColumn::VALUE);
+    const std::size_t measureCodeSlot = SingleMeasure ? 0 : schema.slot(BethYw::SourceColumn::MEASURE_CODE);
+    const std::size_t measureLabelSlot = SingleMeasure ? 0 : schema.slot(BethYw::SourceColumn::MEASURE_NAME);
+
+    const std::string singleMeasureCode = SingleMeasure ? cols.at(BethYw::SourceColumn::SINGLE_MEASURE_CODE) : "";
+    const std::string singleMeasureLabel = SingleMeasure ? cols.at(BethYw::SourceColumn::SINGLE_MEASURE_NAME) : "";
+
+    //the filters are compiled once here, rather than for every row
+    const FilterMatcher areasMatcher(areasFilter, FilterMatcher::UPPER);
+    const FilterMatcher measuresMatcher(measuresFilter, FilterMatcher::LOWER);
+
+    /*Rather than reading the whole file into a json object first, the reader gives us the rows of the "value" array
+     * one at a time as they are parsed, so we only ever hold a single row in memory.*/
+    JsonRowReader reader(schema, [&](const JsonRow& data) {
+        BethYw::Profile::countRowParsed();
+
+        const std::string& authorityCode = data.getString(authorityCodeSlot);
+        const std::string& areaEngName = data.getString(areaEngNameSlot);
+
+        if (areasMatcher.matches(authorityCode) || areasMatcher.matches(areaEngName)) {
+
+            const std::string& measureCode = SingleMeasure ? singleMeasureCode : data.getString(measureCodeSlot);
+            const std::string& measureLabel = SingleMeasure ? singleMeasureLabel : data.getString(measureLabelSlot);
+
+            if (measuresMatcher.matches(measureCode)) {
+
+                unsigned int year = Areas::parseYear(data.getString(yearSlot));
+
+                if (Areas::isInYearRange(yearsFilter, year)) {
+                    double value = data.getNumber(valueSlot);
+
+                    this->upsertValue(authorityCode, areaEngName, measureCode, measureLabel, year, value);
+                    return;
                 }
             }
-
-            return false;
         }
+
+        BethYw::Profile::countRowFilteredOut();
+    });
+
+    reader.parse(is);
+
+    if (!reader.foundRows()) {
+        throw std::runtime_error("Malformed JSON file! No value for key:value");
     }
 }
 
 bool Areas::isInYearRange(const std::tuple<unsigned int, unsigned int>* const yearRange, unsigned int year) {
-    if (std::get<0>(*yearRange) == 0 && std::get<1>(*yearRange) == 0) {
+    if (yearRange == nullptr || (std::get<0>(*yearRange) == 0 && std::get<1>(*yearRange) == 0)) {
         return true;
     } else if (year >= std::get<0>(*yearRange) && year <= std::get<1>(*yearRange)) {
         return true;
@@ -336,19 +744,15 @@ bool Areas::isInYearRange(const std::tuple<unsigned int, unsigned int>* const ye
     }
 }
 
-/*Tries to parse the given string as an unsigned int. Throws an exception if that can not be done.*/
-unsigned int Areas::parseYear(const std::string& str) {
-    /*strtol will put a value in end which is the first character after the
-     * integer in the string. We can check if the whole string is an int by
-     * seeing if end points to the end of string character.*/
-    char* end;
-    unsigned int year = strtol(str.c_str(), &end, 10);
+/*Tries to parse the given text as a 4 digit year. Throws an exception if that can not be done.*/
+unsigned int Areas::parseYear(std::string_view str) {
+    unsigned int year;
 
-    if (*end == '\0') {
-        return year;
-    } else {
-        throw std::runtime_error(std::string("Year value can not be parsed as unsigned int: ") + str);
+    if (!BethYw::toYear(str, year)) {
+        throw std::runtime_error(std::string("Year value can not be parsed as a 4 digit year: ") + std::string(str));
     }
+
+    return year;
 }
 
 /*
@@ -397,97 +801,172 @@ void Areas::populateFromAuthorityByYearCSV(std::istream& is, const BethYw::Sourc
                                            const std::unordered_set<std::string>* const areasFilter,
                                            const std::unordered_set<std::string>* const measuresFilter,
                                            const std::tuple<unsigned int, unsigned int>* const yearsFilter) {
+    /*The tokenizer gives us views straight into the file contents, which are not copied at all if the stream reads
+     * from a memory mapped file.*/
+    std::string storage;
+    populateFromAuthorityByYearCSV(MemoryStreamBuffer::unread(is, storage), cols, areasFilter, measuresFilter,
+                                   yearsFilter, 1);
+}
+
+/*
+  Import an Authority By Year CSV file like the function above, from its
+  text, on several threads. Every row after the header is about a single
+  area, so once the years have been read from the header, the rest of the
+  text is split into chunks of whole lines, each chunk is parsed into its own
+  Areas object, and these are merged into this one in the order of the
+  chunks. This gives the same result as parsing the rows one after another,
+  and as errors are thrown in the order of the chunks, the same error too.
+
+  @param text
+    The contents of the file, e.g. from MmapInputFile::bytes()
+
+  @param cols
+    The column mapping of the dataset
 
+  @param areasFilter
+    The areas to import, or an empty set or nullptr for all of them
+
+  @param measuresFilter
+    The measures to import, or an empty set or nullptr for all of them
+
+  @param yearsFilter
+    The range of years to import, or <0,0> or nullptr for all of them
+
+  @param threads
+    The number of threads to parse the file on, or 0 to use one per core
+
+  @throws
+    std::runtime_error if a parsing error occurs (e.g. due to a malformed file)
+    std::out_of_range if there are not enough columns in cols
+
+  @example
+    MmapInputFile file("datasets/complete-popu1009-pop.csv");
+    file.open();
+    Areas data = Areas();
+    data.populateFromAuthorityByYearCSV(file.bytes(), BethYw::InputFiles::COMPLETE_POP.COLS,
+                                        nullptr, nullptr, nullptr, 4);
+*/
+void Areas::populateFromAuthorityByYearCSV(std::string_view text, const BethYw::SourceColumnMapping& cols,
+                                           const std::unordered_set<std::string>* const areasFilter,
+                                           const std::unordered_set<std::string>* const measuresFilter,
+                                           const std::tuple<unsigned int, unsigned int>* const yearsFilter,
+                                           unsigned int threads) {
     if (cols.size() != 3) {
         throw std::out_of_range("Not enough columns in cols mapping!");
     }
 
     const std::string& measureCode = cols.at(BethYw::SourceColumn::SINGLE_MEASURE_CODE);
-    const std::string& measureLabel = cols.at(BethYw::SourceColumn::SINGLE_MEASURE_NAME);
 
-    if (Areas::isIncludedInFilter(measuresFilter, measureCode, false)) {
-        std::string line;
-        std::stringstream lineStream;
+    const FilterMatcher areasMatcher(areasFilter, FilterMatcher::UPPER);
+    const FilterMatcher measuresMatcher(measuresFilter, FilterMatcher::LOWER);
 
-        //read first row, load it in string stream and load years
-        std::getline(is, line);
-        if (line.empty()) {
-            throw std::runtime_error("CSV file is empty!");
-        }
+    if (!measuresMatcher.matches(measureCode)) {
+        return;
+    }
+
+    //read first row and load years from it
+    CsvTokenizer header(text);
+    if (!header.nextRow() || header.row().empty()) {
+        throw std::runtime_error("CSV file is empty!");
+    }
+
+    const AuthorityByYearColumns columns(cols, Areas::getYears(header), yearsFilter);
+    const std::string_view rows = text.substr(header.position());
+
+    const unsigned int workers = BethYw::threadsFor(rows.size() / MIN_CHUNK_BYTES, threads);
+    if (workers <= 1) {
+        populateFromAuthorityByYearRows(rows, columns, areasMatcher);
+        return;
+    }
+
+    const std::vector<std::string_view> chunks =
+            CsvTokenizer::splitRows(rows, std::min<std::size_t>(workers * 4, rows.size() / MIN_CHUNK_BYTES));
+    std::vector<Areas> shards = makeShards(chunks.size());
+
+    BethYw::parallelFor(chunks.size(), workers, [&](size_t i) {
+        shards[i].populateFromAuthorityByYearRows(chunks[i], columns, areasMatcher);
+    });
+
+    for (auto it = shards.begin(); it != shards.end(); it++) {
+        this->merge(std::move(*it));
+    }
+}
+
+/*
+  Work out what every row of an Authority By Year CSV file needs to know about
+  its columns: the measure of the file, the year of each column, and whether
+  that year is in the years filter, which is the same for every row so it is
+  only checked once per column.
+*/
+Areas::AuthorityByYearColumns::AuthorityByYearColumns(const BethYw::SourceColumnMapping& cols,
+                                                      std::vector<unsigned int>&& years,
+                                                      const std::tuple<unsigned int, unsigned int>* const yearsFilter)
+        : measureCode(cols.at(BethYw::SourceColumn::SINGLE_MEASURE_CODE)),
+          measureLabel(cols.at(BethYw::SourceColumn::SINGLE_MEASURE_NAME)),
+          measureKey(BethYw::Intern::intern(BethYw::toLower(measureCode))),
+          years(std::move(years)),
+          yearIncluded() {
+    for (auto it = this->years.begin(); it != this->years.end(); it++) {
+        yearIncluded.push_back(yearsFilter == nullptr || Areas::isInYearRange(yearsFilter, *it));
+    }
+}
+
+/*The row loop of populateFromAuthorityByYearCSV(), for the rows of the file after the header, or a chunk of them.*/
+void Areas::populateFromAuthorityByYearRows(std::string_view rows, const AuthorityByYearColumns& columns,
+                                            const FilterMatcher& areasMatcher) {
+    CsvTokenizer csv(rows);
+
+    while (csv.nextRow()) {
+        BethYw::Profile::countRowParsed();
+
+        std::string_view code;
+        csv.nextField(code);
+
+        if (!areasMatcher.matches(code)) {
+            BethYw::Profile::countRowFilteredOut();
+        } else {
+            Measure newMeasure = Measure(columns.measureCode, columns.measureLabel, areas.get_allocator());
+
+            /*every value has to be read, even for the years we do not import, so that the values of the
+             * following years line up with their year.*/
+            for (size_t i = 0; i < columns.years.size(); i++) {
+                std::string_view value;
+                bool hasValue = csv.nextField(value) && !value.empty();
 
-        Areas::removeEndline(line);
-        lineStream.str(line);
-        lineStream.clear();
-        std::vector<unsigned int> years = Areas::getYears(lineStream);
-
-        while (std::getline(is, line)) {
-            Areas::removeEndline(line);
-            lineStream.str(line);
-            lineStream.clear();
-
-            std::string authorityCode;
-            std::getline(lineStream, authorityCode, ',');
-
-            if (Areas::isIncludedInFilter(areasFilter, authorityCode, true)) {
-                Area newArea = Area(authorityCode);
-                Measure newMeasure = Measure(measureCode, measureLabel);
-
-                for (auto it = years.begin(); it != years.end(); it++) {
-                    if (Areas::isInYearRange(yearsFilter, *it)) {
-                        std::string value;
-                        std::getline(lineStream, value, ',');
-                        if (value.empty()) {
-                            throw std::runtime_error("Not enough values for all years in authority by year CSV file!");
-                        }
-
-                        if (BethYw::isDouble(value)) {
-                            double numericalValue = std::stod(value);
-                            newMeasure.setValue(*it, numericalValue);
-                        }
+                if (columns.yearIncluded[i]) {
+                    if (!hasValue) {
+                        throw std::runtime_error("Not enough values for all years in authority by year CSV file!");
                     }
-                }
 
-                newArea.setMeasure(measureCode, newMeasure);
-                this->setArea(authorityCode, newArea);
+                    double numericalValue;
+                    if (BethYw::toDouble(value, numericalValue)) {
+                        newMeasure.setValue(columns.years[i], numericalValue);
+                    }
+                }
             }
+
+            Area& area = areaFor(code);
+            area.setMeasure(columns.measureKey, std::move(newMeasure));
         }
     }
 }
 
-/*Processes the first line of an Authority By Year CSV file to extract a vector containing all the years for the
- * measure in that file.*/
-std::vector<unsigned int> Areas::getYears(std::stringstream& lineStream) {
+/*Processes the current row of the tokenizer, which is the first line of an Authority By Year CSV file, to extract a
+ * vector containing all the years for the measure in that file.*/
+std::vector<unsigned int> Areas::getYears(CsvTokenizer& csv) {
     std::vector<unsigned int> years;
-    std::string buffer;
+    std::string_view field;
 
     //throw away first element, it is just the heading for the authority code
-    std::getline(lineStream, buffer, ',');
-
-    while (std::getline(lineStream, buffer, ',')) {
-        if (BethYw::isInt(buffer)) {
-            int year = std::stoi(buffer);
+    csv.nextField(field);
 
-            if (BethYw::is4DigitInt(year)) {
-                years.push_back(year);
-            } else {
-                throw std::runtime_error(std::string("Year is not a 4 digit int") + std::to_string(year));
-            }
-        } else {
-            throw std::runtime_error(std::string("Can not be parsed as year :") + buffer);
-        }
+    while (csv.nextField(field)) {
+        years.push_back(Areas::parseYear(field));
     }
 
     return years;
 }
 
-/*If the given string ends in a new line character, it removes that character.*/
-void Areas::removeEndline(std::string& str) {
-    char lastChar = *str.rbegin();
-    if(lastChar == '\r' || lastChar == '\n') {
-        str.pop_back();
-    }
-}
-
 /*
   Parse data from an standard input stream `is`, that has data of a particular
   `type`, and with a given column mapping in `cols`.
@@ -626,20 +1105,50 @@ void Areas::populate(std::istream& is, const BethYw::SourceDataType& type, const
     std::string of JSON
 */
 std::string Areas::toJSON() const {
-    if(!this->areas.empty()) {
-        json j;
-        to_json(j, *this);
+    std::ostringstream stream;
+    writeJSON(stream);
 
-        return j.dump();
-    } else {
-        return "{}";
+    return stream.str();
+}
+
+/*
+  Write this Areas object as JSON to the given stream, producing the same text
+  as toJSON() did when it built a JSON object of everything with to_json() and
+  dumped it, but without building that object: the Areas, Area and Measure
+  objects write themselves in the order the keys of that object would have.
+
+  @param os
+    The stream to write the JSON to
+
+  @param stats
+    The statistics of the measures, computed from this Areas object, to add
+    to every area as its "stats" (see Area::writeJSON()), or nullptr to
+    leave them out
+*/
+void Areas::writeJSON(std::ostream& os, const StatsTable* stats) const {
+    JsonWriter out(os);
+
+    //the areas are kept in order of code, which is the order they are output in
+    out.raw('{');
+    for (auto it = areas.begin(); it != areas.end(); it++) {
+        if (it != areas.begin()) {
+            out.raw(',');
+        }
+
+        out.string(it->first);
+        out.raw(':');
+        it->second.writeJSON(out, stats);
     }
+    out.raw('}');
 }
 
 /*Function that converts this to json and saves it in the given json object. It is specified in the documentation of
  * the nlohmann::json library.*/
 void to_json(json& j, const Areas& areas) {
-    j = json(areas.areas);
+    j = json::object();
+    for (auto it = areas.areas.begin(); it != areas.areas.end(); it++) {
+        j[std::string(it->first)] = it->second;
+    }
 }
 
 /*
@@ -659,9 +1168,24 @@ void to_json(json& j, const Areas& areas) {
     Reference to the output stream
 */
 std::ostream& operator<<(std::ostream& stream, const Areas& data) {
-    for (auto it = data.areas.begin(); it != data.areas.end(); it++) {
-        stream << it->second;
-    }
-
+    data.writeTables(stream, nullptr);
     return stream;
 }
+
+/*
+  Write all of the imported data as tables, like the << operator does,
+  optionally with the statistics of every measure as more columns of its
+  table (see Measure::writeTable()).
+
+  @param os
+    The output stream to write to
+
+  @param stats
+    The statistics of the measures, computed from this Areas object, or
+    nullptr to write the tables without them
+*/
+void Areas::writeTables(std::ostream& os, const StatsTable* stats) const {
+    for (auto it = areas.begin(); it != areas.end(); it++) {
+        it->second.writeTables(os, stats);
+    }
+}
@@ -24,14 +24,24 @@
  */
 
 #include <iostream>
+#include <memory_resource>
 #include <string>
 #include <tuple>
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 #include <map>
+#include <string_view>
 
 #include "lib_json.hpp"
 #include "datasets.h"
 #include "area.h"
+#include "intern.h"
+#include "csv.h"
+#include "filter.h"
+
+class StatsTable;
 
 /*
   An alias for the imported JSON parsing library.
@@ -50,9 +60,22 @@ using StringFilterSet = std::unordered_set<std::string>;
 using YearFilterTuple = std::tuple<unsigned int, unsigned int>;
 
 /*
-  An alias for the data within an Areas object stores Area objects.
+  An alias for the data within an Areas object stores Area objects. Areas are
+  keyed by their local authority code, in the order they are output in, and
+  can be found with any string type through the transparent comparator. The
+  codes are not interned (see intern.h): nearly every area has a code of its
+  own, which fits in the small buffer of a std::string, so interning them
+  would only hash every code a second time and keep a second copy of it. The
+  files list the areas in order of code, so each new area is inserted next to
+  the last one, which keeps the tree's nodes close together in memory.
+
+  The container uses a polymorphic allocator, which it passes on to every Area
+  (and so every Measure) in it. An Areas object constructed with an arena, e.g.
+  a std::pmr::synchronized_pool_resource, is therefore allocated from a few
+  large blocks of the arena, which are all released at once with the arena.
+  This includes the codes used as keys, however long they are.
 */
-using AreasContainer = std::map<std::string, Area>;
+using AreasContainer = std::pmr::map<std::pmr::string, Area, std::less<>>;
 
 /*
   Areas is a class that stores all the data categorised by area. The 
@@ -69,25 +92,59 @@ private:
     AreasContainer areas;
 
     //private functions to help with calculations related to loading data
-    static unsigned int parseYear(const std::string& str);
+    static unsigned int parseYear(std::string_view str);
 
-    static bool isIncludedInFilter(const std::unordered_set<std::string>* const filter, const std::string& data,
-                                   bool caseSensitive);
-    static bool isIncludedInFilter(const std::unordered_set<std::string>* const filter, const std::string& data);
     static bool isInYearRange(const std::tuple<unsigned int, unsigned int>* const yearRange, unsigned int year);
 
-    static const json& safeGet(const json& data, const std::string& key);
-    static std::vector<unsigned int> getYears(std::stringstream& lineStream);
-    static void removeEndline(std::string& str);
+    static std::vector<unsigned int> getYears(CsvTokenizer& csv);
+
+    //the columns of an Authority By Year CSV file, shared by the threads parsing its rows
+    struct AuthorityByYearColumns {
+        const std::string& measureCode;
+        const std::string& measureLabel;
+        const BethYw::Intern::Id measureKey;
+        std::vector<unsigned int> years;
+        std::vector<bool> yearIncluded;
+
+        AuthorityByYearColumns(const BethYw::SourceColumnMapping& cols, std::vector<unsigned int>&& years,
+                               const std::tuple<unsigned int, unsigned int>* const yearsFilter);
+    };
+
+    void populateFromAuthorityByYearRows(std::string_view rows, const AuthorityByYearColumns& columns,
+                                         const FilterMatcher& areasMatcher);
+
+    template <bool SingleMeasure>
+    void populateFromWelshStatsJSONRows(std::istream& is, const BethYw::SourceColumnMapping& cols,
+                                        const std::unordered_set<std::string>* const areasFilter,
+                                        const std::unordered_set<std::string>* const measuresFilter,
+                                        const std::tuple<unsigned int, unsigned int>* const yearsFilter);
+
+    Area& areaFor(std::string_view localAuthorityCode);
 
 public:
     Areas();
+    explicit Areas(std::pmr::memory_resource* resource);
+
+    std::pmr::memory_resource* resource() const noexcept;
+    std::vector<Areas> makeShards(std::size_t count) const;
 
     void setArea(const std::string& localAuthorityCode, const Area& area) noexcept;
+    void setArea(const std::string& localAuthorityCode, Area&& area) noexcept;
+    void merge(const Areas& other) noexcept;
+    void merge(Areas&& other) noexcept;
+    void mergeFiltered(const Areas& other, const BethYw::SourceDataType& type,
+                       const StringFilterSet* const areasFilter,
+                       const StringFilterSet* const measuresFilter,
+                       const YearFilterTuple* const yearsFilter);
 
     Area& getArea(const std::string& localAuthorityCode);
 
+    void upsertValue(const std::string& localAuthorityCode, const std::string& engName,
+                     const std::string& measureCode, const std::string& measureLabel,
+                     unsigned int year, double value);
+
     int size() const noexcept;
+    std::vector<std::string> measureCodes() const;
 
     void populateFromAuthorityCodeCSV(
             std::istream& is,
@@ -99,11 +156,21 @@ public:
                                     const std::unordered_set<std::string>* const areasFilter,
                                     const std::unordered_set<std::string>* const measuresFilter,
                                     const std::tuple<unsigned int, unsigned int>* const yearsFilter);
+    void populateFromWelshStatsJSON(std::string_view text, const BethYw::SourceColumnMapping& cols,
+                                    const std::unordered_set<std::string>* const areasFilter,
+                                    const std::unordered_set<std::string>* const measuresFilter,
+                                    const std::tuple<unsigned int, unsigned int>* const yearsFilter,
+                                    unsigned int threads);
 
     void populateFromAuthorityByYearCSV(std::istream& is, const BethYw::SourceColumnMapping& cols,
                                                const std::unordered_set<std::string>* const areasFilter = nullptr,
                                                const std::unordered_set<std::string>* const measuresFilter = nullptr,
                                                const std::tuple<unsigned int, unsigned int>* const yearsFilter = nullptr);
+    void populateFromAuthorityByYearCSV(std::string_view text, const BethYw::SourceColumnMapping& cols,
+                                        const std::unordered_set<std::string>* const areasFilter,
+                                        const std::unordered_set<std::string>* const measuresFilter,
+                                        const std::tuple<unsigned int, unsigned int>* const yearsFilter,
+                                        unsigned int threads);
 
     void populate(
             std::istream& is,
@@ -119,9 +186,15 @@ public:
             const YearFilterTuple* const yearsFilter = nullptr) noexcept(false);
 
     std::string toJSON() const;
+    void writeJSON(std::ostream& os, const StatsTable* stats = nullptr) const;
+    void writeTables(std::ostream& os, const StatsTable* stats = nullptr) const;
 
     friend std::ostream& operator<<(std::ostream& stream, const Areas& data);
     friend void to_json(json& j, const Areas& areas);
+
+    friend class Snapshot;
+    friend class StatsTable;
+    friend class QueryIndex;
 };
 
 #endif // AREAS_H
\ No newline at end of file
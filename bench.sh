@@ -0,0 +1,30 @@
+#!/bin/bash
+
+# Generates synthetic datasets of each size given (default 1M 16M 128M bytes
+# per file, and sizes such as 4G work too), then times loading and writing
+# them with bench-suite. The results are written as JSON to the file in
+# BENCH_OUTPUT (default bench-results.json), to be compared between commits
+# with diff. Generated data is kept in bench-data/ and reused by later runs.
+
+DATA_DIR="bench-data"
+BENCH_OUTPUT="${BENCH_OUTPUT:-bench-results.json}"
+SIZES="${*:-1M 16M 128M}"
+
+set -e
+cd "$(dirname "$0")"
+
+bash build.sh bench-generate
+bash build.sh bench-suite
+
+mkdir -p "${DATA_DIR}"
+DIRS=""
+for SIZE in ${SIZES}; do
+  if [ ! -f "${DATA_DIR}/${SIZE}/areas.csv" ]; then
+    ./bin/bench-generate "${DATA_DIR}/${SIZE}.tmp" --size "${SIZE}"
+    rm -rf "${DATA_DIR}/${SIZE}"
+    mv "${DATA_DIR}/${SIZE}.tmp" "${DATA_DIR}/${SIZE}"
+  fi
+  DIRS="${DIRS} ${DATA_DIR}/${SIZE}"
+done
+
+./bin/bench-suite ${DIRS} > "${BENCH_OUTPUT}"
@@ -0,0 +1,107 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Benchmark of loading every dataset into an Areas object that allocates from
+  the heap and into one that allocates from an arena, timing the load and the
+  teardown separately. With the arena, the teardown is timed both destroying
+  the Areas object before releasing the arena, and only releasing the arena.
+  The arena is either a monotonic_buffer_resource, or the thread safe
+  synchronized_pool_resource that bethyw uses, as the threads that load the
+  datasets allocate from it too (see Areas::merge()).
+
+  Build and run from the root of the repository:
+    ./build.sh bench-arena
+    ./bin/bench-arena [datasets directory]
+ */
+
+#include <cstdio>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+#include "../areas.h"
+#include "../bethyw.h"
+#include "../datasets.h"
+#include "bench.h"
+
+const unsigned int RUNS = 5;
+
+/*
+  How the memory of the Areas object is managed in a run.
+*/
+enum Mode {
+    HEAP,
+    ARENA_DESTROYED,
+    ARENA_RELEASED,
+    POOL_RELEASED
+};
+
+int main(int argc, char* argv[]) {
+    const std::string dir = argc > 1 ? std::string(argv[1]) + DIR_SEP : std::string("datasets") + DIR_SEP;
+
+    std::vector<BethYw::InputFileSource> datasets;
+    BethYw::addAllDatasets(datasets);
+
+    const std::unordered_set<std::string> noFilter;
+    const std::tuple<unsigned int, unsigned int> allYears(0, 0);
+
+    std::printf("Loading %zu datasets from %s, best of %u runs\n\n", datasets.size(), dir.c_str(), RUNS);
+    std::printf("%-26s %12s %12s\n", "", "load (ms)", "exit (ms)");
+
+    const Mode modes[] = {HEAP, ARENA_DESTROYED, ARENA_RELEASED, POOL_RELEASED};
+    const char* const names[] = {"heap", "arena, destroyed", "arena, released", "pool, released"};
+
+    for (const Mode mode : modes) {
+        double bestLoad = -1;
+        double bestExit = -1;
+
+        for (unsigned int run = 0; run < RUNS; run++) {
+            std::unique_ptr<std::pmr::memory_resource> arena;
+            Areas* areas = nullptr;
+
+            const double load = Bench::time([&]() {
+                if (mode == HEAP) {
+                    areas = new Areas();
+                } else {
+                    if (mode == POOL_RELEASED) {
+                        arena = std::make_unique<std::pmr::synchronized_pool_resource>();
+                    } else {
+                        arena = std::make_unique<std::pmr::monotonic_buffer_resource>();
+                    }
+                    areas = new (arena->allocate(sizeof(Areas), alignof(Areas))) Areas(arena.get());
+                }
+
+                BethYw::loadAreas(*areas, dir, noFilter);
+                BethYw::loadDatasets(*areas, dir, datasets, noFilter, noFilter, allYears, 1);
+            });
+
+            const double exit = Bench::time([&]() {
+                if (mode == HEAP) {
+                    delete areas;
+                } else if (mode == ARENA_DESTROYED) {
+                    areas->~Areas();
+                }
+                arena.reset();
+            });
+
+            if (bestLoad < 0 || load < bestLoad) {
+                bestLoad = load;
+            }
+            if (bestExit < 0 || exit < bestExit) {
+                bestExit = exit;
+            }
+        }
+
+        std::printf("%-26s %12.2f %12.2f\n", names[mode], bestLoad * 1000, bestExit * 1000);
+    }
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Benchmark of the kernels that find the delimiters of CSV text, on their own
+  and through a CsvTokenizer reading every field. The text is generated in
+  memory in the format of the Authority By Year CSV datasets, with one column
+  per year. Kernels the processor does not support are skipped.
+
+  Build and run from the root of the repository:
+    ./build.sh bench-csv-scan
+    ./bin/bench-csv-scan [megabytes=256] [years=200]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../csv.h"
+#include "bench.h"
+
+const unsigned int RUNS = 5;
+const std::size_t WINDOW = 16 * 1024;
+
+/*Returns text in the format of the complete-popu1009 datasets, with values of varying length.*/
+static std::string generate(std::size_t bytes, unsigned int years) {
+    std::string text = "AuthorityCode";
+    for (unsigned int y = 0; y < years; y++) {
+        text += "," + std::to_string(1801 + y);
+    }
+    text += "\r\n";
+
+    unsigned long seed = 12345;
+    for (unsigned long a = 0; text.size() < bytes; a++) {
+        text += "W" + std::to_string(10000000 + a);
+        for (unsigned int y = 0; y < years; y++) {
+            seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+            text += "," + std::to_string((seed >> 33) % 100000) + "." + std::to_string((seed >> 20) % 100);
+        }
+        text += "\r\n";
+    }
+
+    return text;
+}
+
+int main(int argc, char* argv[]) {
+    const std::size_t megabytes = argc > 1 ? std::atol(argv[1]) : 256;
+    const unsigned int years = argc > 2 ? std::atoi(argv[2]) : 200;
+
+    const std::string text = generate(megabytes * 1000 * 1000, years);
+    const double gigabytes = text.size() / 1e9;
+    std::vector<std::size_t> positions(WINDOW);
+
+    std::printf("Scanning %.1f MB of CSV text with %u years per row, best of %u runs\n\n",
+                text.size() / 1e6, years, RUNS);
+    std::printf("%-8s %14s %14s %16s %16s\n", "kernel", "delimiters", "scan (GB/s)", "fields", "tokenizer (GB/s)");
+
+    const CsvTokenizer::Kernel kernels[] = {CsvTokenizer::SCALAR, CsvTokenizer::SSE2, CsvTokenizer::AVX2};
+    for (const CsvTokenizer::Kernel kernel : kernels) {
+        if (!CsvTokenizer::supports(kernel)) {
+            std::printf("%-8s %14s\n", CsvTokenizer::kernelName(kernel), "not supported");
+            continue;
+        }
+
+        //the windows are scanned one after the other, as the tokenizer does
+        std::size_t numDelimiters = 0;
+        const double scan = Bench::bestOf(RUNS, [&]() {
+            numDelimiters = 0;
+            for (std::size_t start = 0; start < text.size(); start += WINDOW) {
+                const std::size_t length = std::min(WINDOW, text.size() - start);
+                numDelimiters += CsvTokenizer::findDelimiters(text.data() + start, length, start,
+                                                              positions.data(), kernel);
+            }
+        });
+
+        std::size_t numFields = 0;
+        const double tokenize = Bench::bestOf(RUNS, [&]() {
+            numFields = 0;
+            CsvTokenizer csv(text, kernel);
+            std::string_view field;
+            while (csv.nextRow()) {
+                while (csv.nextField(field)) {
+                    numFields++;
+                }
+            }
+        });
+
+        std::printf("%-8s %14zu %14.2f %16zu %16.2f\n", CsvTokenizer::kernelName(kernel), numDelimiters,
+                    gigabytes / scan, numFields, gigabytes / tokenize);
+    }
+
+    return 0;
+}
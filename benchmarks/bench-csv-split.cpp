@@ -0,0 +1,106 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Benchmark of importing a large Authority By Year CSV file split into chunks
+  with an increasing number of threads, from 1 up to the number of cores (or
+  the number given on the command line). The file is generated first, with
+  one row per authority and one column per year, and is removed at the end.
+
+  Every field of every row is read, but only the values of the last few years
+  are kept (10 by default), so that millions of authorities with hundreds of
+  years fit in memory.
+
+  Build and run from the root of the repository:
+    ./build.sh bench-csv-split
+    ./bin/bench-csv-split [max threads] [authorities] [years] [kept years]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <tuple>
+
+#include "../areas.h"
+#include "../datasets.h"
+#include "../input.h"
+#include "bench.h"
+
+const unsigned int RUNS = 3;
+const char* const FILE_NAME = "bench-csv-split.tmp";
+
+/*Writes a file in the format of the complete-popu1009 datasets, with values of varying length.*/
+static void generate(const char* path, unsigned long authorities, unsigned int years, unsigned int firstYear) {
+    std::FILE* file = std::fopen(path, "wb");
+    if (file == nullptr) {
+        std::fprintf(stderr, "Can not write %s\n", path);
+        std::exit(1);
+    }
+
+    std::string line = "AuthorityCode";
+    for (unsigned int y = 0; y < years; y++) {
+        line += "," + std::to_string(firstYear + y);
+    }
+    line += "\n";
+    std::fwrite(line.data(), 1, line.size(), file);
+
+    unsigned long seed = 12345;
+    for (unsigned long a = 0; a < authorities; a++) {
+        line = "W" + std::to_string(10000000 + a);
+        for (unsigned int y = 0; y < years; y++) {
+            seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+            line += "," + std::to_string((seed >> 33) % 100000) + "." + std::to_string((seed >> 20) % 100);
+        }
+        line += "\n";
+        std::fwrite(line.data(), 1, line.size(), file);
+    }
+
+    std::fclose(file);
+}
+
+int main(int argc, char* argv[]) {
+    unsigned int maxThreads = argc > 1 ? std::atoi(argv[1]) : std::thread::hardware_concurrency();
+    const unsigned long authorities = argc > 2 ? std::atol(argv[2]) : 2000000;
+    const unsigned int years = argc > 3 ? std::atoi(argv[3]) : 200;
+    const unsigned int keptYears = argc > 4 ? std::atoi(argv[4]) : 10;
+
+    if (maxThreads == 0) {
+        maxThreads = 1;
+    }
+
+    const unsigned int firstYear = 1801;
+    generate(FILE_NAME, authorities, years, firstYear);
+
+    MmapInputFile file(FILE_NAME);
+    file.open();
+
+    const std::tuple<unsigned int, unsigned int> yearsFilter(firstYear + years - keptYears, firstYear + years - 1);
+    const double megabytes = file.bytes().size() / 1e6;
+
+    std::printf("Loading %lu authorities with %u years (%.1f MB, keeping %u years), best of %u runs\n\n",
+                authorities, years, megabytes, keptYears, RUNS);
+    std::printf("%8s %12s %10s %12s %10s\n", "threads", "time (ms)", "MB/s", "rows/s", "speedup");
+
+    double sequential = 0;
+    for (unsigned int threads = 1; threads <= maxThreads; threads++) {
+        double seconds = Bench::bestOf(RUNS, [&]() {
+            Areas areas;
+            areas.populateFromAuthorityByYearCSV(file.bytes(), BethYw::InputFiles::COMPLETE_POP.COLS,
+                                                 nullptr, nullptr, &yearsFilter, threads);
+        });
+
+        if (threads == 1) {
+            sequential = seconds;
+        }
+
+        std::printf("%8u %12.2f %10.1f %12.0f %9.2fx\n", threads, seconds * 1000, megabytes / seconds,
+                    authorities / seconds, sequential / seconds);
+    }
+
+    std::remove(FILE_NAME);
+    return 0;
+}
@@ -0,0 +1,100 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Benchmark of checking area codes and names against an areas filter of 1, 10
+  and 1000 strings, comparing FilterMatcher with the way filters used to be
+  checked (case-fold the data into a new string, look it up in the set, then
+  search for every string of the set in it).
+
+  Build and run from the root of the repository:
+    ./build.sh bench-filter
+    ./bin/bench-filter [number of checks]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "../bethyw.h"
+#include "../filter.h"
+#include "bench.h"
+
+const unsigned int RUNS = 5;
+
+//stops the compiler from optimising away the results we compute
+volatile size_t sink;
+
+bool oldIsIncludedInFilter(const std::unordered_set<std::string>* const filter, const std::string& data) {
+    std::string upperCaseData = BethYw::toUpper(data);
+
+    if (filter == nullptr || filter->empty()) {
+        return true;
+    } else if (filter->find(upperCaseData) != filter->end()) {
+        return true;
+    } else {
+        for (auto it = filter->begin(); it != filter->end(); it++) {
+            if (upperCaseData.find(*it) != std::string::npos) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+}
+
+/*Builds a filter of the given size from authority codes that do not exist, plus one name that does, as a user
+ * selecting a few areas would.*/
+std::unordered_set<std::string> makeFilter(size_t size) {
+    std::unordered_set<std::string> filter = {"NEWPORT"};
+
+    for (size_t i = 0; filter.size() < size; i++) {
+        char code[16];
+        std::snprintf(code, sizeof(code), "W%08zu", 90000000 + i);
+        filter.insert(code);
+    }
+
+    return filter;
+}
+
+int main(int argc, char* argv[]) {
+    const size_t checks = argc > 1 ? std::atol(argv[1]) : 1000000;
+
+    const std::vector<std::string> data = {"W06000011", "Swansea", "W06000015", "Cardiff", "W06000022", "Newport",
+                                           "W06000024", "Merthyr Tydfil", "W92000004", "Wales"};
+
+    std::printf("%zu checks of area codes and names, best of %u runs\n\n", checks, RUNS);
+    std::printf("%8s %16s %16s %10s\n", "strings", "old (ns/check)", "new (ns/check)", "speedup");
+
+    const size_t sizes[] = {1, 10, 1000};
+    for (size_t size : sizes) {
+        const std::unordered_set<std::string> filter = makeFilter(size);
+        const FilterMatcher matcher(&filter, FilterMatcher::UPPER);
+
+        double oldSeconds = Bench::bestOf(RUNS, [&]() {
+            size_t included = 0;
+            for (size_t i = 0; i < checks; i++) {
+                included += oldIsIncludedInFilter(&filter, data[i % data.size()]);
+            }
+            sink = included;
+        });
+
+        double newSeconds = Bench::bestOf(RUNS, [&]() {
+            size_t included = 0;
+            for (size_t i = 0; i < checks; i++) {
+                included += matcher.matches(data[i % data.size()]);
+            }
+            sink = included;
+        });
+
+        std::printf("%8zu %16.1f %16.1f %9.1fx\n", size, oldSeconds * 1e9 / checks, newSeconds * 1e9 / checks,
+                    oldSeconds / newSeconds);
+    }
+
+    return 0;
+}
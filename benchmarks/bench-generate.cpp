@@ -0,0 +1,285 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Generator of synthetic datasets for the benchmarks. It writes a file for
+  areas.csv and for every dataset in datasets.h, under the same file names
+  and with the same columns, so the directory can be used with bethyw --dir
+  as well as with bench-suite:
+
+    - areas.csv in the AuthorityCodeCSV shape
+    - the four StatsWales JSON files in the WelshStatsJSON shape, with a row
+      for every area, measure and year (the air quality one with its values
+      as strings, and the rail one without measure columns, like the real
+      files)
+    - the three complete-popu1009 files in the AuthorityByYearCSV shape, with
+      a row for every area and a column for every year
+
+  Without --size every file has --areas areas. With --size each file gets as
+  many areas as it needs to reach that size (which can be several GB), and
+  areas.csv lists all the areas used by any of them. The output only depends
+  on the options, so the same options always give the same files.
+
+  Build and run from the root of the repository:
+    ./build.sh bench-generate
+    ./bin/bench-generate <output directory> [--areas N] [--measures N]
+                         [--years N] [--size BYTES[K|M|G]] [--seed N]
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+#include <sys/stat.h>
+
+#include "../datasets.h"
+
+/*
+  The options of the generator.
+*/
+struct Options {
+    std::string dir;
+    unsigned long areas = 22;
+    unsigned long measures = 3;
+    unsigned long years = 29;
+    unsigned long firstYear = 1991;
+    unsigned long long size = 0;
+    unsigned long long seed = 1;
+};
+
+/*
+  Writes text to a file through a large buffer, counting the bytes written.
+*/
+class Output {
+private:
+    std::FILE* file;
+    std::string buffer;
+    unsigned long long written;
+
+public:
+    Output(const std::string& path) : file(std::fopen(path.c_str(), "wb")), buffer(), written(0) {
+        if (file == nullptr) {
+            throw std::runtime_error("Could not create file " + path);
+        }
+        buffer.reserve(1 << 20);
+    }
+
+    ~Output() {
+        flush();
+        std::fclose(file);
+    }
+
+    void append(const std::string& text) {
+        buffer.append(text);
+        written += text.size();
+
+        if (buffer.size() >= (1 << 20)) {
+            flush();
+        }
+    }
+
+    void flush() {
+        if (!buffer.empty() && std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) {
+            throw std::runtime_error("Could not write to file");
+        }
+        buffer.clear();
+    }
+
+    unsigned long long size() const {
+        return written;
+    }
+};
+
+/*Mixes the seed and the given numbers into a pseudo-random number (splitmix64), so every value only depends on its
+ * area, measure and year, and the files do not depend on the random number generators of the standard library.*/
+static uint64_t mix(uint64_t seed, uint64_t a, uint64_t b, uint64_t c) {
+    uint64_t x = seed ^ (a * 0x9E3779B97F4A7C15ULL) ^ (b * 0xBF58476D1CE4E5B9ULL) ^ (c * 0x94D049BB133111EBULL);
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+static std::string areaCode(unsigned long area) {
+    char code[16];
+    std::snprintf(code, sizeof(code), "W%08lu", 6000001 + area);
+    return code;
+}
+
+static std::string value(const Options& options, unsigned long area, unsigned long measure, unsigned long year) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.6f", mix(options.seed, area, measure, year) % 100000000 / 1000.0);
+    return text;
+}
+
+/*Returns true once enough areas have been written to a file.*/
+static bool done(const Options& options, const Output& out, unsigned long areasWritten) {
+    if (options.size == 0) {
+        return areasWritten >= options.areas;
+    }
+    return out.size() >= options.size;
+}
+
+static std::string quoted(const std::string& str) {
+    return "\"" + str + "\"";
+}
+
+/*Writes a WelshStatsJSON file, and returns the number of areas in it.*/
+static unsigned long writeJSON(const Options& options, const BethYw::InputFileSource& dataset) {
+    Output out(options.dir + "/" + dataset.FILE);
+    const BethYw::SourceColumnMapping& cols = dataset.COLS;
+
+    const bool singleMeasure = cols.count(BethYw::SINGLE_MEASURE_CODE) > 0;
+    const bool stringValues = dataset.CODE == BethYw::InputFiles::AQI.CODE;
+    const unsigned long measures = singleMeasure ? 1 : options.measures;
+
+    out.append("{\n  \"odata.metadata\":\"synthetic\",\"value\":[\n");
+
+    unsigned long area = 0;
+    for (; !done(options, out, area); area++) {
+        for (unsigned long measure = 0; measure < measures; measure++) {
+            for (unsigned long year = 0; year < options.years; year++) {
+                std::string row = area == 0 && measure == 0 && year == 0 ? "    {\n" : ",{\n";
+
+                std::string data = value(options, area, measure, year);
+                row += "      " + quoted(cols.at(BethYw::VALUE)) + ":" + (stringValues ? quoted(data) : data);
+                row += "," + quoted(cols.at(BethYw::AUTH_CODE)) + ":" + quoted(areaCode(area));
+                row += "," + quoted(cols.at(BethYw::AUTH_NAME_ENG)) + ":" + quoted("Area " + std::to_string(area));
+
+                if (!singleMeasure) {
+                    const std::string measureCode = "M" + std::to_string(measure);
+                    const std::string measureName = "Measure " + std::to_string(measure);
+
+                    //the air quality file uses the same column for both
+                    if (cols.at(BethYw::MEASURE_CODE) == cols.at(BethYw::MEASURE_NAME)) {
+                        row += "," + quoted(cols.at(BethYw::MEASURE_CODE)) + ":" + quoted(measureName);
+                    } else {
+                        row += "," + quoted(cols.at(BethYw::MEASURE_CODE)) + ":" + quoted(measureCode);
+                        row += "," + quoted(cols.at(BethYw::MEASURE_NAME)) + ":" + quoted(measureName);
+                    }
+                }
+
+                row += "," + quoted(cols.at(BethYw::YEAR)) + ":" + quoted(std::to_string(options.firstYear + year));
+                row += ",\"RowKey\":\"0000000000000000\",\"PartitionKey\":\"\"\n    }";
+                out.append(row);
+            }
+        }
+    }
+
+    out.append("\n  ]\n}\n");
+    return area;
+}
+
+/*Writes an AuthorityByYearCSV file, and returns the number of areas in it.*/
+static unsigned long writeByYearCSV(const Options& options, const BethYw::InputFileSource& dataset, unsigned long id) {
+    Output out(options.dir + "/" + dataset.FILE);
+
+    std::string header = dataset.COLS.at(BethYw::AUTH_CODE);
+    for (unsigned long year = 0; year < options.years; year++) {
+        header += "," + std::to_string(options.firstYear + year);
+    }
+    out.append(header + "\n");
+
+    unsigned long area = 0;
+    for (; !done(options, out, area); area++) {
+        std::string row = areaCode(area);
+        for (unsigned long year = 0; year < options.years; year++) {
+            row += "," + value(options, area, id, year);
+        }
+        out.append(row + "\n");
+    }
+
+    return area;
+}
+
+/*Writes areas.csv with at least the given number of areas.*/
+static void writeAreasCSV(const Options& options, unsigned long minAreas) {
+    Output out(options.dir + "/" + BethYw::InputFiles::AREAS.FILE);
+    const BethYw::SourceColumnMapping& cols = BethYw::InputFiles::AREAS.COLS;
+
+    out.append(cols.at(BethYw::AUTH_CODE) + "," + cols.at(BethYw::AUTH_NAME_ENG) + "," +
+               cols.at(BethYw::AUTH_NAME_CYM) + "\n");
+
+    unsigned long area = 0;
+    for (; area < minAreas || !done(options, out, area); area++) {
+        out.append(areaCode(area) + ",Area " + std::to_string(area) + ",Ardal " + std::to_string(area) + "\n");
+    }
+}
+
+static unsigned long long parseSize(const std::string& str) {
+    char* end;
+    unsigned long long size = std::strtoull(str.c_str(), &end, 10);
+
+    switch (*end) {
+        case 'G': size *= 1024;
+            // fall through
+        case 'M': size *= 1024;
+            // fall through
+        case 'K': size *= 1024;
+            end++;
+    }
+
+    if (*end != '\0') {
+        throw std::invalid_argument("Invalid size: " + str);
+    }
+    return size;
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        if (argc < 2) {
+            throw std::invalid_argument("Usage: bench-generate <output directory> [--areas N] [--measures N] "
+                                        "[--years N] [--size BYTES[K|M|G]] [--seed N]");
+        }
+
+        Options options;
+        options.dir = argv[1];
+
+        for (int i = 2; i + 1 < argc; i += 2) {
+            const std::string option = argv[i];
+            const std::string value = argv[i + 1];
+
+            if (option == "--areas") {
+                options.areas = std::stoul(value);
+            } else if (option == "--measures") {
+                options.measures = std::stoul(value);
+            } else if (option == "--years") {
+                options.years = std::stoul(value);
+            } else if (option == "--size") {
+                options.size = parseSize(value);
+            } else if (option == "--seed") {
+                options.seed = std::stoull(value);
+            } else {
+                throw std::invalid_argument("Unknown option: " + option);
+            }
+        }
+
+        if (options.areas == 0 || options.measures == 0 || options.years == 0 || options.years > 9999 - 1991) {
+            throw std::invalid_argument("--areas, --measures and --years must be between 1 and 8008");
+        }
+
+        mkdir(options.dir.c_str(), 0755);
+
+        unsigned long maxAreas = 0;
+        for (unsigned int i = 0; i < BethYw::InputFiles::NUM_DATASETS; i++) {
+            const BethYw::InputFileSource& dataset = BethYw::InputFiles::DATASETS[i];
+            unsigned long areas = dataset.PARSER == BethYw::WelshStatsJSON ? writeJSON(options, dataset)
+                                                                           : writeByYearCSV(options, dataset, i);
+            if (areas > maxAreas) {
+                maxAreas = areas;
+            }
+        }
+
+        writeAreasCSV(options, maxAreas);
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "%s\n", ex.what());
+        return 1;
+    }
+
+    return 0;
+}
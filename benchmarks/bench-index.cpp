@@ -0,0 +1,74 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Benchmark of importing a single area from every dataset without an index,
+  with indexes that have to be built first (cold) and with up to date indexes
+  (warm). Only the loading is timed, not the output. The indexes are removed
+  at the end.
+
+  Build and run from the root of the repository:
+    ./build.sh bench-index
+    ./bin/bench-index [datasets directory] [authority code]
+ */
+
+#include <cstdio>
+#include <string>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+#include "../areas.h"
+#include "../bethyw.h"
+#include "../datasets.h"
+#include "../rowindex.h"
+#include "bench.h"
+
+const unsigned int RUNS = 3;
+
+/*Removes the index of every dataset, so the next indexed load has to build them.*/
+static void removeIndexes(const std::string& dir, const std::vector<BethYw::InputFileSource>& datasets) {
+    for (auto it = datasets.begin(); it != datasets.end(); it++) {
+        std::remove(RowIndex::pathFor(dir, *it).c_str());
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const std::string dir = argc > 1 ? std::string(argv[1]) + DIR_SEP : std::string("datasets") + DIR_SEP;
+    const std::unordered_set<std::string> areasFilter = {argc > 2 ? std::string(argv[2]) : std::string("W06000011")};
+
+    std::vector<BethYw::InputFileSource> datasets;
+    BethYw::addAllDatasets(datasets);
+
+    const std::unordered_set<std::string> noFilter;
+    const std::tuple<unsigned int, unsigned int> allYears(0, 0);
+
+    std::printf("Loading %s from %zu datasets in %s, best of %u runs\n\n", areasFilter.begin()->c_str(),
+                datasets.size(), dir.c_str(), RUNS);
+    std::printf("%-16s %12s\n", "", "time (ms)");
+
+    double seconds = Bench::bestOf(RUNS, [&]() {
+        Areas areas;
+        BethYw::loadDatasets(areas, dir, datasets, areasFilter, noFilter, allYears, 1);
+    });
+    std::printf("%-16s %12.2f\n", "no index", seconds * 1000);
+
+    seconds = Bench::bestOf(RUNS, [&]() {
+        removeIndexes(dir, datasets);
+        Areas areas;
+        BethYw::loadDatasets(areas, dir, datasets, areasFilter, noFilter, allYears, 1, true);
+    });
+    std::printf("%-16s %12.2f\n", "cold index", seconds * 1000);
+
+    seconds = Bench::bestOf(RUNS, [&]() {
+        Areas areas;
+        BethYw::loadDatasets(areas, dir, datasets, areasFilter, noFilter, allYears, 1, true);
+    });
+    std::printf("%-16s %12.2f\n", "warm index", seconds * 1000);
+
+    removeIndexes(dir, datasets);
+    return 0;
+}
@@ -0,0 +1,101 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Benchmark comparing the streaming (SAX) ingest of the StatsWales JSON files
+  against materialising the whole document as a json object, which is what
+  Areas::populateFromWelshStatsJSON used to do before iterating over "value".
+
+  The document numbers only cover parsing the file into a json object and
+  visiting every row, so they are a lower bound for the old code path, which
+  also built the Area and Measure objects on top of that.
+
+  Build and run from the root of the repository:
+    ./build.sh bench-json-ingest
+    ./bin/bench-json-ingest [datasets directory]
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <unordered_set>
+
+#include "../lib_json.hpp"
+#include "../datasets.h"
+#include "../areas.h"
+#include "../input.h"
+#include "bench.h"
+
+const unsigned int RUNS = 5;
+
+/*Runs the given code RUNS times in child processes and keeps the best time and the worst peak memory.*/
+Bench::Sample measure(const std::function<void()>& fn) {
+    Bench::Sample result = {-1, -1};
+
+    for (unsigned int i = 0; i < RUNS; i++) {
+        Bench::Sample sample = Bench::isolated(fn);
+
+        if (result.seconds < 0 || sample.seconds < result.seconds) {
+            result.seconds = sample.seconds;
+        }
+        if (sample.peakRssKb > result.peakRssKb) {
+            result.peakRssKb = sample.peakRssKb;
+        }
+    }
+
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    const std::string dir = argc > 1 ? std::string(argv[1]) + "/" : std::string("datasets/");
+    const BethYw::InputFileSource* datasets[] = {&BethYw::InputFiles::POPDEN,
+                                                 &BethYw::InputFiles::BIZ,
+                                                 &BethYw::InputFiles::AQI,
+                                                 &BethYw::InputFiles::TRAINS};
+
+    Bench::Sample idle = measure([]() {});
+    std::printf("Process baseline: %ld KB peak RSS\n\n", idle.peakRssKb);
+    std::printf("%-16s %10s %14s %14s %14s %14s\n", "file", "size (KB)", "dom time (ms)", "dom RSS (KB)",
+                "sax time (ms)", "sax RSS (KB)");
+
+    for (const BethYw::InputFileSource* dataset : datasets) {
+        const std::string path = dir + dataset->FILE;
+
+        std::ifstream sizeCheck(path, std::ios::binary | std::ios::ate);
+        if (!sizeCheck.is_open()) {
+            std::fprintf(stderr, "Could not open %s\n", path.c_str());
+            return 1;
+        }
+        long sizeKb = static_cast<long>(sizeCheck.tellg()) / 1024;
+
+        Bench::Sample dom = measure([&]() {
+            InputFile file(path);
+            json j;
+            file.open() >> j;
+
+            size_t rows = 0;
+            for (auto& row : j.at("value")) {
+                rows += row.size();
+            }
+            if (rows == 0) {
+                _exit(1);
+            }
+        });
+
+        Bench::Sample sax = measure([&]() {
+            InputFile file(path);
+            Areas areas;
+            const StringFilterSet noFilter;
+            const YearFilterTuple allYears(0, 0);
+            areas.populate(file.open(), dataset->PARSER, dataset->COLS, &noFilter, &noFilter, &allYears);
+        });
+
+        std::printf("%-16s %10ld %14.2f %14ld %14.2f %14ld\n", dataset->FILE.c_str(), sizeKb,
+                    dom.seconds * 1000, dom.peakRssKb, sax.seconds * 1000, sax.peakRssKb);
+    }
+
+    return 0;
+}
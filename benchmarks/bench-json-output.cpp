@@ -0,0 +1,70 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Benchmark of writing every dataset as JSON, comparing Areas::writeJSON with
+  building a JSON object with to_json() and dumping it, as toJSON() used to.
+  The output goes to /dev/null. Each way is run in a child process after the
+  datasets are loaded, so the peak memory reported includes the loaded data,
+  and the difference between the two is the memory needed for the output.
+
+  Build and run from the root of the repository:
+    ./build.sh bench-json-output
+    ./bin/bench-json-output [datasets directory]
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+#include "../lib_json.hpp"
+#include "../areas.h"
+#include "../bethyw.h"
+#include "../datasets.h"
+#include "bench.h"
+
+int main(int argc, char* argv[]) {
+    const std::string dir = argc > 1 ? std::string(argv[1]) + DIR_SEP : std::string("datasets") + DIR_SEP;
+
+    std::vector<BethYw::InputFileSource> datasets;
+    BethYw::addAllDatasets(datasets);
+
+    const std::unordered_set<std::string> noFilter;
+    const std::tuple<unsigned int, unsigned int> allYears(0, 0);
+
+    Areas areas;
+    BethYw::loadAreas(areas, dir, noFilter);
+    BethYw::loadDatasets(areas, dir, datasets, noFilter, noFilter, allYears);
+
+    Bench::Sample baseline = Bench::isolated([&]() {
+        std::ofstream out("/dev/null");
+        out << areas.size() << std::endl;
+    });
+
+    Bench::Sample dom = Bench::isolated([&]() {
+        std::ofstream out("/dev/null");
+        json j;
+        to_json(j, areas);
+        out << j.dump() << std::endl;
+    });
+
+    Bench::Sample streamed = Bench::isolated([&]() {
+        std::ofstream out("/dev/null");
+        areas.writeJSON(out);
+        out << std::endl;
+    });
+
+    std::printf("Writing %zu datasets from %s as JSON\n\n", datasets.size(), dir.c_str());
+    std::printf("%-20s %12s %16s\n", "", "time (ms)", "peak RSS KB");
+    std::printf("%-20s %12s %16ld\n", "loaded data only", "", baseline.peakRssKb);
+    std::printf("%-20s %12.2f %16ld\n", "to_json + dump", dom.seconds * 1000, dom.peakRssKb);
+    std::printf("%-20s %12.2f %16ld\n", "writeJSON", streamed.seconds * 1000, streamed.peakRssKb);
+
+    return 0;
+}
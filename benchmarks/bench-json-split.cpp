@@ -0,0 +1,85 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Benchmark of importing a single StatsWales JSON file split into chunks with
+  an increasing number of threads, from 1 up to the number of cores (or the
+  number given on the command line). The time taken to split the file is also
+  given on its own, as it is the part that is not spread over the threads as
+  evenly. Only the loading is timed, not the output.
+
+  Build and run from the root of the repository:
+    ./build.sh bench-json-split
+    ./bin/bench-json-split [max threads] [datasets directory] [dataset code]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../areas.h"
+#include "../bethyw.h"
+#include "../datasets.h"
+#include "../input.h"
+#include "../jsonstream.h"
+#include "bench.h"
+
+const unsigned int RUNS = 3;
+
+int main(int argc, char* argv[]) {
+    unsigned int maxThreads = argc > 1 ? std::atoi(argv[1]) : std::thread::hardware_concurrency();
+    const std::string dir = argc > 2 ? std::string(argv[2]) + DIR_SEP : std::string("datasets") + DIR_SEP;
+    const std::string code = argc > 3 ? std::string(argv[3]) : std::string("popden");
+
+    if (maxThreads == 0) {
+        maxThreads = 1;
+    }
+
+    const BethYw::InputFileSource* dataset = nullptr;
+    for (unsigned int i = 0; i < BethYw::InputFiles::NUM_DATASETS; i++) {
+        if (BethYw::InputFiles::DATASETS[i].CODE == code &&
+                BethYw::InputFiles::DATASETS[i].PARSER == BethYw::WelshStatsJSON) {
+            dataset = &BethYw::InputFiles::DATASETS[i];
+        }
+    }
+
+    if (dataset == nullptr) {
+        std::fprintf(stderr, "%s is not a JSON dataset\n", code.c_str());
+        return 1;
+    }
+
+    MmapInputFile file(dir + dataset->FILE);
+    file.open();
+
+    std::printf("Loading %s (%.1f MB), best of %u runs\n\n", file.getSource().c_str(),
+                file.bytes().size() / 1e6, RUNS);
+    std::printf("%8s %8s %12s %12s %10s\n", "threads", "chunks", "split (ms)", "time (ms)", "speedup");
+
+    double sequential = 0;
+    for (unsigned int threads = 1; threads <= maxThreads; threads++) {
+        std::size_t numChunks = 0;
+        double split = Bench::bestOf(RUNS, [&]() {
+            numChunks = threads > 1 ? JsonRowReader::splitRows(file.bytes(), threads * 4, threads).size() : 1;
+        });
+
+        double seconds = Bench::bestOf(RUNS, [&]() {
+            Areas areas;
+            areas.populateFromWelshStatsJSON(file.bytes(), dataset->COLS, nullptr, nullptr, nullptr, threads);
+        });
+
+        if (threads == 1) {
+            sequential = seconds;
+            split = 0;
+        }
+
+        std::printf("%8u %8zu %12.2f %12.2f %9.2fx\n", threads, numChunks, split * 1000, seconds * 1000,
+                    sequential / seconds);
+    }
+
+    return 0;
+}
@@ -0,0 +1,152 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Micro-benchmarks of the container Measure stores its values in, comparing
+  YearSeries with the std::map<int, double> it replaced: inserting a range of
+  years, looking years up, and aggregating (the sum used for the average and
+  ordered iteration used for output). It also reports the peak memory of
+  holding many series of each kind at once.
+
+  Build and run from the root of the repository:
+    ./build.sh bench-measure
+    ./bin/bench-measure [number of series]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+#include "../yearseries.h"
+#include "bench.h"
+
+const unsigned int RUNS = 5;
+const int FIRST_YEAR = 1991;
+const int LAST_YEAR = 2019;
+
+//stops the compiler from optimising away the results we compute
+volatile double sink;
+
+template<typename Series>
+void insertYears(Series& series);
+
+template<>
+void insertYears(std::map<int, double>& series) {
+    for (int year = FIRST_YEAR; year <= LAST_YEAR; year++) {
+        series[year] = year * 0.5;
+    }
+}
+
+template<>
+void insertYears(YearSeries& series) {
+    for (int year = FIRST_YEAR; year <= LAST_YEAR; year++) {
+        series.set(year, year * 0.5);
+    }
+}
+
+double lookup(const std::map<int, double>& series, int year) {
+    auto it = series.find(year);
+    return it == series.end() ? 0 : it->second;
+}
+
+double lookup(const YearSeries& series, int year) {
+    const double* value = series.find(year);
+    return value == nullptr ? 0 : *value;
+}
+
+double sum(const std::map<int, double>& series) {
+    double total = 0;
+    for (auto it = series.begin(); it != series.end(); it++) {
+        total += it->second;
+    }
+    return total;
+}
+
+double sum(const YearSeries& series) {
+    return series.sum();
+}
+
+template<typename Series>
+double iterate(const Series& series) {
+    double total = 0;
+    for (auto it = series.begin(); it != series.end(); it++) {
+        total += it->first + it->second;
+    }
+    return total;
+}
+
+/*Returns the peak memory of holding `count` series at once. It is measured in a child process, so it has to be called
+ * before the parent allocates anything big, as the child starts with the memory of the parent.*/
+template<typename Series>
+long footprint(size_t count) {
+    Bench::Sample sample = Bench::isolated([&]() {
+        std::vector<Series> held(count);
+        for (auto it = held.begin(); it != held.end(); it++) {
+            insertYears(*it);
+        }
+        sink = sum(held.back());
+    });
+
+    return sample.peakRssKb;
+}
+
+template<typename Series>
+void run(const char* name, size_t count, long peakRssKb) {
+    std::vector<Series> all(count);
+
+    double insert = Bench::bestOf(RUNS, [&]() {
+        all.assign(count, Series());
+        for (auto it = all.begin(); it != all.end(); it++) {
+            insertYears(*it);
+        }
+    });
+
+    double find = Bench::bestOf(RUNS, [&]() {
+        double total = 0;
+        for (auto it = all.begin(); it != all.end(); it++) {
+            for (int year = FIRST_YEAR - 2; year <= LAST_YEAR + 2; year++) {
+                total += lookup(*it, year);
+            }
+        }
+        sink = total;
+    });
+
+    double aggregate = Bench::bestOf(RUNS, [&]() {
+        double total = 0;
+        for (auto it = all.begin(); it != all.end(); it++) {
+            total += sum(*it);
+        }
+        sink = total;
+    });
+
+    double ordered = Bench::bestOf(RUNS, [&]() {
+        double total = 0;
+        for (auto it = all.begin(); it != all.end(); it++) {
+            total += iterate(*it);
+        }
+        sink = total;
+    });
+
+    std::printf("%-24s %10.2f %10.2f %10.2f %10.2f %12ld\n", name, insert * 1000, find * 1000, aggregate * 1000,
+                ordered * 1000, peakRssKb);
+}
+
+int main(int argc, char* argv[]) {
+    const size_t count = argc > 1 ? std::atol(argv[1]) : 100000;
+
+    std::printf("%zu series of %d years each, best of %u runs (times in ms)\n\n", count, LAST_YEAR - FIRST_YEAR + 1,
+                RUNS);
+    std::printf("%-24s %10s %10s %10s %10s %12s\n", "", "insert", "lookup", "sum", "iterate", "peak RSS KB");
+
+    const long mapMemory = footprint<std::map<int, double>>(count);
+    const long seriesMemory = footprint<YearSeries>(count);
+
+    run<std::map<int, double>>("std::map<int, double>", count, mapMemory);
+    run<YearSeries>("YearSeries", count, seriesMemory);
+
+    return 0;
+}
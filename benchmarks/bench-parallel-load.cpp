@@ -0,0 +1,65 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Benchmark of BethYw::loadDatasets loading every dataset with an increasing
+  number of threads, from 1 up to the number of cores (or the number given on
+  the command line). Only the loading is timed, not the output.
+
+  Build and run from the root of the repository:
+    ./build.sh bench-parallel-load
+    ./bin/bench-parallel-load [max threads] [datasets directory]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+#include "../areas.h"
+#include "../bethyw.h"
+#include "../datasets.h"
+#include "bench.h"
+
+const unsigned int RUNS = 5;
+
+int main(int argc, char* argv[]) {
+    unsigned int maxThreads = argc > 1 ? std::atoi(argv[1]) : std::thread::hardware_concurrency();
+    const std::string dir = argc > 2 ? std::string(argv[2]) + DIR_SEP : std::string("datasets") + DIR_SEP;
+
+    if (maxThreads == 0) {
+        maxThreads = 1;
+    }
+
+    std::vector<BethYw::InputFileSource> datasets;
+    BethYw::addAllDatasets(datasets);
+
+    const std::unordered_set<std::string> noFilter;
+    const std::tuple<unsigned int, unsigned int> allYears(0, 0);
+
+    std::printf("Loading %zu datasets from %s, best of %u runs\n\n", datasets.size(), dir.c_str(), RUNS);
+    std::printf("%8s %12s %10s\n", "threads", "time (ms)", "speedup");
+
+    double sequential = 0;
+    for (unsigned int threads = 1; threads <= maxThreads; threads++) {
+        double seconds = Bench::bestOf(RUNS, [&]() {
+            Areas areas;
+            BethYw::loadAreas(areas, dir, noFilter);
+            BethYw::loadDatasets(areas, dir, datasets, noFilter, noFilter, allYears, threads);
+        });
+
+        if (threads == 1) {
+            sequential = seconds;
+        }
+
+        std::printf("%8u %12.2f %9.2fx\n", threads, seconds * 1000, sequential / seconds);
+    }
+
+    return 0;
+}
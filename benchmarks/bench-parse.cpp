@@ -0,0 +1,111 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Micro-benchmarks of converting the text of the datasets to numbers,
+  comparing the functions in numbers.h with what they replaced: checking a
+  value with strtod() and converting it again with std::stod() (CSV files),
+  std::stod() alone (values stored as strings in JSON files), and reading
+  years with strtol(). The values are like those of the datasets: numbers with
+  a few decimal places, some of them whole, and 4 digit years.
+
+  Build and run from the root of the repository:
+    ./build.sh bench-parse
+    ./bin/bench-parse [number of values]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "../numbers.h"
+#include "bench.h"
+
+const unsigned int RUNS = 5;
+
+//stops the compiler from optimising away the results we compute
+volatile double sink;
+
+/*The previous way of reading a value: BethYw::isDouble() checked it with strtod(), then std::stod() converted it.*/
+static double oldDouble(const std::string& str) {
+    char* endptr;
+    std::strtod(str.c_str(), &endptr);
+
+    return *endptr == '\0' ? std::stod(str) : 0;
+}
+
+/*The previous way of reading a value stored as a string in a JSON file.*/
+static double oldJsonDouble(const std::string& str) {
+    return std::stod(str);
+}
+
+/*The previous way of reading a year, from Areas::parseYear().*/
+static unsigned int oldYear(const std::string& str) {
+    char* end;
+    unsigned int year = strtol(str.c_str(), &end, 10);
+
+    return *end == '\0' ? year : 0;
+}
+
+static double newDouble(const std::string& str) {
+    double value;
+    return BethYw::toDouble(str, value) ? value : 0;
+}
+
+static unsigned int newYear(const std::string& str) {
+    unsigned int year;
+    return BethYw::toYear(str, year) ? year : 0;
+}
+
+/*Prints the time per value of converting all the strings with fn.*/
+template<typename Convert>
+static void run(const char* name, const std::vector<std::string>& strings, Convert fn) {
+    double seconds = Bench::bestOf(RUNS, [&]() {
+        double total = 0;
+        for (auto it = strings.begin(); it != strings.end(); it++) {
+            total += fn(*it);
+        }
+        sink = total;
+    });
+
+    std::printf("%-28s %10.2f\n", name, seconds * 1e9 / strings.size());
+}
+
+int main(int argc, char* argv[]) {
+    const size_t count = argc > 1 ? std::atol(argv[1]) : 1000000;
+
+    std::vector<std::string> values;
+    std::vector<std::string> years;
+    values.reserve(count);
+    years.reserve(count);
+
+    unsigned long long state = 42;
+    for (size_t i = 0; i < count; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        const unsigned long long random = state >> 33;
+
+        char buffer[32];
+        if (random % 4 == 0) {
+            std::snprintf(buffer, sizeof(buffer), "%llu", random % 1000000);
+        } else {
+            std::snprintf(buffer, sizeof(buffer), "%.*f", static_cast<int>(random % 4) + 1,
+                          (random % 10000000) / 100.0);
+        }
+        values.emplace_back(buffer);
+        years.push_back(std::to_string(1991 + random % 29));
+    }
+
+    std::printf("%zu values and years, best of %u runs (ns per value)\n\n", count, RUNS);
+
+    run("value: strtod + std::stod", values, oldDouble);
+    run("value: std::stod", values, oldJsonDouble);
+    run("value: BethYw::toDouble", values, newDouble);
+    run("year: strtol", years, oldYear);
+    run("year: BethYw::toYear", years, newYear);
+
+    return 0;
+}
@@ -0,0 +1,101 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Benchmark of answering the --top, --rank and --aggregate queries over a
+  large generated Areas object, 50000 areas with 10 measures of 30 years each
+  by default. It times building the QueryIndex, each query over one measure
+  with it, and the same top-10 query answered without it by looking up the
+  measure in every area through getArea() and getMeasure().
+
+  Build and run from the root of the repository:
+    ./build.sh bench-query
+    ./bin/bench-query [areas] [measures per area] [years]
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../query.h"
+#include "bench.h"
+
+const unsigned int RUNS = 5;
+
+//stops the compiler from optimising away the results we compute
+volatile double sink;
+
+int main(int argc, char* argv[]) {
+    const unsigned long numAreas = argc > 1 ? std::atol(argv[1]) : 50000;
+    const unsigned int numMeasures = argc > 2 ? std::atoi(argv[2]) : 10;
+    const unsigned int numYears = argc > 3 ? std::atoi(argv[3]) : 30;
+
+    Areas areas;
+    std::vector<std::string> codes;
+    unsigned long seed = 12345;
+    for (unsigned long a = 0; a < numAreas; a++) {
+        const std::string code = "W" + std::to_string(10000000 + a);
+        codes.push_back(code);
+        Area area(code);
+        area.setName("eng", "Area " + std::to_string(a));
+        for (unsigned int m = 0; m < numMeasures; m++) {
+            Measure measure("m" + std::to_string(m), "Measure " + std::to_string(m));
+            for (unsigned int y = 0; y < numYears; y++) {
+                seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+                measure.setValue(1991 + y, 1 + ((seed >> 33) % 100000) / 100.0);
+            }
+            area.setMeasure("m" + std::to_string(m), std::move(measure));
+        }
+        areas.setArea(code, std::move(area));
+    }
+
+    std::printf("Queries over %lu areas with %u measures of %u years each, best of %u runs\n\n", numAreas,
+                numMeasures, numYears, RUNS);
+    std::printf("%-36s %12s\n", "", "time (ms)");
+
+    double build = Bench::bestOf(RUNS, [&]() {
+        QueryIndex index(areas);
+        sink = index.numAreas();
+    });
+    std::printf("%-36s %12.2f\n", "build index", build * 1000);
+
+    QueryIndex index(areas);
+
+    double top = Bench::bestOf(RUNS, [&]() {
+        sink = index.top("m3", Query::GROWTH, 10)[0].value;
+    });
+    std::printf("%-36s %12.2f\n", "top 10 by growth, index", top * 1000);
+
+    double naive = Bench::bestOf(RUNS, [&]() {
+        std::vector<std::pair<double, const std::string*>> growths;
+        for (auto it = codes.begin(); it != codes.end(); it++) {
+            growths.emplace_back(areas.getArea(*it).getMeasure("m3").getDifferenceAsPercentage(), &(*it));
+        }
+        std::partial_sort(growths.begin(), growths.begin() + 10, growths.end(),
+                          [](const auto& a, const auto& b) { return a.first > b.first; });
+        sink = growths[0].first;
+    });
+    std::printf("%-36s %12.2f\n", "top 10 by growth, getArea()", naive * 1000);
+
+    double rank = Bench::bestOf(RUNS, [&]() {
+        sink = index.rank("m3", Query::CHANGE, {}).back().percentile;
+    });
+    std::printf("%-36s %12.2f\n", "rank all areas by change", rank * 1000);
+
+    const std::pair<const char*, Query::Aggregation> aggregations[] = {
+        {"aggregate sum", Query::SUM}, {"aggregate mean", Query::MEAN}, {"aggregate p90", Query::PERCENTILE}};
+    for (const auto& aggregation : aggregations) {
+        double seconds = Bench::bestOf(RUNS, [&]() {
+            sink = index.aggregate("m3", aggregation.second, 90).getValue(1991);
+        });
+        std::printf("%-36s %12.2f\n", aggregation.first, seconds * 1000);
+    }
+
+    return 0;
+}
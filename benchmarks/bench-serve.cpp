@@ -0,0 +1,178 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Load test of bethyw --serve. A QueryServer is started in a child process,
+  and a number of client threads each send it the same mix of queries over
+  its socket, one connection per query, as bethyw --connect does. The latency
+  of every query is recorded, and the percentiles and throughput are printed.
+
+  For comparison, the same queries are also answered the way a bethyw process
+  does, by loading the files they need with loadAreas() and loadDatasets().
+  This does not include the time to start the process.
+
+  Build and run from the root of the repository:
+    ./build.sh bench-serve
+    ./bin/bench-serve [datasets directory] [clients] [queries per client]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../lib_cxxopts.hpp"
+#include "../areas.h"
+#include "../bethyw.h"
+#include "../server.h"
+#include "bench.h"
+
+//the mix of queries sent by every client, from small to large
+static const std::vector<std::vector<std::string>> QUERIES = {
+        {"bethyw", "-d", "popden", "-a", "W06000011", "-m", "pop", "-j"},
+        {"bethyw", "-d", "complete-pop", "-a", "W06000024", "-y", "2010-2015"},
+        {"bethyw", "-d", "biz,aqi", "-m", "no2", "-y", "2012", "-j"},
+        {"bethyw", "-d", "all", "-a", "swan", "-j"},
+        {"bethyw", "-d", "all", "-j"},
+};
+
+static double percentile(const std::vector<double>& sorted, double p) {
+    return sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()))];
+}
+
+/*Answers a query like a bethyw process would, by loading the files it needs with the filters it asks for.*/
+static void loadAndAnswer(const std::string& dir, const std::vector<std::string>& query) {
+    std::vector<std::string> copies(query);
+    std::vector<char*> argv;
+    for (auto it = copies.begin(); it != copies.end(); it++) {
+        argv.push_back(&(*it)[0]);
+    }
+    int argc = argv.size();
+    char** argvData = argv.data();
+
+    auto cxxopts = BethYw::cxxoptsSetup();
+    auto args = cxxopts.parse(argc, argvData);
+
+    auto datasets = BethYw::parseDatasetsArg(args);
+    auto areasFilter = BethYw::parseAreasArg(args);
+    auto measuresFilter = BethYw::parseMeasuresArg(args);
+    auto yearsFilter = BethYw::parseYearsArg(args);
+
+    Areas areas;
+    BethYw::loadAreas(areas, dir, areasFilter);
+    BethYw::loadDatasets(areas, dir, datasets, areasFilter, measuresFilter, yearsFilter);
+
+    std::ostringstream out;
+    if (args.count("json")) {
+        areas.writeJSON(out);
+    } else {
+        out << areas;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const std::string dir = argc > 1 ? std::string(argv[1]) + DIR_SEP : std::string("datasets") + DIR_SEP;
+    const unsigned int clients = argc > 2 ? std::atoi(argv[2]) : 4;
+    const unsigned int queriesPerClient = argc > 3 ? std::atoi(argv[3]) : 1000;
+    const std::string socketPath = "/tmp/bethyw-bench-serve-" + std::to_string(getpid()) + ".sock";
+
+    pid_t server = fork();
+    if (server == 0) {
+        QueryServer queryServer(dir);
+        queryServer.listen(socketPath);
+        queryServer.serve(clients);
+        _exit(0);
+    }
+
+    //wait for the server to load the data and start listening
+    std::ostringstream ignored;
+    while (true) {
+        try {
+            BethYw::forwardQuery(socketPath, QUERIES[0], ignored, ignored);
+            break;
+        } catch (const std::exception& ex) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+
+    std::vector<std::vector<double>> latencies(clients);
+    std::vector<std::thread> threads;
+
+    const double seconds = Bench::time([&]() {
+        for (unsigned int c = 0; c < clients; c++) {
+            threads.emplace_back([&, c]() {
+                for (unsigned int q = 0; q < queriesPerClient; q++) {
+                    std::ostringstream out;
+                    std::ostringstream err;
+                    const auto& query = QUERIES[(c + q) % QUERIES.size()];
+
+                    latencies[c].push_back(Bench::time([&]() {
+                        BethYw::forwardQuery(socketPath, query, out, err);
+                    }));
+                }
+            });
+        }
+
+        for (auto it = threads.begin(); it != threads.end(); it++) {
+            it->join();
+        }
+    });
+
+    kill(server, SIGTERM);
+    waitpid(server, nullptr, 0);
+
+    std::vector<double> all;
+    for (auto it = latencies.begin(); it != latencies.end(); it++) {
+        all.insert(all.end(), it->begin(), it->end());
+    }
+    std::sort(all.begin(), all.end());
+
+    std::printf("%u clients sending %u queries each to a server on %s\n\n", clients, queriesPerClient,
+                dir.c_str());
+    std::printf("%-12s %12s\n", "", "latency (us)");
+    std::printf("%-12s %12.1f\n", "p50", percentile(all, 0.50) * 1e6);
+    std::printf("%-12s %12.1f\n", "p90", percentile(all, 0.90) * 1e6);
+    std::printf("%-12s %12.1f\n", "p99", percentile(all, 0.99) * 1e6);
+    std::printf("%-12s %12.1f\n", "max", all.back() * 1e6);
+    std::printf("\nThroughput: %.0f queries/s\n\n", all.size() / seconds);
+
+    std::printf("%-48s %12s %12s\n", "query", "served (us)", "loaded (us)");
+    for (size_t i = 0; i < QUERIES.size(); i++) {
+        std::string text;
+        for (size_t j = 1; j < QUERIES[i].size(); j++) {
+            text += QUERIES[i][j] + " ";
+        }
+
+        //every client sends each query in turn, so query i is any latency at a position congruent to i - c
+        std::vector<double> served;
+        for (unsigned int c = 0; c < clients; c++) {
+            for (size_t q = (i + QUERIES.size() - c % QUERIES.size()) % QUERIES.size(); q < latencies[c].size();
+                 q += QUERIES.size()) {
+                served.push_back(latencies[c][q]);
+            }
+        }
+        std::sort(served.begin(), served.end());
+
+        const double loaded = Bench::bestOf(3, [&]() {
+            loadAndAnswer(dir, QUERIES[i]);
+        });
+
+        std::printf("%-48s %12.1f %12.1f\n", text.c_str(), served.empty() ? 0 : percentile(served, 0.5) * 1e6,
+                    loaded * 1e6);
+    }
+
+    return 0;
+}
@@ -0,0 +1,65 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Benchmark of loading every dataset without a snapshot, with a snapshot that
+  has to be created first (cold) and with an up to date snapshot (warm). Only
+  the loading is timed, not the output.
+
+  Build and run from the root of the repository:
+    ./build.sh bench-snapshot
+    ./bin/bench-snapshot [datasets directory] [snapshot file]
+ */
+
+#include <cstdio>
+#include <string>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+#include "../areas.h"
+#include "../bethyw.h"
+#include "../datasets.h"
+#include "bench.h"
+
+const unsigned int RUNS = 5;
+
+int main(int argc, char* argv[]) {
+    const std::string dir = argc > 1 ? std::string(argv[1]) + DIR_SEP : std::string("datasets") + DIR_SEP;
+    const std::string snapshotPath = argc > 2 ? std::string(argv[2]) : std::string("bench-snapshot.tmp");
+
+    std::vector<BethYw::InputFileSource> datasets;
+    BethYw::addAllDatasets(datasets);
+
+    const std::unordered_set<std::string> noFilter;
+    const std::tuple<unsigned int, unsigned int> allYears(0, 0);
+
+    std::printf("Loading %zu datasets from %s, best of %u runs\n\n", datasets.size(), dir.c_str(), RUNS);
+    std::printf("%-16s %12s\n", "", "time (ms)");
+
+    double seconds = Bench::bestOf(RUNS, [&]() {
+        Areas areas;
+        BethYw::loadAreas(areas, dir, noFilter);
+        BethYw::loadDatasets(areas, dir, datasets, noFilter, noFilter, allYears);
+    });
+    std::printf("%-16s %12.2f\n", "no snapshot", seconds * 1000);
+
+    seconds = Bench::bestOf(RUNS, [&]() {
+        std::remove(snapshotPath.c_str());
+        Areas areas;
+        BethYw::loadDatasetsCached(areas, dir, datasets, noFilter, noFilter, allYears, 1, snapshotPath);
+    });
+    std::printf("%-16s %12.2f\n", "cold snapshot", seconds * 1000);
+
+    seconds = Bench::bestOf(RUNS, [&]() {
+        Areas areas;
+        BethYw::loadDatasetsCached(areas, dir, datasets, noFilter, noFilter, allYears, 1, snapshotPath);
+    });
+    std::printf("%-16s %12.2f\n", "warm snapshot", seconds * 1000);
+
+    std::remove(snapshotPath.c_str());
+    return 0;
+}
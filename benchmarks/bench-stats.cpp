@@ -0,0 +1,85 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Benchmark of computing the statistics --stats adds to the output for every
+  Measure of a large generated Areas object, one million measures by default
+  (40000 areas with 25 measures of 29 years each). It times copying the
+  years and values of every measure into a StatsTable, and computing the
+  statistics from it with each kernel the processor supports.
+
+  Build and run from the root of the repository:
+    ./build.sh bench-stats
+    ./bin/bench-stats [areas] [measures per area] [years]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+
+#include "../areas.h"
+#include "../stats.h"
+#include "bench.h"
+
+const unsigned int RUNS = 5;
+
+//stops the compiler from optimising away the results we compute
+volatile double sink;
+
+int main(int argc, char* argv[]) {
+    const unsigned long numAreas = argc > 1 ? std::atol(argv[1]) : 40000;
+    const unsigned int numMeasures = argc > 2 ? std::atoi(argv[2]) : 25;
+    const unsigned int numYears = argc > 3 ? std::atoi(argv[3]) : 29;
+
+    Areas areas;
+    unsigned long seed = 12345;
+    for (unsigned long a = 0; a < numAreas; a++) {
+        const std::string code = "W" + std::to_string(10000000 + a);
+        Area area(code);
+        for (unsigned int m = 0; m < numMeasures; m++) {
+            Measure measure("m" + std::to_string(m), "Measure " + std::to_string(m));
+            for (unsigned int y = 0; y < numYears; y++) {
+                seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+                measure.setValue(1991 + y, ((seed >> 33) % 100000) / 100.0);
+            }
+            area.setMeasure("m" + std::to_string(m), std::move(measure));
+        }
+        areas.setArea(code, std::move(area));
+    }
+
+    const double numSeries = static_cast<double>(numAreas) * numMeasures;
+    std::printf("Statistics of %.0f measures of %u years each, best of %u runs\n\n", numSeries, numYears, RUNS);
+    std::printf("%-24s %12s %14s %16s\n", "", "time (ms)", "measures/s", "values/s");
+
+    double gather = Bench::bestOf(RUNS, [&]() {
+        StatsTable stats;
+        stats.add(areas);
+        sink = stats.size();
+    });
+    std::printf("%-24s %12.2f %14.0f %16.0f\n", "copy into table", gather * 1000, numSeries / gather,
+                numSeries * numYears / gather);
+
+    StatsTable stats;
+    stats.add(areas);
+
+    const StatsTable::Kernel kernels[] = {StatsTable::SCALAR, StatsTable::AVX2};
+    for (const StatsTable::Kernel kernel : kernels) {
+        if (!StatsTable::supports(kernel)) {
+            continue;
+        }
+
+        double seconds = Bench::bestOf(RUNS, [&]() {
+            stats.compute(kernel);
+        });
+
+        const std::string name = std::string("compute, ") + StatsTable::kernelName(kernel);
+        std::printf("%-24s %12.2f %14.0f %16.0f\n", name.c_str(), seconds * 1000, numSeries / seconds,
+                    numSeries * numYears / seconds);
+    }
+
+    return 0;
+}
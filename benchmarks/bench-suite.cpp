@@ -0,0 +1,218 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Benchmark harness that times every way data goes in and out of Areas, for
+  one or more directories of datasets (usually made by bench-generate at
+  different sizes, see bench.sh):
+
+    - Areas::populate for every file, so each of populateFromAuthorityCodeCSV,
+      populateFromWelshStatsJSON and populateFromAuthorityByYearCSV, with the
+      peak memory of a process loading that file alone
+    - Areas::toJSON, Areas::writeJSON and operator<< on all the files loaded
+      together, written to a stream that only counts the bytes
+
+  The results are printed as JSON with sorted keys and rounded numbers, so the
+  results of two commits can be compared with diff. Times are the best of a
+  number of runs (3 by default, or the BENCH_RUNS environment variable).
+
+  Build and run from the root of the repository:
+    ./build.sh bench-suite
+    ./bin/bench-suite <datasets directory>...
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "../lib_json.hpp"
+#include "../areas.h"
+#include "../bethyw.h"
+#include "../datasets.h"
+#include "../input.h"
+#include "bench.h"
+
+/*Rounds to the given number of decimal places, so small differences in the last digits do not show up in a diff.*/
+static double rounded(double value, int places) {
+    const double scale = std::pow(10.0, places);
+    return std::round(value * scale) / scale;
+}
+
+static std::string parserName(const BethYw::SourceDataType& type) {
+    switch (type) {
+        case BethYw::AuthorityCodeCSV:
+            return "AuthorityCodeCSV";
+        case BethYw::WelshStatsJSON:
+            return "WelshStatsJSON";
+        case BethYw::AuthorityByYearCSV:
+            return "AuthorityByYearCSV";
+        default:
+            return "None";
+    }
+}
+
+/*
+  A stream buffer that throws away everything written to it, only counting the
+  bytes, so the output benchmarks measure formatting and not the disk.
+*/
+class CountingBuffer : public std::streambuf {
+private:
+    std::size_t count = 0;
+
+protected:
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        count += n;
+        return n;
+    }
+
+    int_type overflow(int_type ch) override {
+        count++;
+        return traits_type::not_eof(ch);
+    }
+
+public:
+    std::size_t size() const noexcept {
+        return count;
+    }
+};
+
+static void populate(Areas& areas, const std::string& dir, const BethYw::InputFileSource& source) {
+    MmapInputFile input(dir + source.FILE);
+    areas.populate(input.open(), source.PARSER, source.COLS, nullptr, nullptr, nullptr);
+}
+
+/*Returns the time and memory of loading a single file into an empty Areas.*/
+static json benchPopulate(const std::string& dir, const BethYw::InputFileSource& source, unsigned int runs) {
+    const unsigned long long bytes = std::filesystem::file_size(dir + source.FILE);
+
+    //the memory is measured by a new process, as this one still holds memory from loading the other files
+    const std::string command = "'" + std::filesystem::read_symlink("/proc/self/exe").string() + "' --populate '" +
+                                dir + "' '" + source.FILE + "'";
+    long peakRssKb = -1;
+    std::FILE* child = popen(command.c_str(), "r");
+    if (child == nullptr || std::fscanf(child, "%ld", &peakRssKb) != 1 || pclose(child) != 0) {
+        throw std::runtime_error("Could not measure the memory needed to load " + dir + source.FILE);
+    }
+
+    double seconds = Bench::bestOf(runs, [&]() {
+        Areas areas;
+        populate(areas, dir, source);
+    });
+
+    return {
+            {"parser",    parserName(source.PARSER)},
+            {"bytes",     bytes},
+            {"ms",        rounded(seconds * 1000, 3)},
+            {"mbPerS",    rounded(bytes / seconds / (1024 * 1024), 1)},
+            {"peakRssKb", peakRssKb}
+    };
+}
+
+/*Returns the time of writing all the loaded data in the given way, and the number of bytes written.*/
+static json benchOutput(unsigned int runs, const std::function<void(std::ostream&)>& write) {
+    std::size_t bytes = 0;
+
+    double seconds = Bench::bestOf(runs, [&]() {
+        CountingBuffer buffer;
+        std::ostream out(&buffer);
+        write(out);
+        bytes = buffer.size();
+    });
+
+    return {
+            {"bytes", bytes},
+            {"ms",    rounded(seconds * 1000, 3)}
+    };
+}
+
+static json benchDirectory(const std::string& dir, unsigned int runs) {
+    std::vector<BethYw::InputFileSource> sources = {BethYw::InputFiles::AREAS};
+    BethYw::addAllDatasets(sources);
+
+    json populated = json::object();
+    Areas areas;
+
+    for (const BethYw::InputFileSource& source : sources) {
+        std::cerr << "  " << source.FILE << std::endl;
+        populated[source.FILE] = benchPopulate(dir, source, runs);
+        populate(areas, dir, source);
+    }
+
+    std::cerr << "  output" << std::endl;
+    json output = json::object();
+
+    output["toJSON"] = benchOutput(runs, [&](std::ostream& os) {
+        os << areas.toJSON() << std::endl;
+    });
+
+    output["writeJSON"] = benchOutput(runs, [&](std::ostream& os) {
+        areas.writeJSON(os);
+        os << std::endl;
+    });
+
+    output["operator<<"] = benchOutput(runs, [&](std::ostream& os) {
+        os << areas;
+    });
+
+    return {
+            {"areas",    areas.size()},
+            {"populate", populated},
+            {"output",   output}
+    };
+}
+
+int main(int argc, char* argv[]) {
+    //the process benchPopulate() starts to measure the memory needed to load one file
+    if (argc == 4 && std::string(argv[1]) == "--populate") {
+        std::vector<BethYw::InputFileSource> sources = {BethYw::InputFiles::AREAS};
+        BethYw::addAllDatasets(sources);
+
+        for (const BethYw::InputFileSource& source : sources) {
+            if (source.FILE == argv[3]) {
+                Areas areas;
+                populate(areas, argv[2], source);
+                std::printf("%ld\n", Bench::peakRssKb());
+                return 0;
+            }
+        }
+        return 1;
+    }
+
+    if (argc < 2) {
+        std::cerr << "Usage: bench-suite <datasets directory>..." << std::endl;
+        return 1;
+    }
+
+    const char* runsVar = std::getenv("BENCH_RUNS");
+    const unsigned int runs = runsVar != nullptr && std::atoi(runsVar) > 0 ? std::atoi(runsVar) : 3;
+
+    json results = json::object();
+
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string dir = argv[i];
+            while (dir.size() > 1 && dir.back() == DIR_SEP) {
+                dir.pop_back();
+            }
+
+            std::cerr << dir << std::endl;
+            const std::string name = std::filesystem::path(dir).filename().string();
+            results[name] = benchDirectory(dir + DIR_SEP, runs);
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << json({{"runs", runs}, {"results", results}}).dump(2) << std::endl;
+    return 0;
+}
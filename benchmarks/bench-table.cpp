@@ -0,0 +1,62 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Benchmark of printing every dataset as tables, i.e. the output of bethyw
+  without -j. The datasets are loaded first, and only the printing (to
+  /dev/null) is timed.
+
+  Build and run from the root of the repository:
+    ./build.sh bench-table
+    ./bin/bench-table [datasets directory] [comma-separated dataset codes]
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+#include "../areas.h"
+#include "../bethyw.h"
+#include "../datasets.h"
+#include "bench.h"
+
+const unsigned int RUNS = 5;
+
+int main(int argc, char* argv[]) {
+    const std::string dir = argc > 1 ? std::string(argv[1]) + DIR_SEP : std::string("datasets") + DIR_SEP;
+
+    std::vector<BethYw::InputFileSource> datasets;
+    if (argc > 2) {
+        const std::string codes = std::string(",") + argv[2] + ",";
+        for (unsigned int i = 0; i < BethYw::InputFiles::NUM_DATASETS; i++) {
+            if (codes.find("," + BethYw::InputFiles::DATASETS[i].CODE + ",") != std::string::npos) {
+                datasets.push_back(BethYw::InputFiles::DATASETS[i]);
+            }
+        }
+    } else {
+        BethYw::addAllDatasets(datasets);
+    }
+
+    const std::unordered_set<std::string> noFilter;
+    const std::tuple<unsigned int, unsigned int> allYears(0, 0);
+
+    Areas areas;
+    BethYw::loadAreas(areas, dir, noFilter);
+    BethYw::loadDatasets(areas, dir, datasets, noFilter, noFilter, allYears);
+
+    std::ofstream out("/dev/null");
+    double seconds = Bench::bestOf(RUNS, [&]() {
+        out << areas << std::endl;
+    });
+
+    std::printf("Printing %zu datasets from %s as tables, best of %u runs: %.2f ms\n", datasets.size(), dir.c_str(),
+                RUNS, seconds * 1000);
+
+    return 0;
+}
@@ -0,0 +1,141 @@
+#ifndef BENCH_H_
+#define BENCH_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains small helpers shared by the benchmark programs in this
+  directory. Benchmarks are built with ./build.sh <name>, e.g.
+  ./build.sh bench-json-ingest, and are run from the root of the repository.
+
+  Peak memory is measured by running the code being timed in a child process,
+  as the kernel only keeps a high-water mark of the resident set size for
+  each process. This means these helpers only work on POSIX systems.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace Bench {
+
+    /*
+      The result of running some code once: how long it took, and the peak
+      resident set size of the process that ran it, in kilobytes.
+    */
+    struct Sample {
+        double seconds;
+        long peakRssKb;
+    };
+
+    /*
+      Time a single call of the given function, in seconds.
+    */
+    inline double time(const std::function<void()>& fn) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto end = std::chrono::steady_clock::now();
+
+        return std::chrono::duration<double>(end - start).count();
+    }
+
+    /*
+      Time the given function over a number of runs and return the fastest
+      run, which is the least disturbed by the rest of the system.
+    */
+    inline double bestOf(unsigned int runs, const std::function<void()>& fn) {
+        double best = -1;
+
+        for (unsigned int i = 0; i < runs; i++) {
+            double seconds = Bench::time(fn);
+            if (best < 0 || seconds < best) {
+                best = seconds;
+            }
+        }
+
+        return best;
+    }
+
+    /*
+      Run the given function once in a forked child process, so that the peak
+      memory it needs is not hidden by anything the parent process allocated
+      before. The child reports its wall time back through a pipe, and the
+      parent collects the child's peak resident set size when it exits.
+    */
+    inline Sample isolated(const std::function<void()>& fn) {
+        int fds[2];
+        if (pipe(fds) != 0) {
+            throw std::runtime_error("Bench::isolated: could not create pipe");
+        }
+
+        pid_t pid = fork();
+        if (pid < 0) {
+            throw std::runtime_error("Bench::isolated: could not fork");
+        }
+
+        if (pid == 0) {
+            close(fds[0]);
+            double seconds = Bench::time(fn);
+            ssize_t written = write(fds[1], &seconds, sizeof(seconds));
+            close(fds[1]);
+            _exit(written == sizeof(seconds) ? 0 : 1);
+        }
+
+        close(fds[1]);
+        Sample sample = {-1, -1};
+        if (read(fds[0], &sample.seconds, sizeof(sample.seconds)) != sizeof(sample.seconds)) {
+            sample.seconds = -1;
+        }
+        close(fds[0]);
+
+        int status;
+        struct rusage usage;
+        wait4(pid, &status, 0, &usage);
+
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || sample.seconds < 0) {
+            throw std::runtime_error("Bench::isolated: benchmarked code failed");
+        }
+
+        sample.peakRssKb = usage.ru_maxrss;
+        return sample;
+    }
+
+    /*
+      Return the peak resident set size of this process so far, in
+      kilobytes, from /proc/self/status (so only on Linux), or -1 if it can
+      not be read. Unlike the peak isolated() gets from the kernel, this is
+      not affected by the memory of the parent process, so a program started
+      with popen() can measure itself and print the result.
+    */
+    inline long peakRssKb() {
+        std::FILE* status = std::fopen("/proc/self/status", "r");
+        if (status == nullptr) {
+            return -1;
+        }
+
+        long peak = -1;
+        char line[256];
+        while (std::fgets(line, sizeof(line), status) != nullptr) {
+            if (std::sscanf(line, "VmHWM: %ld", &peak) == 1) {
+                break;
+            }
+        }
+
+        std::fclose(status);
+        return peak;
+    }
+
+} // namespace Bench
+
+#endif // BENCH_H_
@@ -13,10 +13,14 @@
 */
 
 #include <iostream>
+#include <memory_resource>
+#include <new>
 #include <string>
 #include <tuple>
 #include <unordered_set>
 #include <vector>
+#include <utility>
+#include <cstdint>
 #include <cstdlib>
 
 #include "lib_cxxopts.hpp"
@@ -25,6 +29,14 @@
 #include "datasets.h"
 #include "bethyw.h"
 #include "input.h"
+#include "parallel.h"
+#include "snapshot.h"
+#include "profile.h"
+#include "server.h"
+#include "registry.h"
+#include "rowindex.h"
+#include "stats.h"
+#include "query.h"
 
 /*
   Run Beth Yw?, parsing the command line arguments, importing the data,
@@ -43,6 +55,13 @@
     Exit code
 */
 int BethYw::run(int argc, char* argv[]) {
+    /*We only know if we are profiling once the arguments have been parsed, so the time the arguments phase started
+     * is taken here.*/
+    const auto argumentsStart = BethYw::Profile::Clock::now();
+
+    //cxxopts reorders argv while parsing it, and --connect forwards the arguments as they were given
+    const std::vector<std::string> arguments(argv, argv + argc);
+
     try {
         auto cxxopts = BethYw::cxxoptsSetup();
         auto args = cxxopts.parse(argc, argv);
@@ -53,6 +72,12 @@ int BethYw::run(int argc, char* argv[]) {
             return 0;
         }
 
+        auto profileFormat = BethYw::parseProfileArg(args);
+        if (!profileFormat.empty()) {
+            BethYw::Profile::enable();
+        }
+        BethYw::Profile::Scope argumentsPhase("arguments", argumentsStart);
+
         std::string dir;
         // Parse data directory argument
         try {
@@ -63,28 +88,92 @@ int BethYw::run(int argc, char* argv[]) {
             dir = std::string("datasets") + DIR_SEP;
         }
 
+        // Let a server that already has the data loaded answer the query
+        if (args.count("connect")) {
+            return BethYw::forwardQuery(BethYw::parseSocketArg(args, "connect", dir), arguments, std::cout,
+                                        std::cerr);
+        }
+
         // Parse other arguments and import data
         auto datasetsToImport = BethYw::parseDatasetsArg(args);
         auto areasFilter = BethYw::parseAreasArg(args);
         auto measuresFilter = BethYw::parseMeasuresArg(args);
         auto yearsFilter = BethYw::parseYearsArg(args);
+        auto threads = BethYw::parseThreadsArg(args);
+        auto query = BethYw::parseQueryArgs(args);
 
-        Areas data = Areas();
+        /*--rank ranks the areas asked for among all areas, so all of them are imported. The queries still only answer
+         * for the areas asked for, as they filter the areas themselves (see Query::areas).*/
+        if (query.rank) {
+            areasFilter.clear();
+        }
+
+        const bool lazy = args.count("lazy") > 0;
+        const bool useIndex = args.count("index") > 0;
+
+        argumentsPhase.stop();
+
+        if (args.count("serve")) {
+            auto socketPath = BethYw::parseSocketArg(args, "serve", dir);
+
+            QueryServer server(dir, threads, lazy);
+            server.listen(socketPath);
+            std::cerr << "Listening on " << socketPath << std::endl;
+            server.serve(threads);
+            return 0;
+        }
 
-        BethYw::loadAreas(data, dir, areasFilter);
-        BethYw::loadDatasets(data,
-                             dir,
-                             datasetsToImport,
-                             areasFilter,
-                             measuresFilter,
-                             yearsFilter);
+        //with --lazy, the datasets that can not contribute to the output are not loaded at all
+        BethYw::Profile::Scope registryPhase(lazy ? BethYw::Profile::addPhase("registry") : nullptr);
+        const std::vector<BethYw::InputFileSource> datasetsNeeded =
+                lazy ? DatasetRegistry(dir).contributing(datasetsToImport, measuresFilter) : datasetsToImport;
+        registryPhase.stop();
+
+        /*Everything that is loaded is allocated from an arena, and data itself is never destroyed: when run() returns,
+         * the arena frees its few blocks at once instead of every Area and Measure being destroyed one by one. This
+         * leaves nothing behind, as the codes and names of the areas are allocated from the arena too (see area.h).
+         * The arena has to be thread safe, as the threads loading the datasets allocate from it too (see
+         * Areas::merge).*/
+        std::pmr::synchronized_pool_resource arena;
+        Areas& data = *new (arena.allocate(sizeof(Areas), alignof(Areas))) Areas(&arena);
+
+        if (args.count("cache")) {
+            auto snapshotPath = args["cache"].as<std::string>();
+            if (snapshotPath.empty()) {
+                snapshotPath = dir + ".bethyw-snapshot";
+            }
 
-        if (args.count("json")) {
-            // The output as JSON
-            std::cout << data.toJSON() << std::endl;
+            BethYw::Profile::Scope datasetsPhase("datasets (cached)");
+            BethYw::loadDatasetsCached(data,
+                                       dir,
+                                       datasetsNeeded,
+                                       areasFilter,
+                                       measuresFilter,
+                                       yearsFilter,
+                                       threads,
+                                       snapshotPath);
         } else {
-            // The output as tables
-            std::cout << data << std::endl;
+            BethYw::Profile::Scope areasPhase("areas");
+            BethYw::loadAreas(data, dir, areasFilter);
+            areasPhase.stop();
+
+            BethYw::Profile::Scope datasetsPhase("datasets");
+            BethYw::loadDatasets(data,
+                                 dir,
+                                 datasetsNeeded,
+                                 areasFilter,
+                                 measuresFilter,
+                                 yearsFilter,
+                                 threads,
+                                 useIndex);
+        }
+
+        BethYw::Profile::Scope outputPhase("output");
+        BethYw::writeOutput(std::cout, data, args);
+        outputPhase.stop();
+
+        if (BethYw::Profile::isEnabled()) {
+            BethYw::Profile::report(std::cerr, profileFormat == "json");
         }
 
         return 0;
@@ -140,6 +229,75 @@ cxxopts::Options BethYw::cxxoptsSetup() {
             "j,json",
             "Print the output as JSON instead of tables.")(
 
+            "top",
+            "Instead of the data, list the given number of areas with the highest "
+            "value of each measure (see --by)",
+            cxxopts::value<std::string>())(
+
+            "rank",
+            "Instead of the data, give the rank and percentile of each of the areas "
+            "(see --areas) among all areas for each measure (see --by)")(
+
+            "aggregate",
+            "Instead of the data, combine the values of each measure for each year "
+            "across the areas with 'sum', 'mean', 'median' or a percentile 'pNN', "
+            "e.g. p90",
+            cxxopts::value<std::string>())(
+
+            "by",
+            "What --top and --rank rank areas by: the 'value' of the last year "
+            "(the default), or its 'change' or percentage change ('growth') from "
+            "the first year (see --years)",
+            cxxopts::value<std::string>()->default_value("value"))(
+
+            "stats",
+            "Add the minimum, maximum, variance, standard deviation, compound "
+            "annual growth rate and trend line slope of every measure to the "
+            "output, as more columns of the tables or as the \"stats\" of each "
+            "area in JSON")(
+
+            "threads",
+            "Number of threads to load datasets with "
+            "(omit or set to 0 to use one thread per core)",
+            cxxopts::value<std::string>()->default_value("0"))(
+
+            "cache",
+            "Keep the parsed datasets in a snapshot file and reuse them while the "
+            "dataset files are unchanged (defaults to .bethyw-snapshot in the data "
+            "directory, use --cache=<file> to choose another file)",
+            cxxopts::value<std::string>()->implicit_value(""))(
+
+            "lazy",
+            "Only load the datasets that can contribute to the output, e.g. -m pop "
+            "does not load the air quality dataset, so errors in the other datasets "
+            "are not reported. With --serve, load each file on the first query that "
+            "needs it instead of at startup.")(
+
+            "index",
+            "Keep an index of where the rows of each area and measure are next to "
+            "each JSON dataset (as .<file>.bethyw-index), and only parse the rows "
+            "that match the areas and measures filters. The index is built on the "
+            "first run that needs it, and again whenever the dataset changes.")(
+
+            "profile",
+            "Report the time spent in each phase of the program, and the rows, "
+            "bytes and allocations counted in it, to the standard error, as a "
+            "table or with --profile=json as JSON",
+            cxxopts::value<std::string>()->implicit_value("text"))(
+
+            "serve",
+            "Load every dataset in the data directory once and answer the queries "
+            "of bethyw --connect on a Unix domain socket until interrupted (defaults "
+            "to .bethyw-socket in the data directory, use --serve=<socket> to "
+            "choose another socket)",
+            cxxopts::value<std::string>()->implicit_value(""))(
+
+            "connect",
+            "Send the other arguments to a server started with --serve instead of "
+            "importing the data (defaults to .bethyw-socket in the data directory, "
+            "use --connect=<socket> to choose another socket)",
+            cxxopts::value<std::string>()->implicit_value(""))(
+
             "h,help",
             "Print usage.");
 
@@ -407,6 +565,115 @@ std::tuple<unsigned int, unsigned int> BethYw::parseYearsArg(cxxopts::ParseResul
     }
 }
 
+/*
+  Parse the threads command line argument, which is optional. It must be a
+  non-negative integer, where 0 (the default) means that one thread per core
+  should be used to load the datasets.
+
+  @param args
+    Parsed program arguments
+
+  @return
+    The number of threads to load datasets with, or 0 for one per core
+
+  @throws
+    std::invalid_argument if the argument is not a non-negative integer, with
+    the message: Invalid input for threads argument
+*/
+unsigned int BethYw::parseThreadsArg(cxxopts::ParseResult& args) {
+    try {
+        auto inputThreads = args["threads"].as<std::string>();
+
+        if (inputThreads.empty() || !isInt(inputThreads) || inputThreads[0] == '-') {
+            throw std::invalid_argument("Invalid input for threads argument");
+        }
+
+        return std::stoul(inputThreads);
+    } catch (const cxxopts::OptionParseException& ex) {
+        return 0;
+    } catch (const std::domain_error& ex) {
+        return 0;
+    } catch (const std::out_of_range& ex) {
+        throw std::invalid_argument("Invalid input for threads argument");
+    }
+}
+
+/*
+  Parse the top, rank, aggregate and by command line arguments, which are
+  all optional, into the queries to answer instead of outputting the data.
+  top must be a positive integer, aggregate one of sum, mean, median or pNN
+  for a percentile NN from 0 to 100, and by one of value, change or growth
+  (all case-insensitive). The areas the queries are about are those of the
+  areas argument, which also match areas by their names.
+
+  @param args
+    Parsed program arguments
+
+  @return
+    The queries asked for; Query::any() is false if there are none
+
+  @throws
+    std::invalid_argument if an argument is invalid, with the message:
+    Invalid input for <argument> argument
+*/
+Query BethYw::parseQueryArgs(cxxopts::ParseResult& args) {
+    Query query;
+
+    if (args.count("top")) {
+        auto inputTop = args["top"].as<std::string>();
+
+        if (inputTop.empty() || !isInt(inputTop) || inputTop[0] == '-') {
+            throw std::invalid_argument("Invalid input for top argument");
+        }
+
+        query.top = std::strtoul(inputTop.c_str(), nullptr, 10);
+        if (query.top == 0) {
+            throw std::invalid_argument("Invalid input for top argument");
+        }
+    }
+
+    if (args.count("rank")) {
+        query.rank = true;
+    }
+
+    query.areas = parseAreasArg(args);
+
+    if (args.count("aggregate")) {
+        auto aggregation = toLower(args["aggregate"].as<std::string>());
+
+        if (aggregation == "sum") {
+            query.aggregation = Query::SUM;
+        } else if (aggregation == "mean") {
+            query.aggregation = Query::MEAN;
+        } else if (aggregation == "median") {
+            query.aggregation = Query::PERCENTILE;
+            query.percentile = 50;
+        } else if (aggregation.size() > 1 && aggregation[0] == 'p' && isDouble(aggregation.substr(1))) {
+            query.aggregation = Query::PERCENTILE;
+            query.percentile = std::strtod(aggregation.c_str() + 1, nullptr);
+
+            if (!(query.percentile >= 0 && query.percentile <= 100)) {
+                throw std::invalid_argument("Invalid input for aggregate argument");
+            }
+        } else {
+            throw std::invalid_argument("Invalid input for aggregate argument");
+        }
+    }
+
+    auto metric = toLower(args["by"].as<std::string>());
+    if (metric == "value") {
+        query.metric = Query::VALUE;
+    } else if (metric == "change") {
+        query.metric = Query::CHANGE;
+    } else if (metric == "growth") {
+        query.metric = Query::GROWTH;
+    } else {
+        throw std::invalid_argument("Invalid input for by argument");
+    }
+
+    return query;
+}
+
 /*Checks if the contents of the string represent an integer.*/
 bool BethYw::isInt(const std::string& str) {
     /*strtol will put a value in end which is the first character after the
@@ -465,7 +732,7 @@ bool BethYw::isDouble(const std::string& str) {
 */
 void BethYw::loadAreas(Areas& areas, const std::string& filePath, const StringFilterSet& filters) {
     try {
-        InputFile file(filePath + std::string("areas.csv"));
+        MmapInputFile file(filePath + std::string("areas.csv"));
         areas.populate(file.open(), BethYw::AuthorityCodeCSV, BethYw::InputFiles::AREAS.COLS, &filters);
     } catch (const std::runtime_error& ex) {
         std::cerr << "Error importing dataset:" << std::endl << ex.what();
@@ -473,6 +740,50 @@ void BethYw::loadAreas(Areas& areas, const std::string& filePath, const StringFi
     }
 }
 
+/*Imports a single dataset file into areas with the filters, through the index of the file if useIndex is set and it can
+ * narrow down the rows to parse. A file that can not be indexed is parsed in full instead, which reports its errors the
+ * same way as without an index. JSON and Authority By Year CSV files parsed in full are split over the given number of
+ * threads.*/
+static void populateDataset(Areas& areas, const std::string& dir, const BethYw::InputFileSource& dataset,
+                            const std::unordered_set<std::string>& areasFilter,
+                            const std::unordered_set<std::string>& measuresFilter,
+                            const std::tuple<unsigned int, unsigned int>& yearsFilter,
+                            bool useIndex, unsigned int threads) {
+    MmapInputFile file(dir + dataset.FILE);
+    std::istream& is = file.open();
+
+    if (useIndex && RowIndex::canNarrow(dataset, areasFilter, measuresFilter)) {
+        std::string rows;
+        try {
+            rows = RowIndex::forDataset(dir, dataset, file.bytes())
+                    .selectedRows(file.bytes(), &areasFilter, &measuresFilter);
+        } catch (const std::runtime_error& ex) {
+            rows.clear();
+        }
+
+        if (!rows.empty()) {
+            MemoryStreamBuffer buffer;
+            buffer.reset(rows.data(), rows.size());
+            std::istream rowsStream(&buffer);
+
+            areas.populate(rowsStream, dataset.PARSER, dataset.COLS, &areasFilter, &measuresFilter, &yearsFilter);
+            return;
+        }
+    }
+
+    if (dataset.PARSER == BethYw::WelshStatsJSON && threads > 1) {
+        areas.populateFromWelshStatsJSON(file.bytes(), dataset.COLS, &areasFilter, &measuresFilter, &yearsFilter,
+                                         threads);
+        return;
+    } else if (dataset.PARSER == BethYw::AuthorityByYearCSV && threads > 1) {
+        areas.populateFromAuthorityByYearCSV(file.bytes(), dataset.COLS, &areasFilter, &measuresFilter,
+                                             &yearsFilter, threads);
+        return;
+    }
+
+    areas.populate(is, dataset.PARSER, dataset.COLS, &areasFilter, &measuresFilter, &yearsFilter);
+}
+
 /*
   Import datasets from `datasetsToImport` as files in `dir` into areas, and
   filtering them with the `areasFilter`, `measuresFilter`, and `yearsFilter`.
@@ -506,22 +817,284 @@ void BethYw::loadAreas(Areas& areas, const std::string& filePath, const StringFi
     An two-pair tuple of unsigned ints corresponding to the range of years 
     to import, which should both be 0 to import all years.
 
+  @param threads
+    The number of threads to parse the datasets on, or 0 to use one thread per
+    core. With more than one thread, each dataset is parsed into its own Areas
+    object, and these are merged into `areas` in the order of datasetsToImport,
+    which gives exactly the same result as parsing them one after another. The
+    threads left over when there are fewer datasets than threads are shared
+    out between the datasets, so that a large JSON or Authority By Year CSV
+    file is split over several threads too.
+
+  @param useIndex
+    If true, JSON datasets are imported through their RowIndex when the areas
+    or measures filter can leave out some of their rows, which only parses
+    the rows that match them
+
   @return
     void
 */
 void BethYw::loadDatasets(Areas& areas, const std::string& dir, const std::vector<BethYw::InputFileSource>& datasetsToImport,
                   const std::unordered_set<std::string>& areasFilter,
                   const std::unordered_set<std::string>& measuresFilter,
-                  const std::tuple<unsigned int, unsigned int>& yearsFilter) noexcept {
+                  const std::tuple<unsigned int, unsigned int>& yearsFilter,
+                  unsigned int threads,
+                  bool useIndex) noexcept {
+
+    const size_t numDatasets = datasetsToImport.size();
+    const unsigned int workers = BethYw::threadsFor(numDatasets, threads);
+    const unsigned int threadsPerDataset = BethYw::threadsFor(SIZE_MAX, threads) / workers;
+
+    try {
+        //the phases are added here, in order, even though the datasets may be loaded on other threads
+        std::vector<BethYw::Profile::Phase*> phases;
+        for (auto it = datasetsToImport.begin(); it != datasetsToImport.end(); it++) {
+            phases.push_back(BethYw::Profile::addPhase(it->CODE));
+        }
+
+        if (workers <= 1) {
+            for (size_t i = 0; i < numDatasets; i++) {
+                const InputFileSource& dataset = datasetsToImport[i];
+                BethYw::Profile::Scope phase(phases[i]);
+
+                populateDataset(areas, dir, dataset, areasFilter, measuresFilter, yearsFilter, useIndex,
+                                threadsPerDataset);
+            }
+        } else {
+            /*Every dataset gets its own Areas object, so the threads never touch the same data. If a dataset fails
+             * to load, parallelFor rethrows the error of the first failing dataset in the list, which is the one
+             * we would have stopped at when loading them in order.*/
+            std::vector<Areas> shards = areas.makeShards(numDatasets);
+
+            BethYw::parallelFor(numDatasets, workers, [&](size_t i) {
+                const InputFileSource& dataset = datasetsToImport[i];
+                BethYw::Profile::Scope phase(phases[i]);
+
+                populateDataset(shards[i], dir, dataset, areasFilter, measuresFilter, yearsFilter, useIndex,
+                                threadsPerDataset);
+            });
+
+            for (auto it = shards.begin(); it != shards.end(); it++) {
+                areas.merge(std::move(*it));
+            }
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << "Error importing dataset:" << std::endl << ex.what();
+        exit(1);
+    }
+}
+
+/*
+  Import areas.csv and the datasets from `datasetsToImport` as files in `dir`
+  into areas like loadAreas() and loadDatasets() do, but through a snapshot
+  file holding the parsed contents of every file from earlier runs.
+
+  A file whose fingerprint (size, modification time and hash) matches the one
+  in the snapshot is decoded from the snapshot instead of being parsed. Other
+  files are parsed and added to the snapshot, which is saved at the end if
+  anything changed. As the same file may be imported with different filters on
+  different runs, the snapshot holds every file parsed without any filters,
+  and the filters are applied while merging the files into `areas`, which gives
+  the same result as parsing them with the filters.
+
+  Like loadDatasets(), this function does not throw. If a dataset can not be
+  imported, 'Error importing dataset:' is output, followed by a new line and the
+  output of the what() function on the exception. Failing to save the snapshot
+  is not an error, as the data was still imported.
+
+  @param areas
+    An Areas instance that should be modified (i.e. datasets loaded into it)
+
+  @param dir
+    The directory where areas.csv and the datasets are
+
+  @param datasetsToImport
+    A vector of InputFileSource objects
+
+  @param areasFilter
+    An unordered set of areas to filter, or empty to import all areas
+
+  @param measuresFilter
+    An unordered set of measures to filter, or empty to import all measures
+
+  @param yearsFilter
+    An two-pair tuple of unsigned ints corresponding to the range of years
+    to import, which should both be 0 to import all years.
+
+  @param threads
+    The number of threads to import the files on, or 0 to use one thread per
+    core
 
+  @param snapshotPath
+    The path of the snapshot file, which does not have to exist yet
+
+  @return
+    void
+*/
+void BethYw::loadDatasetsCached(Areas& areas, const std::string& dir,
+                                const std::vector<BethYw::InputFileSource>& datasetsToImport,
+                                const std::unordered_set<std::string>& areasFilter,
+                                const std::unordered_set<std::string>& measuresFilter,
+                                const std::tuple<unsigned int, unsigned int>& yearsFilter,
+                                unsigned int threads,
+                                const std::string& snapshotPath) noexcept {
+
+    //areas.csv is imported first, like loadAreas() does before loadDatasets()
+    std::vector<const BethYw::InputFileSource*> sources;
+    sources.push_back(&BethYw::InputFiles::AREAS);
     for (auto it = datasetsToImport.begin(); it != datasetsToImport.end(); it++) {
-        try {
-            InputFile file(dir + it->FILE);
-            areas.populate(file.open(), it->PARSER, it->COLS, &areasFilter, &measuresFilter, &yearsFilter);
-        } catch (const std::exception& ex) {
-            std::cerr << "Error importing dataset:" << std::endl << ex.what();
-            exit(1);
+        sources.push_back(&*it);
+    }
+
+    const size_t numSources = sources.size();
+
+    try {
+        Snapshot snapshot(snapshotPath);
+
+        std::vector<Areas> shards(numSources);
+        std::vector<FileFingerprint> fingerprints(numSources);
+        //char rather than bool, as the threads write to different elements at the same time
+        std::vector<char> parsed(numSources, false);
+
+        std::vector<BethYw::Profile::Phase*> phases;
+        for (auto it = sources.begin(); it != sources.end(); it++) {
+            phases.push_back(BethYw::Profile::addPhase((*it)->CODE));
+        }
+
+        BethYw::parallelFor(numSources, BethYw::threadsFor(numSources, threads), [&](size_t i) {
+            const InputFileSource& source = *sources[i];
+            BethYw::Profile::Scope phase(phases[i]);
+
+            MmapInputFile file(dir + source.FILE);
+            std::istream& is = file.open();
+
+            fingerprints[i] = FileFingerprint::of(file.getSource(), file.bytes());
+            if (!snapshot.load(source.FILE, fingerprints[i], source.PARSER, shards[i])) {
+                shards[i].populate(is, source.PARSER, source.COLS, nullptr, nullptr, nullptr);
+                parsed[i] = true;
+            }
+        });
+
+        for (size_t i = 0; i < numSources; i++) {
+            areas.mergeFiltered(shards[i], sources[i]->PARSER, &areasFilter, &measuresFilter, &yearsFilter);
+
+            if (parsed[i]) {
+                snapshot.store(sources[i]->FILE, fingerprints[i], sources[i]->PARSER, shards[i]);
+            }
+        }
+
+        if (snapshot.hasChanged()) {
+            try {
+                snapshot.save();
+            } catch (const std::exception& ex) {
+                std::cerr << "Warning: " << ex.what() << std::endl;
+            }
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << "Error importing dataset:" << std::endl << ex.what();
+        exit(1);
+    }
+}
+
+/*
+  Parse the profile command line argument, which is optional. Given without a
+  value it means "text", otherwise it must be "text" or "json"
+  (case-insensitive).
+
+  @param args
+    Parsed program arguments
+
+  @return
+    "text" or "json" for the format of the profile report, or an empty string
+    if the program should not be profiled
+
+  @throws
+    std::invalid_argument if the argument is another value, with the message:
+    Invalid input for profile argument
+*/
+std::string BethYw::parseProfileArg(cxxopts::ParseResult& args) {
+    try {
+        auto format = BethYw::toLower(args["profile"].as<std::string>());
+
+        if (format != "text" && format != "json") {
+            throw std::invalid_argument("Invalid input for profile argument");
         }
+
+        return format;
+    } catch (const cxxopts::OptionParseException& ex) {
+        return "";
+    } catch (const std::domain_error& ex) {
+        return "";
+    }
+}
+
+/*
+  Parse the serve or connect command line argument, which gives the path of
+  the socket a server listens on. Given without a value, the socket is
+  .bethyw-socket in the data directory.
+
+  @param args
+    Parsed program arguments
+
+  @param option
+    The name of the argument, "serve" or "connect"
+
+  @param dir
+    The data directory, ending with a directory separator
+
+  @return
+    The path of the socket
+*/
+std::string BethYw::parseSocketArg(cxxopts::ParseResult& args, const std::string& option, const std::string& dir) {
+    auto socketPath = args[option].as<std::string>();
+
+    if (socketPath.empty()) {
+        socketPath = dir + ".bethyw-socket";
+    }
+
+    return socketPath;
+}
+
+/*
+  Write the imported data to the output, as tables or with the json argument
+  as JSON. With the stats argument, the statistics of every measure are
+  computed first, for all areas at once (see stats.h), and added to it. With
+  the top, rank or aggregate arguments, the answers to those queries are
+  written instead (see query.h).
+
+  @param out
+    The stream to write the output to
+
+  @param data
+    The imported data
+
+  @param args
+    Parsed program arguments
+*/
+void BethYw::writeOutput(std::ostream& out, const Areas& data, cxxopts::ParseResult& args) {
+    const Query query = parseQueryArgs(args);
+    if (query.any()) {
+        QueryIndex index(data);
+        index.write(out, query, args.count("json") > 0);
+        out << std::endl;
+        return;
+    }
+
+    StatsTable stats;
+    const bool withStats = args.count("stats") > 0;
+    if (withStats) {
+        stats.add(data);
+        stats.compute();
+    }
+
+    if (args.count("json")) {
+        // The output as JSON
+        data.writeJSON(out, withStats ? &stats : nullptr);
+        out << std::endl;
+    } else {
+        // The output as tables
+        data.writeTables(out, withStats ? &stats : nullptr);
+        out << std::endl;
     }
 }
 
@@ -20,6 +20,7 @@
 
 #include "datasets.h"
 #include "areas.h"
+#include "query.h"
 
 const char DIR_SEP =
 #ifdef _WIN32
@@ -72,6 +73,36 @@ namespace BethYw {
     */
     std::tuple<unsigned int, unsigned int> parseYearsArg(cxxopts::ParseResult& args);
 
+    /*
+      Parse the threads argument and return the number of threads to load
+      datasets with, or 0 to use one thread per core.
+    */
+    unsigned int parseThreadsArg(cxxopts::ParseResult& args);
+
+    /*
+      Parse the top, rank, aggregate and by arguments and return the queries
+      to answer instead of outputting the imported data.
+    */
+    Query parseQueryArgs(cxxopts::ParseResult& args);
+
+    /*
+      Parse the profile argument and return the format of the profile report
+      ("text" or "json"), or an empty string if the program is not profiled.
+    */
+    std::string parseProfileArg(cxxopts::ParseResult& args);
+
+    /*
+      Parse the serve or connect argument and return the path of the socket
+      of the server.
+    */
+    std::string parseSocketArg(cxxopts::ParseResult& args, const std::string& option, const std::string& dir);
+
+    /*
+      Write the imported data to the output as tables or JSON, with the
+      statistics of every measure if asked for.
+    */
+    void writeOutput(std::ostream& out, const Areas& data, cxxopts::ParseResult& args);
+
     /*other helper functions I made to help with parsing years, they are also used in areas.cpp in
      * populateFromAuthorityByYearCSV*/
     bool is4DigitInt(const int num);
@@ -87,7 +118,16 @@ namespace BethYw {
                       const std::vector<BethYw::InputFileSource>& datasetsFilter,
                       const std::unordered_set<std::string>& areasFilter,
                       const std::unordered_set<std::string>& measuresFilter,
-                      const std::tuple<unsigned int, unsigned int>& yearsFilter) noexcept;
+                      const std::tuple<unsigned int, unsigned int>& yearsFilter,
+                      unsigned int threads = 1,
+                      bool useIndex = false) noexcept;
+    void loadDatasetsCached(Areas& areas, const std::string& dir,
+                            const std::vector<BethYw::InputFileSource>& datasetsToImport,
+                            const std::unordered_set<std::string>& areasFilter,
+                            const std::unordered_set<std::string>& measuresFilter,
+                            const std::tuple<unsigned int, unsigned int>& yearsFilter,
+                            unsigned int threads,
+                            const std::string& snapshotPath) noexcept;
 } // namespace BethYw
 
 #endif // BETHYW_H_
\ No newline at end of file
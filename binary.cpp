@@ -0,0 +1,52 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains the implementation of the helpers for binary files that
+  are not small enough to live in binary.h.
+*/
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include "binary.h"
+
+/*
+  Write a file, replacing the file at the same path if there is one. The
+  contents are written to a temporary file first, which is then renamed, so
+  that another process never sees a half written file.
+
+  @param path
+    The path of the file
+
+  @param contents
+    The whole contents of the file
+
+  @throws
+    std::runtime_error if the file can not be written
+*/
+void BethYw::replaceFile(const std::string& path, const std::string& contents) {
+    const std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream stream(temporaryPath, std::ios::binary | std::ios::trunc);
+        stream.write(contents.data(), contents.size());
+
+        if (!stream.good()) {
+            throw std::runtime_error(std::string("Failed to write file ") + temporaryPath);
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error) {
+        std::remove(temporaryPath.c_str());
+        throw std::runtime_error(std::string("Failed to write file ") + path);
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef BINARY_H_
+#define BINARY_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains the helpers shared by the binary files the program keeps
+  next to the datasets (snapshots and indexes): the BinaryReader class, the
+  functions that append numbers and strings to a buffer, and replaceFile().
+
+  All numbers are stored in the byte order of the machine, and every string is
+  stored as a uint32 length followed by its bytes.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+/*
+  Reads numbers and strings from a block of memory, checking that they do not
+  go past its end, so that a damaged file is rejected instead of misread.
+*/
+class BinaryReader {
+private:
+    const char* position;
+    const char* end;
+
+public:
+    BinaryReader(std::string_view bytes) : position(bytes.data()), end(bytes.data() + bytes.size()) {
+
+    }
+
+    std::string_view readBytes(uint64_t length) {
+        if (static_cast<uint64_t>(end - position) < length) {
+            throw std::runtime_error("File is truncated");
+        }
+
+        std::string_view bytes(position, length);
+        position += length;
+        return bytes;
+    }
+
+    //memcpy is used as the numbers in the file are not necessarily aligned
+    template<typename T>
+    T read() {
+        T value;
+        std::memcpy(&value, readBytes(sizeof(T)).data(), sizeof(T));
+        return value;
+    }
+
+    std::string_view readString() {
+        return readBytes(read<uint32_t>());
+    }
+
+    bool atEnd() const noexcept {
+        return position == end;
+    }
+};
+
+template<typename T>
+inline void writeBinary(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+inline void writeBinaryString(std::string& out, std::string_view str) {
+    writeBinary<uint32_t>(out, str.size());
+    out.append(str);
+}
+
+namespace BethYw {
+
+    void replaceFile(const std::string& path, const std::string& contents);
+
+} // namespace BethYw
+
+#endif // BINARY_H_
@@ -2,7 +2,7 @@
 
 SET bin_dir=bin
 SET tests_dir=tests
-SET source_files=bethyw.cpp input.cpp areas.cpp area.cpp measure.cpp
+SET source_files=bethyw.cpp input.cpp areas.cpp area.cpp measure.cpp jsonstream.cpp csv.cpp parallel.cpp snapshot.cpp yearseries.cpp filter.cpp jsonwriter.cpp profile.cpp server.cpp intern.cpp numbers.cpp registry.cpp binary.cpp rowindex.cpp stats.cpp query.cpp
 SET main_file=main.cpp
 SET executable=%bin_dir%\bethyw.exe
 
@@ -25,6 +25,6 @@ IF %testStr%==test (
 :compile
 IF NOT EXIST %bin_dir% MKDIR %bin_dir%
 IF EXIST %executable% DEL %executable%
-g++ --std=c++14 -Wall %source_files% %main_file% -o %executable%
+g++ --std=c++17 -Wall -pthread %source_files% %main_file% -o %executable%
 
 :end
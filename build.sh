@@ -2,15 +2,17 @@
 
 BIN_DIR="bin"
 TESTS_DIR="tests"
-SOURCE_FILES="bethyw.cpp input.cpp areas.cpp area.cpp measure.cpp"
+BENCH_DIR="benchmarks"
+SOURCE_FILES="bethyw.cpp input.cpp areas.cpp area.cpp measure.cpp jsonstream.cpp csv.cpp parallel.cpp snapshot.cpp yearseries.cpp filter.cpp jsonwriter.cpp profile.cpp server.cpp intern.cpp numbers.cpp registry.cpp binary.cpp rowindex.cpp stats.cpp query.cpp"
 MAIN_FILE="main.cpp"
 EXECUTABLE="./${BIN_DIR}/bethyw"
+CXXFLAGS=""
 
 set -x
 cd "${0%/*}"
 
 if [ $# -gt 1 ]; then
-  echo "Unknown arguments!" "Only one argument accepted, and must begin with test"
+  echo "Unknown arguments!" "Only one argument accepted, and must begin with test or bench"
   exit
 elif [ $# -eq 1 ]; then
   if [[ $1 == test* ]]; then
@@ -22,9 +24,15 @@ elif [ $# -eq 1 ]; then
     if [ ! -f ./${BIN_DIR}/catch.o ]; then
       g++ --std=c++11 -c ./lib_catch_main.cpp -o ./${BIN_DIR}/catch.o
     fi
+  elif [[ $1 == bench* ]]; then
+    # Benchmarks have their own main() and are always built with optimisations
+    SOURCE_FILES="${SOURCE_FILES} ./${BENCH_DIR}/$1.cpp"
+    MAIN_FILE=""
+    EXECUTABLE="./${BIN_DIR}/$1"
+    CXXFLAGS="-O2"
   fi
 fi
 
 mkdir -p ${BIN_DIR}
 rm ${EXECUTABLE} 2> /dev/null
-g++ --std=c++14 -pedantic -Wall ${SOURCE_FILES} ${MAIN_FILE} -o ${EXECUTABLE}
\ No newline at end of file
+g++ --std=c++17 -pedantic -Wall -pthread ${CXXFLAGS} ${SOURCE_FILES} ${MAIN_FILE} -o ${EXECUTABLE}
\ No newline at end of file
@@ -0,0 +1,401 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains the implementation of the CsvTokenizer class. Rows and
+  fields are views into the text given to the constructor; the only memory
+  allocated is for the positions of the delimiters of one window of text.
+  Converting fields to numbers is done by the functions in numbers.h.
+
+  The delimiters are found 64 bytes at a time, with SSE2 or AVX2 instructions
+  where the processor has them. The AVX2 kernel is compiled for AVX2 on its
+  own, so the rest of the program still runs on any x86-64 processor, and which
+  kernel is used is decided when the program runs. On other processors (or
+  other compilers) only the plain C++ kernel is built.
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BETHYW_CSV_X86
+#include <immintrin.h>
+#endif
+
+#include "csv.h"
+
+/*How much text is scanned for delimiters at a time. A window fits in the L1 cache of most processors, and so do
+ * the positions of its delimiters in the usual case of a field every few bytes.*/
+static const std::size_t SCAN_WINDOW = 16 * 1024;
+
+/*Returns true for the bytes that the tokenizer has to find.*/
+static inline bool isDelimiter(char c) noexcept {
+    return c == ',' || c == '\n' || c == '\r';
+}
+
+/*Scans the bytes one at a time, for the tail of the other kernels and for processors without them.*/
+static std::size_t findScalar(const char* data, std::size_t length, std::size_t base,
+                              std::size_t* positions) noexcept {
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < length; i++) {
+        positions[count] = base + i;
+        count += isDelimiter(data[i]);
+    }
+    return count;
+}
+
+#ifdef BETHYW_CSV_X86
+
+/*Writes the position of every bit that is set in the mask of a block of 64 bytes, from the lowest bit up.*/
+static inline std::size_t appendMask(std::uint64_t mask, std::size_t base, std::size_t* positions) noexcept {
+    std::size_t count = 0;
+    while (mask != 0) {
+        positions[count++] = base + __builtin_ctzll(mask);
+        mask &= mask - 1;
+    }
+    return count;
+}
+
+static std::size_t findSSE2(const char* data, std::size_t length, std::size_t base,
+                            std::size_t* positions) noexcept {
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i carriageReturn = _mm_set1_epi8('\r');
+
+    std::size_t count = 0;
+    std::size_t i = 0;
+    for (; i + 64 <= length; i += 64) {
+        std::uint64_t mask = 0;
+        for (int k = 0; k < 4; k++) {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 16 * k));
+            const __m128i found = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, comma),
+                                                            _mm_cmpeq_epi8(bytes, newline)),
+                                               _mm_cmpeq_epi8(bytes, carriageReturn));
+            mask |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm_movemask_epi8(found))) << (16 * k);
+        }
+        count += appendMask(mask, base + i, positions + count);
+    }
+
+    return count + findScalar(data + i, length - i, base + i, positions + count);
+}
+
+__attribute__((target("avx2")))
+static std::size_t findAVX2(const char* data, std::size_t length, std::size_t base,
+                            std::size_t* positions) noexcept {
+    const __m256i comma = _mm256_set1_epi8(',');
+    const __m256i newline = _mm256_set1_epi8('\n');
+    const __m256i carriageReturn = _mm256_set1_epi8('\r');
+
+    std::size_t count = 0;
+    std::size_t i = 0;
+    for (; i + 64 <= length; i += 64) {
+        std::uint64_t mask = 0;
+        for (int k = 0; k < 2; k++) {
+            const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 32 * k));
+            const __m256i found = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(bytes, comma),
+                                                                  _mm256_cmpeq_epi8(bytes, newline)),
+                                                  _mm256_cmpeq_epi8(bytes, carriageReturn));
+            mask |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(found))) << (32 * k);
+        }
+        count += appendMask(mask, base + i, positions + count);
+    }
+
+    return count + findScalar(data + i, length - i, base + i, positions + count);
+}
+
+#endif // BETHYW_CSV_X86
+
+/*
+  Construct a tokenizer for the given CSV text. nextRow() needs to be called
+  before the first row can be read.
+
+  @param text
+    The CSV text, which must stay valid while the tokenizer is used
+
+  @param kernel
+    How to scan the text for delimiters, which must be supported by the
+    processor (see CsvTokenizer::supports()); the fastest one by default
+*/
+CsvTokenizer::CsvTokenizer(std::string_view text, Kernel kernel) : text(text),
+                                                                   kernel(kernel),
+                                                                   nextRowStart(0),
+                                                                   currentRow(),
+                                                                   nextFieldStart(0),
+                                                                   boundaries(),
+                                                                   numBoundaries(0),
+                                                                   nextBoundary(0),
+                                                                   scanned(0) {
+
+}
+
+/*Scans the next window of the text, after dropping the positions of the delimiters of the rows already read, so the
+ * positions kept are never more than those of a window and of the current row.*/
+void CsvTokenizer::scanMore() {
+    std::copy(boundaries.begin() + nextBoundary, boundaries.begin() + numBoundaries, boundaries.begin());
+    numBoundaries -= nextBoundary;
+    nextBoundary = 0;
+
+    const std::size_t length = std::min(SCAN_WINDOW, text.size() - scanned);
+    if (boundaries.size() < numBoundaries + length) {
+        boundaries.resize(numBoundaries + length);
+    }
+
+    numBoundaries += findDelimiters(text.data() + scanned, length, scanned, boundaries.data() + numBoundaries,
+                                    kernel);
+    scanned += length;
+}
+
+/*
+  Move on to the next row of the text. The line ending is not part of the row.
+
+  @return
+    true if there was another row, false if the end of the text was reached
+
+  @throws
+    std::bad_alloc if there is no memory for the delimiters of a long row
+*/
+bool CsvTokenizer::nextRow() {
+    if (nextRowStart >= text.size()) {
+        currentRow = std::string_view();
+        nextFieldStart = 0;
+        return false;
+    }
+
+    const char* start = text.data() + nextRowStart;
+    std::size_t remaining = text.size() - nextRowStart;
+    const char* newline = static_cast<const char*>(std::memchr(start, '\n', remaining));
+
+    //skip the delimiters left over from the fields of the previous row that were not read
+    while (nextBoundary < numBoundaries && boundaries[nextBoundary] < nextRowStart) {
+        nextBoundary++;
+    }
+
+    std::size_t rowLength = newline != nullptr ? static_cast<std::size_t>(newline - start) : remaining;
+    nextRowStart += newline != nullptr ? rowLength + 1 : rowLength;
+
+    while (scanned < nextRowStart) {
+        scanMore();
+    }
+
+    if (rowLength > 0 && start[rowLength - 1] == '\r') {
+        rowLength--;
+    }
+
+    currentRow = std::string_view(start, rowLength);
+    nextFieldStart = 0;
+    return true;
+}
+
+/*
+  Read the next field of the current row. As with std::getline, a comma at the
+  very end of a row is not followed by another (empty) field.
+
+  @param field
+    Set to a view of the field if there was one
+
+  @return
+    true if there was another field in the current row, false otherwise
+*/
+bool CsvTokenizer::nextField(std::string_view& field) noexcept {
+    if (nextFieldStart >= currentRow.size()) {
+        return false;
+    }
+
+    /*The delimiters of the row are all commas, apart from the line ending and any carriage return that is not part
+     * of one, which is part of a field instead.*/
+    const char* row = currentRow.data();
+    const std::size_t rowStart = static_cast<std::size_t>(row - text.data());
+    const std::size_t rowEnd = rowStart + currentRow.size();
+    const std::size_t* boundary = boundaries.data() + nextBoundary;
+    const std::size_t* end = boundaries.data() + numBoundaries;
+    const std::size_t fieldStart = nextFieldStart;
+
+    while (boundary != end && *boundary < rowEnd) {
+        const std::size_t comma = *boundary++ - rowStart;
+        if (row[comma] == ',') {
+            nextBoundary = static_cast<std::size_t>(boundary - boundaries.data());
+            nextFieldStart = comma + 1;
+            field = std::string_view(row + fieldStart, comma - fieldStart);
+            return true;
+        }
+    }
+
+    nextBoundary = static_cast<std::size_t>(boundary - boundaries.data());
+    nextFieldStart = currentRow.size();
+    field = std::string_view(row + fieldStart, currentRow.size() - fieldStart);
+    return true;
+}
+
+/*
+  Retrieve the whole of the current row.
+
+  @return
+    A view of the current row, without its line ending
+*/
+std::string_view CsvTokenizer::row() const noexcept {
+    return currentRow;
+}
+
+/*
+  Retrieve where the row after the current one begins in the text, e.g. to
+  hand the rest of the text after a header row to other tokenizers.
+
+  @return
+    The offset of the next row in the text
+*/
+std::size_t CsvTokenizer::position() const noexcept {
+    return nextRowStart;
+}
+
+/*
+  Split CSV text into chunks of whole rows, so that each chunk can be read by
+  its own tokenizer. Every chunk but the last ends just after a new line
+  character, so the chunks hold the same rows as the text, in the same order.
+
+  @param text
+    The CSV text
+
+  @param chunks
+    The number of chunks wanted, which is the most that can be returned
+
+  @return
+    Views of the chunks, which are fewer than asked for when some of them
+    would have been empty (e.g. the text is shorter than a few rows)
+
+  @example
+    auto chunks = CsvTokenizer::splitRows("a,1\nb,2\nc,3\n", 2);
+    // chunks is {"a,1\nb,2\n", "c,3\n"}
+*/
+std::vector<std::string_view> CsvTokenizer::splitRows(std::string_view text, std::size_t chunks) {
+    std::vector<std::string_view> split;
+
+    std::size_t begin = 0;
+    for (std::size_t k = 1; k < chunks && begin < text.size(); k++) {
+        const std::size_t newline = text.find('\n', std::max(begin, text.size() / chunks * k));
+        if (newline == std::string_view::npos) {
+            break;
+        }
+
+        split.push_back(text.substr(begin, newline + 1 - begin));
+        begin = newline + 1;
+    }
+
+    if (begin < text.size() || split.empty()) {
+        split.push_back(text.substr(begin));
+    }
+
+    return split;
+}
+
+/*
+  Find the fastest kernel the processor this program runs on supports, which
+  is only checked the first time.
+
+  @return
+    The kernel new tokenizers use by default
+*/
+CsvTokenizer::Kernel CsvTokenizer::bestKernel() noexcept {
+    static const Kernel best = supports(AVX2) ? AVX2 : supports(SSE2) ? SSE2 : SCALAR;
+    return best;
+}
+
+/*
+  Check whether a kernel can be used on the processor this program runs on.
+
+  @param kernel
+    The kernel to check
+
+  @return
+    true if the kernel was built into the program and the processor has the
+    instructions it needs
+*/
+bool CsvTokenizer::supports(Kernel kernel) noexcept {
+    switch (kernel) {
+#ifdef BETHYW_CSV_X86
+        case SSE2:
+            return __builtin_cpu_supports("sse2");
+
+        case AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+
+        case SCALAR:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+/*
+  Get the name of a kernel, e.g. for the output of benchmarks.
+
+  @param kernel
+    The kernel
+
+  @return
+    The name of the kernel, e.g. "AVX2"
+*/
+const char* CsvTokenizer::kernelName(Kernel kernel) noexcept {
+    switch (kernel) {
+        case SSE2:
+            return "SSE2";
+
+        case AVX2:
+            return "AVX2";
+
+        default:
+            return "scalar";
+    }
+}
+
+/*
+  Find every comma, new line character and carriage return in some text, in
+  the order they appear in it.
+
+  @param data
+    The text to scan
+
+  @param length
+    The number of bytes of the text
+
+  @param base
+    Added to the position of every delimiter, e.g. where the text starts in a
+    larger one
+
+  @param positions
+    Set to the positions of the delimiters; there must be room for length
+    positions, as every byte may be one
+
+  @param kernel
+    How to scan the text, which must be supported by the processor
+
+  @return
+    The number of delimiters found
+
+  @example
+    std::size_t positions[8];
+    CsvTokenizer::findDelimiters("a,b\r\nc", 6, 10, positions, CsvTokenizer::bestKernel());
+    // returns 3, and positions starts with {11, 13, 14}
+*/
+std::size_t CsvTokenizer::findDelimiters(const char* data, std::size_t length, std::size_t base,
+                                         std::size_t* positions, Kernel kernel) noexcept {
+    switch (kernel) {
+#ifdef BETHYW_CSV_X86
+        case SSE2:
+            return findSSE2(data, length, base, positions);
+
+        case AVX2:
+            return findAVX2(data, length, base, positions);
+#endif
+
+        default:
+            return findScalar(data, length, base, positions);
+    }
+}
@@ -0,0 +1,79 @@
+#ifndef CSV_H_
+#define CSV_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains the declaration of the CsvTokenizer class, which splits
+  the contents of a CSV file into rows and fields without copying them, and of
+  the vectorised kernels it finds the commas and line endings with.
+ */
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+/*
+  A CsvTokenizer walks over a block of CSV text one row at a time, and over each
+  row one field at a time. Rows and fields are returned as views into the
+  original text, so the text must outlive the tokenizer and the views it hands
+  out. Fields are separated by commas, and rows by a new line character with an
+  optional carriage return before it. Quoted fields are not supported, as none
+  of the datasets use them.
+
+  Rather than searching for every comma on its own, the tokenizer scans the
+  text a window at a time ahead of the rows being read, and keeps where every
+  comma, new line and carriage return of the window is. Reading a field is
+  then only taking the next of these positions.
+*/
+class CsvTokenizer {
+public:
+    //the ways of scanning text for delimiters, from the slowest to the fastest
+    enum Kernel {
+        SCALAR,
+        SSE2,
+        AVX2
+    };
+
+private:
+    std::string_view text;
+    Kernel kernel;
+    //where the row after the current one begins
+    std::size_t nextRowStart;
+
+    std::string_view currentRow;
+    //where the next field of the current row begins
+    std::size_t nextFieldStart;
+
+    //the positions in text of the delimiters scanned so far, from the current row on
+    std::vector<std::size_t> boundaries;
+    std::size_t numBoundaries;
+    //the first delimiter that has not been read yet
+    std::size_t nextBoundary;
+    //how much of the text has been scanned
+    std::size_t scanned;
+
+    void scanMore();
+
+public:
+    CsvTokenizer(std::string_view text, Kernel kernel = bestKernel());
+
+    bool nextRow();
+    bool nextField(std::string_view& field) noexcept;
+    std::string_view row() const noexcept;
+    std::size_t position() const noexcept;
+
+    static std::vector<std::string_view> splitRows(std::string_view text, std::size_t chunks);
+
+    static Kernel bestKernel() noexcept;
+    static bool supports(Kernel kernel) noexcept;
+    static const char* kernelName(Kernel kernel) noexcept;
+    static std::size_t findDelimiters(const char* data, std::size_t length, std::size_t base,
+                                      std::size_t* positions, Kernel kernel) noexcept;
+};
+
+#endif // CSV_H_
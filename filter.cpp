@@ -0,0 +1,159 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains the implementation of the FilterMatcher class.
+*/
+
+#include <cctype>
+#include <cstdint>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "filter.h"
+
+/*
+  Compile a filter into a matcher.
+
+  @param filter
+    The strings to look for in the data, or null/empty to include everything
+
+  @param fold
+    Whether the data is upper cased (area codes and names) or lower cased
+    (measure codes) before it is checked
+*/
+FilterMatcher::FilterMatcher(const std::unordered_set<std::string>* const filter, Case fold)
+        : matchAll(filter == nullptr || filter->empty()),
+          columnOf(),
+          numColumns(1),
+          transitions(),
+          accepting() {
+
+    if (matchAll) {
+        return;
+    }
+
+    /*Column 0 is for the bytes that are in none of the strings. Every other byte of the strings gets its own column,
+     * and the bytes of the data are folded to the same case through the same table.*/
+    std::array<uint16_t, 256> columnOfFolded = {};
+    for (auto it = filter->begin(); it != filter->end(); it++) {
+        if (it->empty()) {
+            //the empty string is a substring of everything
+            matchAll = true;
+            return;
+        }
+
+        for (auto c = it->begin(); c != it->end(); c++) {
+            uint16_t& column = columnOfFolded[static_cast<unsigned char>(*c)];
+            if (column == 0) {
+                column = numColumns++;
+            }
+        }
+    }
+
+    for (int byte = 0; byte < 256; byte++) {
+        int folded = fold == UPPER ? ::toupper(byte) : ::tolower(byte);
+        columnOf[byte] = columnOfFolded[static_cast<unsigned char>(folded)];
+    }
+
+    //build a trie of the strings, where 0 stands for a missing transition until they are resolved below
+    addState();
+    for (auto it = filter->begin(); it != filter->end(); it++) {
+        uint32_t state = 0;
+
+        for (auto c = it->begin(); c != it->end(); c++) {
+            uint32_t index = state * numColumns + columnOfFolded[static_cast<unsigned char>(*c)];
+            if (transitions[index] == 0) {
+                uint32_t next = addState();
+                transitions[index] = next;
+            }
+            state = transitions[index];
+        }
+
+        accepting[state] = true;
+    }
+
+    /*Visit the states in breadth first order, so the failure state of a state (the state of its longest proper
+     * suffix that is in the trie) is finished before the state itself. Missing transitions are replaced with those of
+     * the failure state, and a state accepts if its failure state does.*/
+    std::vector<uint32_t> failure(accepting.size(), 0);
+    std::queue<uint32_t> queue;
+
+    for (uint16_t column = 0; column < numColumns; column++) {
+        uint32_t next = transitions[column];
+        if (next != 0) {
+            queue.push(next);
+        }
+    }
+
+    while (!queue.empty()) {
+        uint32_t state = queue.front();
+        queue.pop();
+
+        if (accepting[failure[state]]) {
+            accepting[state] = true;
+        }
+
+        for (uint16_t column = 0; column < numColumns; column++) {
+            uint32_t& next = transitions[state * numColumns + column];
+            uint32_t fallback = transitions[failure[state] * numColumns + column];
+
+            if (next == 0) {
+                next = fallback;
+            } else {
+                failure[next] = fallback;
+                queue.push(next);
+            }
+        }
+    }
+}
+
+/*Adds a state with no transitions to the automaton and returns its number.*/
+uint32_t FilterMatcher::addState() {
+    uint32_t state = accepting.size();
+    transitions.resize(transitions.size() + numColumns, 0);
+    accepting.push_back(false);
+    return state;
+}
+
+/*
+  Check if the filter includes the given data.
+
+  @param data
+    The area code, area name or measure code to check, in any case
+
+  @return
+    true if the filter is empty, or one of its strings is a substring of the
+    case-folded data
+*/
+bool FilterMatcher::matches(std::string_view data) const noexcept {
+    if (matchAll) {
+        return true;
+    }
+
+    uint32_t state = 0;
+    for (auto it = data.begin(); it != data.end(); it++) {
+        state = transitions[state * numColumns + columnOf[static_cast<unsigned char>(*it)]];
+        if (accepting[state]) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+  Check if the filter includes all data, i.e. it was null or empty.
+
+  @return
+    true if every call to matches() returns true
+*/
+bool FilterMatcher::matchesAll() const noexcept {
+    return matchAll;
+}
@@ -0,0 +1,65 @@
+#ifndef FILTER_H_
+#define FILTER_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains the declaration of the FilterMatcher class, which checks
+  area and measure names against the filters given on the command line.
+ */
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+/*
+  A filter set is included by a FilterMatcher when it is empty or null, or
+  when one of its strings is a substring of the data (which includes the data
+  being equal to one of them). The data is upper or lower cased before it is
+  checked, the strings of the filter are used as they are.
+
+  Rather than case-folding the data into a new string and searching for every
+  string of the filter in turn, the filter is compiled once into an
+  Aho-Corasick automaton whose transitions are all resolved in advance, so
+  checking some data is one table lookup per character: it allocates nothing
+  and takes the same time however many strings the filter has. Checking for
+  equality separately is not needed, as an equal string is also a substring.
+
+  Only the bytes that appear in the filter get their own column in the table
+  of transitions; every other byte leads back to the start, which keeps the
+  table small for large filters.
+*/
+class FilterMatcher {
+public:
+    enum Case {
+        UPPER,
+        LOWER
+    };
+
+private:
+    bool matchAll;
+    //the column of the transition table for every byte of the data, after case folding
+    std::array<uint16_t, 256> columnOf;
+    uint16_t numColumns;
+    //the next state for every state and column
+    std::vector<uint32_t> transitions;
+    //true for the states where a string of the filter has been matched
+    std::vector<char> accepting;
+
+    uint32_t addState();
+
+public:
+    FilterMatcher(const std::unordered_set<std::string>* const filter, Case fold);
+
+    bool matches(std::string_view data) const noexcept;
+    bool matchesAll() const noexcept;
+};
+
+#endif // FILTER_H_
@@ -10,7 +10,18 @@
   by the functions in data.cpp. See the header file for additional comments.
  */
 
+#include <iterator>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include "input.h"
+#include "profile.h"
 
 /*
   Constructor for an InputSource.
@@ -63,3 +74,225 @@ std::istream& InputFile::open() {
 
     return fileInputStream;
 }
+
+/*
+  Construct a stream buffer that has nothing to read yet.
+*/
+MemoryStreamBuffer::MemoryStreamBuffer() : std::streambuf() {
+
+}
+
+/*
+  Make the stream buffer read from the given block of memory, starting at its
+  beginning. The memory must stay valid for as long as it is being read.
+
+  @param data
+    Pointer to the first byte to read
+
+  @param size
+    Number of bytes that can be read
+*/
+void MemoryStreamBuffer::reset(const char* data, std::size_t size) noexcept {
+    /*the get area pointers are not const in std::streambuf, but as we never put characters back into the buffer the
+     * memory is never written to.*/
+    char* begin = const_cast<char*>(data);
+    setg(begin, begin, begin + size);
+}
+
+/*
+  Retrieve the part of the memory that has not been read through the stream yet.
+
+  @return
+    A view of the unread bytes
+*/
+std::string_view MemoryStreamBuffer::unread() const noexcept {
+    return std::string_view(gptr(), egptr() - gptr());
+}
+
+/*
+  Retrieve the unread contents of any input stream as a single block of memory.
+  If the stream reads from a MemoryStreamBuffer, this is a view of its memory
+  and nothing is copied. Otherwise the rest of the stream is read into the given
+  string, and a view of that string is returned.
+
+  @param is
+    The input stream to retrieve the contents of
+
+  @param storage
+    A string that will hold the contents if they have to be copied, and must
+    outlive the returned view
+
+  @return
+    A view of the unread contents of the stream
+*/
+std::string_view MemoryStreamBuffer::unread(std::istream& is, std::string& storage) {
+    const MemoryStreamBuffer* memory = dynamic_cast<const MemoryStreamBuffer*>(is.rdbuf());
+
+    if (memory != nullptr) {
+        return memory->unread();
+    }
+
+    storage.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+    return std::string_view(storage);
+}
+
+/*Moves the read position relative to the beginning, current position or end of the memory, so that seekg() works on
+ * streams using this buffer.*/
+MemoryStreamBuffer::pos_type MemoryStreamBuffer::seekoff(off_type off, std::ios_base::seekdir dir,
+                                                         std::ios_base::openmode which) {
+    off_type base = 0;
+    if (dir == std::ios_base::cur) {
+        base = gptr() - eback();
+    } else if (dir == std::ios_base::end) {
+        base = egptr() - eback();
+    }
+
+    return seekpos(pos_type(base + off), which);
+}
+
+MemoryStreamBuffer::pos_type MemoryStreamBuffer::seekpos(pos_type pos, std::ios_base::openmode which) {
+    off_type offset = off_type(pos);
+
+    if (!(which & std::ios_base::in) || offset < 0 || offset > egptr() - eback()) {
+        return pos_type(off_type(-1));
+    }
+
+    setg(eback(), eback() + offset, egptr());
+    return pos;
+}
+
+/*
+  Construct a stream buffer that reads the given blocks of memory in order. The
+  memory must stay valid for as long as it is being read.
+
+  @param parts
+    The blocks of memory to read, any of which may be empty
+
+  @example
+    ChainedStreamBuffer buffer({"{\"value\":[", text.substr(begin, end - begin), "]}"});
+    std::istream is(&buffer);
+*/
+ChainedStreamBuffer::ChainedStreamBuffer(std::initializer_list<std::string_view> parts) : std::streambuf(),
+                                                                                          parts(parts),
+                                                                                          nextPart(0) {
+
+}
+
+/*Moves on to the next part that is not empty once the current one has been read, as the get area is only ever one
+ * part.*/
+ChainedStreamBuffer::int_type ChainedStreamBuffer::underflow() {
+    while (nextPart < parts.size()) {
+        const std::string_view part = parts[nextPart++];
+
+        if (!part.empty()) {
+            //as in MemoryStreamBuffer, the memory is never written to
+            char* begin = const_cast<char*>(part.data());
+            setg(begin, begin, begin + part.size());
+            return traits_type::to_int_type(*gptr());
+        }
+    }
+
+    return traits_type::eof();
+}
+
+/*
+  Constructor for a memory mapped file source. The file is mapped straight
+  away, and the mapping is released when the object is destroyed. If the file
+  cannot be opened, the error is reported when open() is called, as with
+  InputFile.
+
+  @param path
+    The complete path for a file to import.
+*/
+MmapInputFile::MmapInputFile(const std::string& filePath) : InputSource(filePath),
+                                                            data(nullptr),
+                                                            length(0),
+                                                            opened(false),
+                                                            contents(),
+                                                            buffer(),
+                                                            stream(&buffer) {
+#ifdef _WIN32
+    std::ifstream file(filePath, std::ios::binary);
+    if (file.is_open()) {
+        contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        data = contents.data();
+        length = contents.size();
+        opened = true;
+    }
+#else
+    int fd = ::open(filePath.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        struct stat info;
+        if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode)) {
+            length = info.st_size;
+
+            //mmap() does not accept empty mappings, but an empty file is still a file we could open
+            if (length == 0) {
+                opened = true;
+            } else {
+                void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapping != MAP_FAILED) {
+                    //the parsers read each file once from beginning to end
+                    madvise(mapping, length, MADV_SEQUENTIAL);
+                    data = static_cast<const char*>(mapping);
+                    opened = true;
+                } else {
+                    length = 0;
+                }
+            }
+        }
+
+        //the mapping stays valid after the file descriptor is closed
+        close(fd);
+    }
+#endif
+
+    buffer.reset(data, length);
+}
+
+/*
+  Release the memory mapping of the file, if there is one.
+*/
+MmapInputFile::~MmapInputFile() {
+#ifndef _WIN32
+    if (opened && length > 0) {
+        munmap(const_cast<char*>(data), length);
+    }
+#endif
+}
+
+/*
+  Retrieve the contents of the file as one contiguous block of bytes, which
+  stays valid for as long as this object exists.
+
+  @return
+    A view of the file contents, empty if the file could not be opened
+*/
+std::string_view MmapInputFile::bytes() const noexcept {
+    return std::string_view(data, length);
+}
+
+/*
+  Return a reference to a stream that reads from the mapped file, starting
+  from the beginning of the file.
+
+  @return
+    A standard input stream reference
+
+  @throws
+    std::runtime_error if there is an issue opening the file, with the message:
+    InputFile::open: Failed to open file <file name>
+*/
+std::istream& MmapInputFile::open() {
+    /*the message is the same as the one InputFile gives, so that it does not matter to users which of the two is
+     * used to read a dataset.*/
+    if (!opened) {
+        throw std::runtime_error(std::string("InputFile::open: Failed to open file ") + getSource());
+    }
+
+    BethYw::Profile::countBytesRead(length);
+
+    buffer.reset(data, length);
+    stream.clear();
+    return stream;
+}
@@ -9,17 +9,22 @@
   AUTHOR: 965337
 
   This file contains declarations for the input source handlers. There are
-  two classes: InputSource and InputFile. InputSource is abstract (i.e. it
-  contains a pure virtual function). InputFile is a concrete derivation of
-  InputSource, for input from files.
+  three classes: InputSource, InputFile and MmapInputFile. InputSource is
+  abstract (i.e. it contains a pure virtual function). InputFile and
+  MmapInputFile are concrete derivations of InputSource, for input from files.
 
-  Although only one class derives from InputSource, we have implemented our
-  code this way to support future expansion of input from different sources
-  (e.g. the web).
+  We have implemented our code this way to support future expansion of input
+  from different sources (e.g. the web).
  */
 
+#include <cstddef>
 #include <string>
+#include <string_view>
 #include <fstream>
+#include <initializer_list>
+#include <istream>
+#include <streambuf>
+#include <vector>
 
 /*
   InputSource is an abstract/purely virtual base class for all input source 
@@ -52,4 +57,72 @@ public:
     virtual std::istream& open();
 };
 
+/*
+  A stream buffer that reads directly from a block of memory it does not own,
+  without copying it. Parsers that are given a stream backed by one of these
+  can use unread() to look at the remaining contents as a single contiguous
+  block instead of reading them through the stream.
+*/
+class MemoryStreamBuffer : public std::streambuf {
+public:
+    MemoryStreamBuffer();
+
+    void reset(const char* data, std::size_t size) noexcept;
+    std::string_view unread() const noexcept;
+
+    static std::string_view unread(std::istream& is, std::string& storage);
+
+protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+};
+
+/*
+  A stream buffer that reads several blocks of memory it does not own one
+  after the other, as if they were one block, without copying them. This is
+  used to wrap a chunk of a file in the text it needs around it to be parsed
+  on its own.
+*/
+class ChainedStreamBuffer : public std::streambuf {
+private:
+    std::vector<std::string_view> parts;
+    //the index of the part after the one being read
+    std::size_t nextPart;
+
+public:
+    ChainedStreamBuffer(std::initializer_list<std::string_view> parts);
+
+protected:
+    int_type underflow() override;
+};
+
+/*
+  Source data that is contained within a file, which is mapped into memory
+  rather than read through a file stream. The contents of the file can be
+  retrieved as one contiguous block of bytes with bytes(), and the stream
+  returned by open() reads from that same memory.
+*/
+class MmapInputFile : public InputSource {
+private:
+    const char* data;
+    std::size_t length;
+    bool opened;
+    //on systems without mmap() the file is read into this string instead
+    std::string contents;
+
+    MemoryStreamBuffer buffer;
+    std::istream stream;
+
+public:
+    MmapInputFile(const std::string& filePath);
+    ~MmapInputFile();
+
+    MmapInputFile(const MmapInputFile& other) = delete;
+    MmapInputFile& operator=(const MmapInputFile& other) = delete;
+
+    std::string_view bytes() const noexcept;
+
+    virtual std::istream& open();
+};
+
 #endif // INPUT_H_
\ No newline at end of file
@@ -0,0 +1,182 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains the implementation of the intern table.
+
+  The strings are kept in segments that double in size and are never moved
+  or freed, and a hash table maps views of those strings to their IDs.
+  Datasets are parsed on several threads at once, so adding strings is
+  protected by a reader/writer lock. Looking up a string by its ID needs no
+  lock, as the string was stored before anyone could know its ID.
+
+  As consecutive rows of a dataset nearly always repeat the same few codes,
+  each thread also remembers the IDs of the strings it interned recently,
+  which answers most calls to intern() without taking the lock at all.
+*/
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "intern.h"
+
+//segment k holds FIRST_SEGMENT_SIZE * 2^k strings, so 32 segments are enough for every possible ID
+static const std::size_t FIRST_SEGMENT_SIZE = 64;
+static const unsigned int NUM_SEGMENTS = 32;
+
+/*
+  The strings and the IDs of the table.
+*/
+struct InternTable {
+    std::shared_mutex mutex;
+    std::atomic<std::string*> segments[NUM_SEGMENTS] = {};
+    BethYw::Intern::Id count = 0;
+    std::unordered_map<std::string_view, BethYw::Intern::Id> ids;
+};
+
+/*Finds the segment of the string with the given ID, and its index in that segment.*/
+static void locate(BethYw::Intern::Id id, unsigned int& segment, std::size_t& index) noexcept {
+    const uint64_t n = id / FIRST_SEGMENT_SIZE + 1;
+
+    segment = 63 - __builtin_clzll(n);
+    index = id - FIRST_SEGMENT_SIZE * ((uint64_t(1) << segment) - 1);
+}
+
+/*The table is never destroyed, as IDs and references to its strings may still be used while the program exits, e.g.
+ * by the worker threads of a server.*/
+static InternTable& table() {
+    static InternTable* const instance = new InternTable();
+    return *instance;
+}
+
+/*
+  An entry of the small per-thread cache of recently interned strings, which
+  is indexed by their hash. Entries point to the strings in the table, which
+  never change.
+*/
+struct InternCacheEntry {
+    const std::string* str = nullptr;
+    BethYw::Intern::Id id = 0;
+};
+
+static const std::size_t CACHE_SIZE = 64;
+
+static thread_local InternCacheEntry cache[CACHE_SIZE];
+
+/*
+  Return the ID of a string, adding it to the table if needed.
+
+  @param str
+    The string to intern
+
+  @return
+    The ID of the string
+
+  @example
+    BethYw::Intern::Id id = BethYw::Intern::intern("pop");
+    BethYw::Intern::lookup(id) == "pop"; // true
+*/
+BethYw::Intern::Id BethYw::Intern::intern(std::string_view str) {
+    const std::size_t hash = std::hash<std::string_view>()(str);
+    InternCacheEntry& cached = cache[hash % CACHE_SIZE];
+
+    if (cached.str != nullptr && *cached.str == str) {
+        return cached.id;
+    }
+
+    InternTable& t = table();
+    {
+        std::shared_lock<std::shared_mutex> lock(t.mutex);
+        auto it = t.ids.find(str);
+        if (it != t.ids.end()) {
+            cached = {&lookup(it->second), it->second};
+            return it->second;
+        }
+    }
+
+    //another thread may have added the string after we looked, so we look again while holding the write lock
+    std::unique_lock<std::shared_mutex> lock(t.mutex);
+    auto it = t.ids.find(str);
+    if (it == t.ids.end()) {
+        const Id id = t.count;
+
+        unsigned int segment;
+        std::size_t index;
+        locate(id, segment, index);
+
+        std::string* strings = t.segments[segment].load(std::memory_order_relaxed);
+        if (strings == nullptr) {
+            strings = new std::string[FIRST_SEGMENT_SIZE << segment];
+            t.segments[segment].store(strings, std::memory_order_release);
+        }
+
+        strings[index] = str;
+        it = t.ids.emplace(strings[index], id).first;
+        t.count++;
+    }
+
+    cached = {&lookup(it->second), it->second};
+    return it->second;
+}
+
+/*
+  Find the ID of a string that has already been interned.
+
+  @param str
+    The string to find
+
+  @param id
+    Set to the ID of the string if it was found
+
+  @return
+    true if the string is in the table
+*/
+bool BethYw::Intern::find(std::string_view str, Id& id) {
+    InternTable& t = table();
+    std::shared_lock<std::shared_mutex> lock(t.mutex);
+
+    auto it = t.ids.find(str);
+    if (it == t.ids.end()) {
+        return false;
+    }
+
+    id = it->second;
+    return true;
+}
+
+/*
+  Return the string with the given ID, which must have been returned by
+  intern().
+
+  @param id
+    The ID of the string
+
+  @return
+    A reference to the string in the table
+*/
+const std::string& BethYw::Intern::lookup(Id id) noexcept {
+    unsigned int segment;
+    std::size_t index;
+    locate(id, segment, index);
+
+    return table().segments[segment].load(std::memory_order_acquire)[index];
+}
+
+/*
+  Return the number of strings that have been interned.
+
+  @return
+    The number of strings in the table
+*/
+std::size_t BethYw::Intern::size() noexcept {
+    InternTable& t = table();
+    std::shared_lock<std::shared_mutex> lock(t.mutex);
+
+    return t.count;
+}
@@ -0,0 +1,67 @@
+#ifndef INTERN_H_
+#define INTERN_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains the declarations of the intern table, which keeps a
+  single copy of the measure codes and measure labels used by Area and
+  Measure objects. Every area has the same few of these, so they are stored
+  once however many areas there are. Authority codes are not interned, as
+  nearly every area has its own.
+
+  The table is never emptied, so only strings read from the data files are
+  interned, never strings that come from a query: a server answering queries
+  for as long as it runs keeps the table at the size of its loaded data.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace BethYw {
+
+namespace Intern {
+
+    /*
+      The ID of a string in the intern table. Two strings have the same ID if
+      and only if they are equal, so IDs can be compared and hashed instead of
+      the strings.
+    */
+    using Id = uint32_t;
+
+    /*
+      Return the ID of a string, adding the string to the table if it is not
+      in it yet. IDs are never reused or removed, so an ID stays valid for as
+      long as the program runs.
+    */
+    Id intern(std::string_view str);
+
+    /*
+      Find the ID of a string without adding it to the table, returning false
+      if the string has never been interned (in which case nothing can be
+      stored under it).
+    */
+    bool find(std::string_view str, Id& id);
+
+    /*
+      Return the string with the given ID. The reference stays valid for as
+      long as the program runs.
+    */
+    const std::string& lookup(Id id) noexcept;
+
+    /*
+      Return the number of strings in the table.
+    */
+    std::size_t size() noexcept;
+
+} // namespace Intern
+
+} // namespace BethYw
+
+#endif // INTERN_H_
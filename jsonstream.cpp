@@ -0,0 +1,706 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains the implementation of the JsonRowSchema, JsonRow and
+  JsonRowReader classes. The JSON library calls one of the functions of the
+  reader for every token it reads, and we keep just enough state to know when
+  we are directly inside a row of the "value" array, and which slot of the
+  schema the last key read belongs to.
+*/
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "lib_json.hpp"
+#include "jsonstream.h"
+#include "input.h"
+#include "numbers.h"
+#include "parallel.h"
+
+/*
+  Construct the schema of the given columns of a dataset. Columns that map to
+  the same key (e.g. the measure code and name of the AQI dataset) share a
+  slot.
+
+  @param cols
+    The column mapping of the dataset, from datasets.h
+
+  @param columns
+    The columns that will be read from each row
+
+  @throws
+    std::out_of_range if one of the columns is not in cols
+
+  @example
+    JsonRowSchema schema(BethYw::InputFiles::POPDEN.COLS, {BethYw::SourceColumn::AUTH_CODE});
+    schema.find("Localauthority_Code") == schema.slot(BethYw::SourceColumn::AUTH_CODE); // true
+*/
+JsonRowSchema::JsonRowSchema(const BethYw::SourceColumnMapping& cols,
+                             std::initializer_list<BethYw::SourceColumn> columns) : keys() {
+    for (std::size_t& s : slots) {
+        s = NO_SLOT;
+    }
+
+    for (BethYw::SourceColumn column : columns) {
+        const std::string& key = cols.at(column);
+
+        slots[column] = find(key);
+        if (slots[column] == NO_SLOT) {
+            slots[column] = keys.size();
+            keys.push_back(key);
+        }
+    }
+}
+
+/*
+  Return the number of slots, i.e. the number of distinct keys, of the schema.
+
+  @return
+    The number of slots
+*/
+std::size_t JsonRowSchema::size() const noexcept {
+    return keys.size();
+}
+
+/*
+  Return the slot of a column that the schema was constructed with.
+
+  @param column
+    The column to find
+
+  @return
+    The slot of the column's key
+
+  @throws
+    std::out_of_range if the schema was not constructed with this column
+*/
+std::size_t JsonRowSchema::slot(BethYw::SourceColumn column) const {
+    if (slots[column] == NO_SLOT) {
+        throw std::out_of_range("JsonRowSchema::slot: column is not part of the schema");
+    }
+
+    return slots[column];
+}
+
+/*
+  Return the slot of a key of a row, or NO_SLOT if the key is not part of the
+  schema. There are only a handful of keys, so comparing with each of them is
+  quicker than hashing.
+
+  @param key
+    The key read from the row
+
+  @return
+    The slot of the key, or JsonRowSchema::NO_SLOT
+*/
+std::size_t JsonRowSchema::find(const std::string& key) const noexcept {
+    for (std::size_t i = 0; i < keys.size(); i++) {
+        if (keys[i] == key) {
+            return i;
+        }
+    }
+
+    return NO_SLOT;
+}
+
+/*
+  Return the key of a slot.
+
+  @param slot
+    A slot of the schema, less than size()
+
+  @return
+    The key of the slot
+*/
+const std::string& JsonRowSchema::key(std::size_t slot) const noexcept {
+    return keys[slot];
+}
+
+/*
+  Construct an empty row with one field for every slot of the schema.
+
+  @param schema
+    The schema of the rows, which must outlive the row
+*/
+JsonRow::JsonRow(const JsonRowSchema& schema) : schema(schema), fields(schema.size()) {
+
+}
+
+/*The block comment for Areas::populateFromWelshStatsJSON requires that runtime_error be thrown when the json file is
+ * malformed, which includes a row missing one of the keys we read.*/
+const JsonRow::Field& JsonRow::get(std::size_t slot) const {
+    const Field& field = fields[slot];
+
+    if (field.kind == MISSING) {
+        throw std::runtime_error(std::string("Malformed JSON file! No value for key:") + schema.key(slot));
+    }
+
+    return field;
+}
+
+/*
+  Return the string value of a slot in this row.
+
+  @param slot
+    A slot of the schema of this row
+
+  @return
+    The value of the slot's key
+
+  @throws
+    std::runtime_error if the row has no value for the key, or it is not a
+    string
+*/
+const std::string& JsonRow::getString(std::size_t slot) const {
+    const Field& field = get(slot);
+
+    if (field.kind != STRING) {
+        throw std::runtime_error(std::string("Malformed JSON file! Value for key:") + schema.key(slot) +
+                                 " is not a string");
+    }
+
+    return field.text;
+}
+
+/*
+  Return the numeric value of a slot in this row. Some datasets store their
+  numbers as strings (e.g. "12.5"), which are converted here.
+
+  @param slot
+    A slot of the schema of this row
+
+  @return
+    The value of the slot's key as a double
+
+  @throws
+    std::runtime_error if the row has no value for the key, or it is neither
+    a number nor a string that is a number
+*/
+double JsonRow::getNumber(std::size_t slot) const {
+    const Field& field = get(slot);
+
+    double value;
+    if (field.kind == NUMBER) {
+        return field.number;
+    } else if (field.kind == STRING && BethYw::toDouble(field.text, value)) {
+        return value;
+    }
+
+    throw std::runtime_error(std::string("Malformed JSON file! Value for key:") + schema.key(slot) +
+                             " is not a number");
+}
+
+/*
+  Construct a reader that will fill the keys of the schema from every row of
+  the "value" array, and hand each row to the given function.
+
+  @param schema
+    The keys to read from each row, which must outlive the reader
+
+  @param onRow
+    Function called with each complete row, in the order they appear in the file
+*/
+JsonRowReader::JsonRowReader(const JsonRowSchema& schema, const std::function<void(const JsonRow&)>& onRow) :
+        schema(schema),
+        onRow(onRow),
+        depth(0),
+        valueKeyRead(false),
+        valueArrayDepth(0),
+        valueArrayFound(false),
+        row(schema),
+        inRow(false),
+        slot(JsonRowSchema::NO_SLOT) {
+
+}
+
+/*
+  Read the whole stream, calling the row function for every row found.
+
+  @param is
+    The input stream from InputSource
+
+  @throws
+    std::runtime_error if the stream does not contain valid JSON
+*/
+void JsonRowReader::parse(std::istream& is) {
+    /*Parsing from a block of memory is quicker than through a stream, so we do that when the stream reads from one,
+     * e.g. a memory mapped file.*/
+    const MemoryStreamBuffer* memory = dynamic_cast<const MemoryStreamBuffer*>(is.rdbuf());
+
+    if (memory != nullptr) {
+        std::string_view text = memory->unread();
+        json::sax_parse(text.data(), text.data() + text.size(), this);
+    } else {
+        json::sax_parse(is, this);
+    }
+}
+
+/*
+  Check if the top level object of the parsed file had a "value" array.
+
+  @return
+    true if a "value" array was found, even if it was empty
+*/
+bool JsonRowReader::foundRows() const noexcept {
+    return valueArrayFound;
+}
+
+/*Returns the position of the quote that ends the string starting at `from`, skipping escaped quotes, or npos if the
+ * string does not end. The byte before `from` is the opening quote, which stops the count of backslashes.*/
+static std::size_t closingQuote(std::string_view text, std::size_t from) noexcept {
+    while (true) {
+        const std::size_t quote = text.find('"', from);
+        if (quote == std::string_view::npos) {
+            return quote;
+        }
+
+        std::size_t backslashes = 0;
+        while (text[quote - 1 - backslashes] == '\\') {
+            backslashes++;
+        }
+
+        if (backslashes % 2 == 0) {
+            return quote;
+        }
+        from = quote + 1;
+    }
+}
+
+//the depth of the rows of the "value" array, which is in the top level object
+static const std::size_t ROW_DEPTH = 2;
+
+/*Returns the position just after the opening bracket of the next "value" array of the top level object, scanning from
+ * `from` at the given depth (0 before the top level object, 1 inside it), or npos if there is none.*/
+static std::size_t nextValueArray(std::string_view text, std::size_t from, std::size_t depth) noexcept {
+    //the last key of the top level object, which is followed by its value
+    std::string_view lastKey;
+
+    for (std::size_t i = from; i < text.size(); i++) {
+        const char c = text[i];
+
+        if (c == '"') {
+            const std::size_t close = closingQuote(text, i + 1);
+            if (close == std::string_view::npos) {
+                return close;
+            }
+
+            if (depth == 1) {
+                const std::size_t next = text.find_first_not_of(" \t\r\n", close + 1);
+                if (next != std::string_view::npos && text[next] == ':') {
+                    lastKey = text.substr(i + 1, close - i - 1);
+                }
+            }
+
+            i = close;
+        } else if (c == '{' || c == '[') {
+            if (c == '[' && depth == 1 && lastKey == "value") {
+                return i + 1;
+            }
+            depth++;
+        } else if (c == '}' || c == ']') {
+            //the end of the top level object
+            if (depth <= 1) {
+                return std::string_view::npos;
+            }
+            depth--;
+        }
+    }
+
+    return std::string_view::npos;
+}
+
+/*Calls visit(position, bracket) for every bracket from `from` up to `to` that is not inside a string, until it returns
+ * false. If inString is set, the scan starts inside a string. Returns where the scan stopped.*/
+template <typename Visitor>
+static std::size_t scanBrackets(std::string_view text, std::size_t from, std::size_t to, bool inString,
+                                Visitor visit) {
+    std::size_t i = from;
+    if (inString) {
+        const std::size_t close = closingQuote(text, from);
+        if (close == std::string_view::npos || close >= to) {
+            return to;
+        }
+        i = close + 1;
+    }
+
+    for (; i < to; i++) {
+        const char c = text[i];
+
+        if (c == '"') {
+            const std::size_t close = closingQuote(text, i + 1);
+            if (close == std::string_view::npos || close >= to) {
+                return to;
+            }
+            i = close;
+        } else if (c == '{' || c == '}' || c == '[' || c == ']') {
+            if (!visit(i, c)) {
+                return i;
+            }
+        }
+    }
+
+    return to;
+}
+
+/*Returns the number of quotes from `from` up to `to` that are not escaped, i.e. that begin or end a string.*/
+static std::size_t countQuotes(std::string_view text, std::size_t from, std::size_t to) noexcept {
+    std::size_t count = 0;
+
+    for (std::size_t quote = text.find('"', from); quote < to; quote = text.find('"', quote + 1)) {
+        std::size_t backslashes = 0;
+        while (text[quote - 1 - backslashes] == '\\') {
+            backslashes++;
+        }
+
+        if (backslashes % 2 == 0) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/*Returns the position just after the row that ends before `next`, or npos unless there is only whitespace between the
+ * two, with one comma if `next` is the beginning of another row.*/
+static std::size_t endOfRowBefore(std::string_view text, std::size_t next, bool beforeRow) noexcept {
+    std::size_t i = text.find_last_not_of(" \t\r\n", next - 1);
+
+    if (beforeRow) {
+        if (i == std::string_view::npos || text[i] != ',') {
+            return std::string_view::npos;
+        }
+        i = text.find_last_not_of(" \t\r\n", i - 1);
+    }
+
+    if (i == std::string_view::npos || text[i] != '}') {
+        return std::string_view::npos;
+    }
+    return i + 1;
+}
+
+/*
+  Find where each row of the "value" array is in the text of a file, without
+  parsing the values, by only following the strings, objects and arrays. This
+  is many times quicker than parsing, and gives the rows a JsonRowReader would
+  read, in the same order, for any valid file. The text is not checked for
+  errors, so callers that need to be sure of the rows compare them with those
+  a reader finds.
+
+  @param text
+    The contents of a StatsWales JSON file
+
+  @return
+    The span of every row, in the order they are in the file
+
+  @example
+    auto rows = JsonRowReader::findRows("{\"value\": [{\"a\": 1}, {\"a\": 2}]}");
+    // rows[0] is {11, 19}, the span of {"a": 1}
+*/
+std::vector<JsonRowSpan> JsonRowReader::findRows(std::string_view text) {
+    std::vector<JsonRowSpan> rows;
+
+    std::size_t from = nextValueArray(text, 0, 0);
+    while (from != std::string_view::npos) {
+        std::size_t depth = ROW_DEPTH;
+        std::size_t rowBegin = 0;
+        std::size_t arrayEnd = std::string_view::npos;
+
+        scanBrackets(text, from, text.size(), false, [&](std::size_t i, char c) {
+            if (c == '{' || c == '[') {
+                if (c == '{' && depth == ROW_DEPTH) {
+                    rowBegin = i;
+                }
+                depth++;
+            } else {
+                depth--;
+                if (depth < ROW_DEPTH) {
+                    arrayEnd = i;
+                    return false;
+                } else if (c == '}' && depth == ROW_DEPTH) {
+                    rows.push_back({rowBegin, i + 1});
+                }
+            }
+            return true;
+        });
+
+        from = arrayEnd == std::string_view::npos ? arrayEnd : nextValueArray(text, arrayEnd + 1, 1);
+    }
+
+    return rows;
+}
+
+/*
+  Split the "value" array of a file into consecutive chunks of whole rows, so
+  the chunks can be parsed at the same time. The text after the beginning of
+  the array is cut into pieces at arbitrary bytes, and the state of a scan at
+  the beginning of each piece (whether it is inside a string, and how deeply
+  nested) is worked out on several threads in two passes: first from the
+  number of unescaped quotes in the pieces before it, and then from how much
+  each of those pieces changes the depth. Each chunk then begins at the first
+  row that begins in a piece.
+
+  The chunks only hold the rows, so they are only returned when parsing them
+  gives the same result as parsing the file: the rest of the file must be
+  valid JSON with no other "value" array, and only whitespace and commas may
+  be between the chunks. Whether the rows themselves are valid is only known
+  once they are parsed.
+
+  @param text
+    The contents of a StatsWales JSON file
+
+  @param chunks
+    The number of chunks wanted, which is the most that can be returned
+
+  @param threads
+    The number of threads to scan the text on
+
+  @return
+    The spans of the chunks, each from the beginning of its first row to the
+    end of its last row, in the order they are in the file, or no chunks if
+    the file has no rows or can not be split safely
+
+  @example
+    auto chunks = JsonRowReader::splitRows(text, 8, 4);
+    for (auto it = chunks.begin(); it != chunks.end(); it++) {
+      std::string chunk = "{\"value\":[" + std::string(text.substr(it->begin, it->end - it->begin)) + "]}";
+      // ... parse chunk
+    }
+*/
+std::vector<JsonRowSpan> JsonRowReader::splitRows(std::string_view text, std::size_t chunks, unsigned int threads) {
+    const std::size_t npos = std::string_view::npos;
+
+    const std::size_t arrayBegin = nextValueArray(text, 0, 0);
+    if (arrayBegin == npos || chunks < 2) {
+        return {};
+    }
+
+    const std::size_t numPieces = chunks;
+    std::vector<std::size_t> pieceBegin(numPieces + 1);
+    for (std::size_t k = 0; k <= numPieces; k++) {
+        pieceBegin[k] = arrayBegin + (text.size() - arrayBegin) / numPieces * k;
+    }
+    pieceBegin[numPieces] = text.size();
+
+    //a piece begins inside a string if there is an odd number of unescaped quotes before it
+    std::vector<std::size_t> quotes(numPieces);
+    BethYw::parallelFor(numPieces, threads, [&](std::size_t k) {
+        quotes[k] = countQuotes(text, pieceBegin[k], pieceBegin[k + 1]);
+    });
+
+    std::vector<char> inString(numPieces, false);
+    for (std::size_t k = 1; k < numPieces; k++) {
+        inString[k] = (inString[k - 1] + quotes[k - 1]) % 2;
+    }
+
+    /*For each piece, how much it changes the depth, and where it first goes 1, 2, ... levels below the depth it
+     * begins at, one of which is where the array ends.*/
+    std::vector<long> depthChange(numPieces);
+    std::vector<std::vector<std::size_t>> firstBelow(numPieces);
+    BethYw::parallelFor(numPieces, threads, [&](std::size_t k) {
+        long depth = 0;
+        scanBrackets(text, pieceBegin[k], pieceBegin[k + 1], inString[k], [&](std::size_t i, char c) {
+            if (c == '{' || c == '[') {
+                depth++;
+            } else if (--depth < 0 && static_cast<std::size_t>(-depth) > firstBelow[k].size()) {
+                firstBelow[k].push_back(i);
+            }
+            return true;
+        });
+        depthChange[k] = depth;
+    });
+
+    std::vector<long> startDepth(numPieces);
+    std::size_t arrayEnd = npos;
+    std::size_t lastPiece = 0;
+    for (std::size_t k = 0; k < numPieces && arrayEnd == npos; k++) {
+        startDepth[k] = k == 0 ? ROW_DEPTH : startDepth[k - 1] + depthChange[k - 1];
+        if (startDepth[k] < static_cast<long>(ROW_DEPTH)) {
+            return {};
+        }
+
+        const std::size_t levels = startDepth[k] - ROW_DEPTH;
+        if (firstBelow[k].size() > levels) {
+            arrayEnd = firstBelow[k][levels];
+            lastPiece = k;
+        }
+    }
+
+    if (arrayEnd == npos || text[arrayEnd] != ']') {
+        return {};
+    }
+
+    //the first row that begins in each piece, if there is one before the end of the array
+    std::vector<std::size_t> rowBegin(lastPiece + 1, npos);
+    BethYw::parallelFor(lastPiece + 1, threads, [&](std::size_t k) {
+        long depth = startDepth[k];
+        scanBrackets(text, pieceBegin[k], arrayEnd, inString[k], [&](std::size_t i, char c) {
+            if (c == '{' && depth == static_cast<long>(ROW_DEPTH)) {
+                rowBegin[k] = i;
+                return false;
+            }
+            depth += c == '{' || c == '[' ? 1 : -1;
+            return true;
+        });
+    });
+
+    std::vector<std::size_t> chunkBegin;
+    for (auto it = rowBegin.begin(); it != rowBegin.end(); it++) {
+        if (*it != npos && (chunkBegin.empty() || chunkBegin.back() != *it)) {
+            chunkBegin.push_back(*it);
+        }
+    }
+
+    if (chunkBegin.empty() || nextValueArray(text, arrayEnd + 1, 1) != npos ||
+            !json::accept(std::string(text.substr(0, arrayBegin)) + std::string(text.substr(arrayEnd)))) {
+        return {};
+    }
+
+    std::vector<JsonRowSpan> spans;
+    for (std::size_t j = 0; j < chunkBegin.size(); j++) {
+        const bool last = j + 1 == chunkBegin.size();
+        const std::size_t end = endOfRowBefore(text, last ? arrayEnd : chunkBegin[j + 1], !last);
+        if (end == npos || end <= chunkBegin[j]) {
+            return {};
+        }
+        spans.push_back({chunkBegin[j], end});
+    }
+
+    return spans;
+}
+
+/*Returns the field of the row that the value being read goes in, or nullptr if the value is not directly inside a row
+ * or its key is not part of the schema.*/
+JsonRow::Field* JsonRowReader::rowField() noexcept {
+    valueKeyRead = false;
+
+    if (!inRow || depth != valueArrayDepth + 1 || slot == JsonRowSchema::NO_SLOT) {
+        return nullptr;
+    }
+
+    return &row.fields[slot];
+}
+
+/*Values that are neither strings nor numbers are not kept, but are recorded so that a key of the schema holding one is
+ * reported as malformed rather than missing.*/
+bool JsonRowReader::null() {
+    JsonRow::Field* field = rowField();
+    if (field != nullptr) {
+        field->kind = JsonRow::OTHER;
+    }
+
+    return true;
+}
+
+bool JsonRowReader::boolean(bool val) {
+    return null();
+}
+
+bool JsonRowReader::number_integer(number_integer_t val) {
+    return number_float(val, "");
+}
+
+bool JsonRowReader::number_unsigned(number_unsigned_t val) {
+    return number_float(val, "");
+}
+
+bool JsonRowReader::number_float(number_float_t val, const string_t& s) {
+    JsonRow::Field* field = rowField();
+    if (field != nullptr) {
+        field->kind = JsonRow::NUMBER;
+        field->number = val;
+    }
+
+    return true;
+}
+
+/*The parser reuses the same string for every token, so we copy it into the field, which also reuses the memory it
+ * had for the same key of the previous row.*/
+bool JsonRowReader::string(string_t& val) {
+    JsonRow::Field* field = rowField();
+    if (field != nullptr) {
+        field->kind = JsonRow::STRING;
+        field->text.assign(val);
+    }
+
+    return true;
+}
+
+/*Binary values are never produced when parsing JSON text, only by the binary formats of the library.*/
+bool JsonRowReader::binary(binary_t& val) {
+    return null();
+}
+
+bool JsonRowReader::start_object(std::size_t elements) {
+    if (inRow) {
+        //nested objects are not read, but a key of the schema holding one is malformed
+        null();
+    } else if (valueArrayDepth != 0 && depth == valueArrayDepth) {
+        for (JsonRow::Field& field : row.fields) {
+            field.kind = JsonRow::MISSING;
+        }
+
+        inRow = true;
+        slot = JsonRowSchema::NO_SLOT;
+    }
+
+    valueKeyRead = false;
+    depth++;
+    return true;
+}
+
+bool JsonRowReader::key(string_t& val) {
+    if (inRow) {
+        if (depth == valueArrayDepth + 1) {
+            slot = schema.find(val);
+        }
+    } else if (depth == 1) {
+        valueKeyRead = val == "value";
+    }
+
+    return true;
+}
+
+bool JsonRowReader::end_object() {
+    depth--;
+
+    if (inRow && depth == valueArrayDepth) {
+        inRow = false;
+        onRow(row);
+    }
+
+    return true;
+}
+
+bool JsonRowReader::start_array(std::size_t elements) {
+    if (inRow) {
+        null();
+    } else if (depth == 1 && valueKeyRead) {
+        valueArrayDepth = depth + 1;
+        valueArrayFound = true;
+    }
+
+    valueKeyRead = false;
+    depth++;
+    return true;
+}
+
+bool JsonRowReader::end_array() {
+    if (!inRow && depth == valueArrayDepth) {
+        valueArrayDepth = 0;
+    }
+
+    depth--;
+    return true;
+}
+
+/*The block comment for Areas::populateFromWelshStatsJSON requires that runtime_error be thrown when the json file is
+ * malformed, so we do that instead of letting the parser throw its own exception.*/
+bool JsonRowReader::parse_error(std::size_t position, const std::string& last_token,
+                                const nlohmann::detail::exception& ex) {
+    throw std::runtime_error(std::string("Malformed JSON file! ") + ex.what());
+}
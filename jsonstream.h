@@ -0,0 +1,155 @@
+#ifndef JSONSTREAM_H_
+#define JSONSTREAM_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains the declaration of the JsonRowReader class, which streams
+  the rows of a StatsWales JSON file one at a time using the SAX interface of
+  the JSON library, instead of materialising the whole document in memory,
+  and of the JsonRowSchema and JsonRow classes it fills the rows into.
+ */
+
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "lib_json.hpp"
+#include "datasets.h"
+
+/*
+  An alias for the imported JSON parsing library.
+*/
+using json = nlohmann::json;
+
+/*
+  A JsonRowSchema is built once for a dataset from the column names in its
+  InputFileSource::COLS. Each distinct key that is read from a row is given a
+  slot, so the values of a row can be kept in a fixed array rather than a json
+  object, and a column is found by its slot rather than by its name.
+*/
+class JsonRowSchema {
+public:
+    //returned by find() for keys that are not part of the schema
+    static constexpr std::size_t NO_SLOT = static_cast<std::size_t>(-1);
+
+private:
+    std::vector<std::string> keys;
+    //the slot of each SourceColumn, or NO_SLOT for columns that are not read
+    std::size_t slots[BethYw::SourceColumn::VALUE + 1];
+
+public:
+    JsonRowSchema(const BethYw::SourceColumnMapping& cols, std::initializer_list<BethYw::SourceColumn> columns);
+
+    std::size_t size() const noexcept;
+    std::size_t slot(BethYw::SourceColumn column) const;
+    std::size_t find(const std::string& key) const noexcept;
+    const std::string& key(std::size_t slot) const noexcept;
+};
+
+/*
+  The values of a single row that are in the schema it was read with, each in
+  the slot the schema gave its key. Only strings and numbers are kept; the
+  other types of values are recorded so they can be reported as malformed.
+*/
+class JsonRow {
+private:
+    friend class JsonRowReader;
+
+    enum Kind {
+        MISSING,
+        STRING,
+        NUMBER,
+        OTHER
+    };
+
+    struct Field {
+        Kind kind = MISSING;
+        std::string text;
+        double number = 0;
+    };
+
+    const JsonRowSchema& schema;
+    std::vector<Field> fields;
+
+    const Field& get(std::size_t slot) const;
+
+public:
+    JsonRow(const JsonRowSchema& schema);
+
+    const std::string& getString(std::size_t slot) const;
+    double getNumber(std::size_t slot) const;
+};
+
+/*
+  Where a row of the "value" array is in the text of a file: the row is the
+  object from the byte at `begin` up to, but not including, the byte at `end`.
+*/
+struct JsonRowSpan {
+    std::size_t begin;
+    std::size_t end;
+};
+
+/*
+  StatsWales files have a top level object whose "value" key holds an array of
+  flat row objects. A JsonRowReader listens to the SAX events of the parser,
+  copies the values of each row of that array whose keys are in the schema into
+  a JsonRow, and hands it over to a callback as soon as the row is complete.
+  Only one row is ever held in memory, so memory use is bounded by the size of
+  a row rather than of the file, and the other keys of a row cost nothing but
+  a comparison with the keys of the schema.
+*/
+class JsonRowReader : public nlohmann::json_sax<json> {
+private:
+    const JsonRowSchema& schema;
+    std::function<void(const JsonRow&)> onRow;
+
+    //how many objects/arrays we are currently nested in
+    std::size_t depth;
+    //true right after the "value" key of the top level object has been read
+    bool valueKeyRead;
+    //depth of the "value" array while we are inside it, 0 otherwise
+    std::size_t valueArrayDepth;
+    bool valueArrayFound;
+
+    //the row being read, whether we are inside it, and the slot of the last key read directly inside it
+    JsonRow row;
+    bool inRow;
+    std::size_t slot;
+
+    JsonRow::Field* rowField() noexcept;
+
+public:
+    JsonRowReader(const JsonRowSchema& schema, const std::function<void(const JsonRow&)>& onRow);
+
+    void parse(std::istream& is);
+    bool foundRows() const noexcept;
+
+    static std::vector<JsonRowSpan> findRows(std::string_view text);
+    static std::vector<JsonRowSpan> splitRows(std::string_view text, std::size_t chunks, unsigned int threads);
+
+    bool null() override;
+    bool boolean(bool val) override;
+    bool number_integer(number_integer_t val) override;
+    bool number_unsigned(number_unsigned_t val) override;
+    bool number_float(number_float_t val, const string_t& s) override;
+    bool string(string_t& val) override;
+    bool binary(binary_t& val) override;
+    bool start_object(std::size_t elements) override;
+    bool key(string_t& val) override;
+    bool end_object() override;
+    bool start_array(std::size_t elements) override;
+    bool end_array() override;
+    bool parse_error(std::size_t position, const std::string& last_token,
+                     const nlohmann::detail::exception& ex) override;
+};
+
+#endif // JSONSTREAM_H_
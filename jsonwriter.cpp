@@ -0,0 +1,161 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains the implementation of the JsonWriter class.
+*/
+
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "lib_json.hpp"
+#include "jsonwriter.h"
+
+//how much text is collected before it is written to the stream
+const std::size_t JsonWriter::BUFFER_SIZE = 1 << 16;
+
+/*
+  Construct a writer for the given stream.
+
+  @param os
+    The stream to write the JSON text to
+*/
+JsonWriter::JsonWriter(std::ostream& os) : os(os), buffer() {
+    buffer.reserve(BUFFER_SIZE);
+}
+
+/*
+  Write any text still in the buffer to the stream.
+*/
+JsonWriter::~JsonWriter() {
+    flush();
+}
+
+/*
+  Write the text in the buffer to the stream.
+*/
+void JsonWriter::flush() {
+    if (!buffer.empty()) {
+        os.write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+}
+
+/*Writes the buffer to the stream once it holds a full block.*/
+void JsonWriter::flushIfFull() {
+    if (buffer.size() >= BUFFER_SIZE) {
+        flush();
+    }
+}
+
+/*
+  Write a single character as it is, e.g. a bracket or a comma.
+
+  @param c
+    The character to write
+*/
+void JsonWriter::raw(char c) {
+    buffer.push_back(c);
+    flushIfFull();
+}
+
+/*
+  Write some text as it is.
+
+  @param text
+    The text to write
+*/
+void JsonWriter::raw(std::string_view text) {
+    buffer.append(text);
+    flushIfFull();
+}
+
+/*
+  Write a string in double quotes, escaping the characters JSON requires to be
+  escaped the same way the JSON library does.
+
+  @param str
+    The string to write
+
+  @throws
+    nlohmann::json::type_error if the string is not valid UTF-8, like dump()
+*/
+void JsonWriter::string(std::string_view str) {
+    /*Names and codes are almost always plain ASCII. Anything else is left to the JSON library, which checks that it
+     * is valid UTF-8, so that the output (or error) is the same as it was when the library wrote everything.*/
+    for (auto it = str.begin(); it != str.end(); it++) {
+        if (static_cast<unsigned char>(*it) >= 0x80) {
+            raw(nlohmann::json(std::string(str)).dump());
+            return;
+        }
+    }
+
+    buffer.push_back('"');
+
+    for (auto it = str.begin(); it != str.end(); it++) {
+        const unsigned char c = *it;
+
+        switch (c) {
+            case '"':
+                buffer.append("\\\"");
+                break;
+            case '\\':
+                buffer.append("\\\\");
+                break;
+            case '\b':
+                buffer.append("\\b");
+                break;
+            case '\f':
+                buffer.append("\\f");
+                break;
+            case '\n':
+                buffer.append("\\n");
+                break;
+            case '\r':
+                buffer.append("\\r");
+                break;
+            case '\t':
+                buffer.append("\\t");
+                break;
+            default:
+                if (c < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    buffer.append(escaped);
+                } else {
+                    buffer.push_back(c);
+                }
+        }
+    }
+
+    buffer.push_back('"');
+    flushIfFull();
+}
+
+/*
+  Write a floating point number. The JSON library's own conversion is used
+  rather than std::to_chars, as the two do not always pick the same digits,
+  and a number always has a decimal point or exponent, like dump() writes it.
+  Infinity and NaN can not be represented in JSON, and are written as null.
+
+  @param value
+    The number to write
+*/
+void JsonWriter::number(double value) {
+    if (!std::isfinite(value)) {
+        buffer.append("null");
+    } else {
+        std::array<char, 64> digits;
+        char* end = nlohmann::detail::to_chars(digits.data(), digits.data() + digits.size(), value);
+        buffer.append(digits.data(), end - digits.data());
+    }
+
+    flushIfFull();
+}
@@ -0,0 +1,53 @@
+#ifndef JSONWRITER_H_
+#define JSONWRITER_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains the declaration of the JsonWriter class, which writes
+  JSON text straight to an output stream.
+ */
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+/*
+  A JsonWriter collects JSON text in a buffer and writes it to an output
+  stream in large blocks. It knows nothing about the structure of the
+  document: the Areas, Area and Measure classes write their own brackets,
+  commas and colons with raw(), and use string() and number() for their
+  contents, so no JSON object is built in memory for them.
+
+  Strings and numbers are written exactly as the JSON library's dump() writes
+  them, so the output is the same as dumping a json object of the same data.
+*/
+class JsonWriter {
+private:
+    std::ostream& os;
+    std::string buffer;
+
+    static const std::size_t BUFFER_SIZE;
+
+    void flushIfFull();
+
+public:
+    JsonWriter(std::ostream& os);
+    ~JsonWriter();
+
+    JsonWriter(const JsonWriter& other) = delete;
+    JsonWriter& operator=(const JsonWriter& other) = delete;
+
+    void raw(char c);
+    void raw(std::string_view text);
+    void string(std::string_view str);
+    void number(double value);
+    void flush();
+};
+
+#endif // JSONWRITER_H_
@@ -20,10 +20,16 @@
 #include <map>
 #include <algorithm>
 #include <cmath>
+#include <charconv>
+#include <string_view>
+#include <utility>
 
 #include "lib_json.hpp"
 #include "measure.h"
 #include "bethyw.h"
+#include "jsonwriter.h"
+#include "intern.h"
+#include "stats.h"
 
 /*
   An alias for the imported JSON parsing library.
@@ -41,9 +47,49 @@ using json = nlohmann::json;
 
   @param label
     Human-readable (i.e. nice/explanatory) label for the measure.
+
+  @param alloc
+    The allocator of the values, e.g. one using the arena of the Areas object
+    the measure is stored in (see areas.h); the default one if not given
+*/
+Measure::Measure(const std::string& codename, const std::string& label, const allocator_type& alloc) :
+        code(BethYw::Intern::intern(BethYw::toLower(codename))),
+        label(BethYw::Intern::intern(label)),
+        values(alloc) {
+
+}
+
+/*
+  Construct a copy of a Measure whose values are allocated with the given
+  allocator. Containers that use a polymorphic allocator call this to copy a
+  Measure into their own memory.
+
+  @param other
+    The Measure to copy
+
+  @param alloc
+    The allocator of the values of the copy
 */
-Measure::Measure(const std::string& codename, const std::string& label) : code(BethYw::toLower(codename)),
-                                                                          label(label) {
+Measure::Measure(const Measure& other, const allocator_type& alloc) : code(other.code),
+                                                                      label(other.label),
+                                                                      values(other.values, alloc) {
+
+}
+
+/*
+  Construct a Measure from another one whose values are allocated with the
+  given allocator. The values are taken over if the other Measure uses the
+  same allocator, and copied otherwise.
+
+  @param other
+    The Measure to move from, which is left without values
+
+  @param alloc
+    The allocator of the values of the new Measure
+*/
+Measure::Measure(Measure&& other, const allocator_type& alloc) : code(other.code),
+                                                                 label(other.label),
+                                                                 values(std::move(other.values), alloc) {
 
 }
 
@@ -56,7 +102,7 @@ Measure::Measure(const std::string& codename, const std::string& label) : code(B
     The codename for the Measure.
 */
 const std::string& Measure::getCodename() const noexcept {
-    return code;
+    return BethYw::Intern::lookup(code);
 }
 
 /*
@@ -68,7 +114,7 @@ const std::string& Measure::getCodename() const noexcept {
     The human-friendly label for the Measure.
 */
 const std::string& Measure::getLabel() const noexcept {
-    return label;
+    return BethYw::Intern::lookup(label);
 }
 
 /*
@@ -78,7 +124,7 @@ const std::string& Measure::getLabel() const noexcept {
     The new label for the Measure.
 */
 void Measure::setLabel(const std::string& newLabel) noexcept {
-    label = newLabel;
+    label = BethYw::Intern::intern(newLabel);
 }
 
 /*
@@ -98,11 +144,13 @@ void Measure::setLabel(const std::string& newLabel) noexcept {
     The value.
 */
 double Measure::getValue(int year) const {
-    try {
-        return values.at(year);
-    } catch (const std::out_of_range& ex) {
+    const double* value = values.find(year);
+
+    if (value == nullptr) {
         throw std::out_of_range(std::string("No value found for year ") + std::to_string(year));
     }
+
+    return *value;
 }
 
 /*
@@ -110,13 +158,22 @@ double Measure::getValue(int year) const {
   exists for the year, replace it.
 
   @param key
-    The year to insert a value at
+    The year to insert a value at, of up to 4 digits
 
   @param value
     The value for the given year.
+
+  @throws
+    std::out_of_range if the year has more than 4 digits, with the message
+    Invalid year <year>
 */
-void Measure::setValue(const unsigned int& year, const double& value) noexcept {
-    values[year] = value;
+void Measure::setValue(const unsigned int& year, const double& value) {
+    //checked before the conversion to int, which would wrap years above INT_MAX around to negative ones
+    if (year > static_cast<unsigned int>(YearSeries::MAX_YEAR)) {
+        throw std::out_of_range(std::string("Invalid year ") + std::to_string(year));
+    }
+
+    values.set(static_cast<int>(year), value);
 }
 
 /*
@@ -142,8 +199,8 @@ int Measure::size() const noexcept {
 */
 double Measure::getDifference() const noexcept {
     if (!values.empty()) {
-        double firstValue = values.begin()->second;
-        double secondValue = values.rbegin()->second;
+        double firstValue = values.front();
+        double secondValue = values.back();
 
         return secondValue - firstValue;
     } else {
@@ -162,9 +219,10 @@ double Measure::getDifference() const noexcept {
 */
 double Measure::getDifferenceAsPercentage() const noexcept {
     if (!values.empty()) {
-        double firstValue = values.begin()->second;
+        double firstValue = values.front();
+        double secondValue = values.back();
 
-        return (getDifference() / firstValue) * 100;
+        return ((secondValue - firstValue) / firstValue) * 100;
     } else {
         return 0;
     }
@@ -175,18 +233,16 @@ double Measure::getDifferenceAsPercentage() const noexcept {
   callable from a constant context and must promise to not change the state of 
   the instance or throw an exception.
 
+  The sum and the number of values are kept up to date by the YearSeries as
+  values are set and merged, so like the two functions above, this takes the
+  same time however many years the measure has.
+
   @return
     The average value for all the years, or 0 if it cannot be calculated.
 */
 double Measure::getAverage() const noexcept {
     if (!values.empty()) {
-        double sum = 0;
-
-        for (auto it = values.begin(); it != values.end(); it++) {
-            sum += it->second;
-        }
-
-        double average = sum / values.size();
+        double average = values.sum() / values.size();
         return average;
     } else {
         return 0;
@@ -220,122 +276,169 @@ double Measure::getAverage() const noexcept {
     Reference to the output stream
 */
 std::ostream& operator<<(std::ostream& stream, const Measure& measure) {
-    stream << measure.getLabel() << " (" << measure.getCodename() << ") " << std::endl;
-
-    for (auto it = measure.values.begin(); it != measure.values.end(); it++) {
-        stream << Measure::formatYear(it->first, Measure::getValueWidth(it->second));
-    }
+    measure.writeTable(stream, nullptr);
+    return stream;
+}
 
-    /*We get these values now because we need them to calculate the width for the formatted heading.*/
-    double average = measure.getAverage();
-    double difference = measure.getDifference();
-    double differencePercentage = measure.getDifferenceAsPercentage();
-
-    /*I chose to make a variable for the heading string so I could pass it in as
-     * a reference to the format function, which is not possible for literal strings.*/
-    std::string heading = "Average";
-    stream << Measure::formatHeading(heading, Measure::getValueWidth(average));
-    heading = "Diff.";
-    stream << Measure::formatHeading(heading, Measure::getValueWidth(difference));
-    heading = "% Diff.";
-    stream << Measure::formatHeading(heading, Measure::getValueWidth(differencePercentage));
-    stream << std::endl;
-
-    for (auto it = measure.values.begin(); it != measure.values.end(); it++) {
-        stream << Measure::formatValue(it->second, Measure::getValueWidth(it->second));
-    }
+/*
+  Write the Measure as a table like the << operator does, optionally with
+  more columns at the end for its statistics (see stats.h): the smallest and
+  largest values, the variance and standard deviation, the compound annual
+  growth rate as a percentage, and the slope of the trend line.
 
-    stream << Measure::formatValue(average, Measure::getValueWidth(average));
-    stream << Measure::formatValue(difference, Measure::getValueWidth(difference));
-    stream << Measure::formatValue(differencePercentage, Measure::getValueWidth(differencePercentage));
-    stream << std::endl;
+  @param stream
+    The output stream to write to
 
-    return stream;
+  @param stats
+    The statistics of this Measure, or nullptr to only write the three
+    columns the << operator writes
+*/
+void Measure::writeTable(std::ostream& stream, const MeasureStats* stats) const {
+    writeTable(stream, stats, getLabel());
 }
 
-/*Formats the given year as a left aligned integer.*/
-std::string Measure::formatYear(int year, int formatWidth) {
-    //add 2 to account for space after and end of string character
-    std::vector<char> buffer = std::vector<char>(formatWidth + 2);
+/*
+  Write the Measure as a table like writeTable() above, but headed with the
+  given label instead of its own, e.g. to describe how its values were
+  worked out without changing (and interning) its label.
 
-    /*using string stream instead of making a stream directly with concatenation as
-     * in C++ you can not concatenate ints, doubles and C-style strings with strings
-     * and I have to make some explicit conversions.*/
-    std::stringstream formatStream;
-    formatStream << "%" << formatWidth << "d ";
+  @param stream
+    The output stream to write to
 
-    if (snprintf(buffer.data(), formatWidth + 2, formatStream.str().c_str(), year) < 0) {
+  @param stats
+    The statistics of this Measure, or nullptr to leave them out
 
-        throw std::ios_base::failure(std::string("Formatting year string failed for ") + std::to_string(year));
+  @param label
+    The label to write at the head of the table
+*/
+void Measure::writeTable(std::ostream& stream, const MeasureStats* stats, std::string_view label) const {
+    /*The whole table is built in one buffer and written to the stream at once. The buffer is kept between calls, so
+     * once it has grown to the size of a table, printing more tables does not allocate.*/
+    thread_local std::string table;
+    table.clear();
+
+    table.append(label);
+    table.append(" (");
+    table.append(getCodename());
+    table.append(") \n");
+
+    for (auto it = values.begin(); it != values.end(); it++) {
+        formatYear(table, it->first, getValueWidth(it->second));
     }
 
-    return std::string(buffer.data());
-}
-
-/*Formats the given value as a left aligned floating point number with the given width and 6 digits after the
- * decimal point.*/
-std::string Measure::formatValue(double value, int formatWidth) {
-    //add 2 to account for space after and end of string character
-    std::vector<char> buffer = std::vector<char>(formatWidth + 2);
+    /*We get these values now because we need them to calculate the width for the formatted heading.*/
+    double average = getAverage();
+    double difference = getDifference();
+    double differencePercentage = getDifferenceAsPercentage();
+
+    formatHeading(table, "Average", getValueWidth(average));
+    formatHeading(table, "Diff.", getValueWidth(difference));
+    formatHeading(table, "% Diff.", getValueWidth(differencePercentage));
+
+    const std::string_view statsHeadings[] = {"Min", "Max", "Variance", "Std Dev", "% Growth", "Slope"};
+    double statsValues[] = {0, 0, 0, 0, 0, 0};
+    const int numStats = stats == nullptr ? 0 : sizeof(statsValues) / sizeof(statsValues[0]);
+    if (stats != nullptr) {
+        statsValues[0] = stats->min;
+        statsValues[1] = stats->max;
+        statsValues[2] = stats->variance;
+        statsValues[3] = stats->standardDeviation;
+        statsValues[4] = stats->growth;
+        statsValues[5] = stats->slope;
+    }
 
-    /*using string stream instead of making a stream directly with concatenation as
-     * in C++ you can not concatenate ints, doubles and C-style strings with strings
-     * and I have to make some explicit conversions.*/
-    std::stringstream formatStream;
-    formatStream << "%" << formatWidth << ".6f ";
+    for (int i = 0; i < numStats; i++) {
+        formatHeading(table, statsHeadings[i], getValueWidth(statsValues[i]));
+    }
+    table.push_back('\n');
 
-    if (snprintf(buffer.data(), formatWidth + 2, formatStream.str().c_str(), value) < 0) {
+    for (auto it = values.begin(); it != values.end(); it++) {
+        formatValue(table, it->second, getValueWidth(it->second));
+    }
 
-        throw std::ios_base::failure(std::string("Formatting value string failed for ") +
-                                     std::to_string(value));
+    formatValue(table, average, getValueWidth(average));
+    formatValue(table, difference, getValueWidth(difference));
+    formatValue(table, differencePercentage, getValueWidth(differencePercentage));
+    for (int i = 0; i < numStats; i++) {
+        formatValue(table, statsValues[i], getValueWidth(statsValues[i]));
     }
+    table.push_back('\n');
 
-    return std::string(buffer.data());
+    stream.write(table.data(), table.size());
 }
 
-/*Formats the given heading as a left aligned string with the given width.*/
-std::string Measure::formatHeading(std::string& heading, int formatWidth) {
-    //add 2 to account for space after and end of string character
-    std::vector<char> buffer = std::vector<char>(formatWidth + 2);
+/*Appends the given text right aligned in a column of the given width, followed by a space. Like snprintf with a
+ * format of "%<width>s " and a buffer of width + 2 characters did, text longer than the column is cut to width + 1
+ * characters, so the space after it is lost first.*/
+void Measure::formatCell(std::string& out, std::string_view text, int formatWidth) {
+    const size_t width = formatWidth;
 
-    /*using string stream instead of making a stream directly with concatenation as
-     * in C++ you can not concatenate ints, doubles and C-style strings with strings
-     * String width is incremented by to account for space after.*/
-    std::stringstream formatStream;
-    formatStream << "%" << formatWidth << "s ";
+    if (text.size() > width) {
+        out.append(text.substr(0, width + 1));
+    } else {
+        out.append(width - text.size(), ' ');
+        out.append(text);
+        out.push_back(' ');
+    }
+}
 
-    if (snprintf(buffer.data(), formatWidth + 2, formatStream.str().c_str(), heading.c_str()) < 0) {
+/*Appends the given year as a right aligned integer.*/
+void Measure::formatYear(std::string& out, int year, int formatWidth) {
+    char buffer[16];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), year);
 
-        throw std::ios_base::failure("Formatting string failed");
-    }
+    Measure::formatCell(out, std::string_view(buffer, result.ptr - buffer), formatWidth);
+}
+
+/*Appends the given value as a right aligned floating point number with 6 digits after the decimal point. to_chars
+ * with a precision gives exactly the digits printf's "%.6f" does, including for infinity and NaN.*/
+void Measure::formatValue(std::string& out, double value, int formatWidth) {
+    //the largest double has 309 digits before the decimal point
+    char buffer[330];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed, 6);
+
+    Measure::formatCell(out, std::string_view(buffer, result.ptr - buffer), formatWidth);
+}
 
-    return std::string(buffer.data());
+/*Appends the given heading right aligned.*/
+void Measure::formatHeading(std::string& out, std::string_view heading, int formatWidth) {
+    Measure::formatCell(out, heading, formatWidth);
 }
 
 /*Calculates the width of a double. By width, we mean the number of characters needed
  * to print this double value as a real number with 6 digits after the decimal point.*/
 int Measure::getValueWidth(double value) noexcept {
-    int digitsBeforeDecimalPoint = 0;
-
-    /*If value is 1 or larger, we can use log base 10 to calculate its width.*/
-    if (value >= 1) {
-        //log base 10 of 10 is 1, so we add 1 to get 2 digits
-        digitsBeforeDecimalPoint = log10(value) + 1;
+    /*Infinity used to get a width from log10 that could not be converted to an int. It is now given the same width
+     * as NaN, which both print as 3 or 4 letters.*/
+    if (!std::isfinite(value)) {
+        return 9;
+    }
 
-    /*If max is -1 or larger, we can use log base 10 to calculate its width,
-     * but after we get its positive counterpart. We will add 1 to the width
-     * to account for the minus sign before the number.*/
-    } else if (value <= -1) {
-        /*here we add 2 to also account for the minus sign*/
-        digitsBeforeDecimalPoint = log10(-value) + 2;
+    double magnitude = std::fabs(value);
+    int digitsBeforeDecimalPoint = 0;
 
-    //if max is between -1 and 1, before the decimal point it just has the digit 0
+    if (magnitude < 1) {
+        //negative values need one more character for the minus sign, but negative zero was always counted as 0
+        digitsBeforeDecimalPoint = value < 0 ? 2 : 1;
     } else {
-        if(value >= 0) {
-            digitsBeforeDecimalPoint = 1;
+        /*The number of digits used to be worked out with log10, which rounds up for values just below a power of
+         * ten, and can not be replaced by counting the digits of the integer part for values beyond 2^53. To keep
+         * the exact same widths, the same log10 calculation is still done for those values, and digits are counted
+         * for all others.*/
+        static const double POWERS_OF_TEN[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12,
+                                               1e13, 1e14, 1e15};
+        const int maxDigits = sizeof(POWERS_OF_TEN) / sizeof(POWERS_OF_TEN[0]) - 1;
+
+        int digits = 1;
+        while (digits < maxDigits && magnitude >= POWERS_OF_TEN[digits]) {
+            digits++;
+        }
+
+        if (magnitude >= POWERS_OF_TEN[maxDigits] || POWERS_OF_TEN[digits] - magnitude < POWERS_OF_TEN[digits] * 1e-12) {
+            //here we add 2 to also account for the minus sign
+            digitsBeforeDecimalPoint = value < 0 ? log10(magnitude) + 2 : log10(magnitude) + 1;
         } else {
-            // if value is negative, we need to add 1 more to account for minus sign
-            digitsBeforeDecimalPoint = 2;
+            digitsBeforeDecimalPoint = value < 0 ? digits + 1 : digits;
         }
     }
 
@@ -377,13 +480,31 @@ bool operator==(const Measure& lhs, const Measure& rhs) {
     reference to ths measure
 */
 Measure& Measure::operator=(const Measure& other) {
-    for (auto it = other.values.begin(); it != other.values.end(); it++) {
-        values[it->first] = it->second;
-    }
+    values.merge(other.values);
 
     return *this;
 }
 
+/*
+  Merge another Measure into this one, with the same result as the copy
+  assignment operator above, but taking over the values of the other Measure
+  instead of copying them when this Measure has none yet.
+
+  @param other
+    The Measure to merge into this one, which is left in a valid but
+    unspecified state
+
+  @return
+    void
+*/
+void Measure::mergeFrom(Measure&& other) {
+    if (values.empty()) {
+        values = std::move(other.values);
+    } else {
+        *this = other;
+    }
+}
+
 /*Function that converts this to json and saves it in the given json object. It is specified in the documentation of
  * the nlohmann::json library.*/
 void to_json(json& j, const Measure& measure) {
@@ -398,3 +519,62 @@ void to_json(json& j, const Measure& measure) {
     j = json(stringMap);
 }
 
+
+
+/*Writes the digits of the given year into the buffer, which must have room for any int, and returns them.*/
+static std::string_view yearDigits(char (&buffer)[16], int year) noexcept {
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), year);
+    return std::string_view(buffer, result.ptr - buffer);
+}
+
+/*
+  Write this Measure as JSON, the same way to_json() and dump() would write it:
+  an object with the years (as strings) as keys and the values as values.
+
+  The keys of a JSON object are ordered as strings, which for years that all
+  have the same number of digits is the same as their order as numbers, so the
+  values can be written straight from the container. Otherwise they are
+  sorted as strings first. Either way the years are written with to_chars
+  into a buffer on the stack, so no string is allocated for them.
+
+  @param out
+    The writer to write the JSON to
+*/
+void Measure::writeJSON(JsonWriter& out) const {
+    char buffer[16];
+    char otherBuffer[16];
+
+    out.raw('{');
+
+    if (values.empty() || yearDigits(buffer, values.firstYear()).size() ==
+                          yearDigits(otherBuffer, values.lastYear()).size()) {
+        for (auto it = values.begin(); it != values.end(); it++) {
+            if (it != values.begin()) {
+                out.raw(',');
+            }
+
+            out.raw('"');
+            out.raw(yearDigits(buffer, it->first));
+            out.raw("\":");
+            out.number(it->second);
+        }
+    } else {
+        std::vector<std::pair<int, double>> sorted(values.begin(), values.end());
+        std::sort(sorted.begin(), sorted.end(), [&](const auto& lhs, const auto& rhs) {
+            return yearDigits(buffer, lhs.first) < yearDigits(otherBuffer, rhs.first);
+        });
+
+        for (auto it = sorted.begin(); it != sorted.end(); it++) {
+            if (it != sorted.begin()) {
+                out.raw(',');
+            }
+
+            out.raw('"');
+            out.raw(yearDigits(buffer, it->first));
+            out.raw("\":");
+            out.number(it->second);
+        }
+    }
+
+    out.raw('}');
+}
\ No newline at end of file
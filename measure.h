@@ -13,12 +13,18 @@
 
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <cstdio>
 #include <iostream>
-#include <map>
+#include <memory_resource>
 
 #include "lib_json.hpp"
+#include "intern.h"
+#include "yearseries.h"
+#include "jsonwriter.h"
+
+struct MeasureStats;
 
 /*
   The Measure class contains a measure code, label, and a container for readings
@@ -26,28 +32,38 @@
 */
 class Measure {
 private:
-    const std::string code;
-    std::string label;
-    /*Chose map as the container as it has logarithmic complexity for accessing
-     * and inserting elements, and because it is ordered and thus I can iterate
-     * over the years in ascending order automatically.*/
-    std::map<int, double> values;
+    /*The code and label are the same for a measure in every area, so only
+     * their IDs in the intern table are kept here (see intern.h).*/
+    const BethYw::Intern::Id code;
+    BethYw::Intern::Id label;
+    /*The years of a measure are a small contiguous range, so the values are
+     * kept in an array indexed by year (see yearseries.h), which is smaller
+     * than a map and still iterates over the years in ascending order.*/
+    YearSeries values;
 
     //these ones are used to format the string output of the measure object
-    static std::string formatYear(int year, int formatWidth);
-    static std::string formatValue(double value, int formatWidth);
-    static std::string formatHeading(std::string& heading, int formatWidth);
+    static void formatCell(std::string& out, std::string_view text, int formatWidth);
+    static void formatYear(std::string& out, int year, int formatWidth);
+    static void formatValue(std::string& out, double value, int formatWidth);
+    static void formatHeading(std::string& out, std::string_view heading, int formatWidth);
     static int getValueWidth(double value) noexcept;
 
 public:
-    Measure(const std::string& code, const std::string& label);
+    //the allocator of the values, which containers of Measure objects pass on to them
+    using allocator_type = YearSeries::allocator_type;
+
+    Measure(const std::string& code, const std::string& label, const allocator_type& alloc = allocator_type());
+    Measure(const Measure& other) = default;
+    Measure(const Measure& other, const allocator_type& alloc);
+    Measure(Measure&& other) = default;
+    Measure(Measure&& other, const allocator_type& alloc);
 
     const std::string& getCodename() const noexcept;
     const std::string& getLabel() const noexcept;
     void setLabel(const std::string& newLabel) noexcept;
 
     double getValue(int year) const;
-    void setValue(const unsigned int& year, const double& value) noexcept;
+    void setValue(const unsigned int& year, const double& value);
 
     int size() const noexcept;
     double getDifference() const noexcept;
@@ -55,11 +71,20 @@ public:
     double getAverage() const noexcept;
 
     friend std::ostream& operator<<(std::ostream& stream, const Measure& measure);
+    void writeTable(std::ostream& stream, const MeasureStats* stats) const;
+    void writeTable(std::ostream& stream, const MeasureStats* stats, std::string_view label) const;
     friend bool operator==(const Measure& lhs, const Measure& rhs);
 
     Measure& operator=(const Measure& other);
+    void mergeFrom(Measure&& other);
 
     friend void to_json(nlohmann::json& j, const Measure& measure);
+    void writeJSON(JsonWriter& out) const;
+
+    friend class Areas;
+    friend class Snapshot;
+    friend class StatsTable;
+    friend class QueryIndex;
 };
 
 #endif // MEASURE_H_
\ No newline at end of file
@@ -0,0 +1,97 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains the implementation of the functions that convert the text
+  of the datasets to numbers.
+
+  They are built on std::from_chars, which does not depend on the locale,
+  does not allocate, and both checks and converts the text in a single pass,
+  unlike checking it with strtod() and converting it again with std::stod().
+*/
+
+#include <charconv>
+#include <string_view>
+#include <system_error>
+
+#include "numbers.h"
+
+/*
+  Convert text to a real number. The whole text must be a number, without
+  leading or trailing spaces.
+
+  @param text
+    The text to convert, e.g. a CSV field or a JSON string
+
+  @param value
+    Set to the number if the conversion succeeded
+
+  @return
+    true if the text is a real number, false otherwise
+
+  @example
+    double value;
+    BethYw::toDouble("12.5", value); // true, value is 12.5
+    BethYw::toDouble("12.5 ", value); // false
+*/
+bool BethYw::toDouble(std::string_view text, double& value) noexcept {
+    double number;
+    const char* end = text.data() + text.size();
+    std::from_chars_result result = std::from_chars(text.data(), end, number);
+
+    if (text.empty() || result.ec != std::errc() || result.ptr != end) {
+        return false;
+    }
+
+    value = number;
+    return true;
+}
+
+/*
+  Convert text to a year, which must be a whole number with 4 digits (i.e.
+  from 1000 to 9999). Leading zeros are allowed.
+
+  @param text
+    The text to convert, e.g. a CSV heading or a JSON string
+
+  @param year
+    Set to the year if the conversion succeeded
+
+  @return
+    true if the text is a 4 digit year, false otherwise
+
+  @example
+    unsigned int year;
+    BethYw::toYear("2015", year); // true, year is 2015
+    BethYw::toYear("215", year); // false
+*/
+bool BethYw::toYear(std::string_view text, unsigned int& year) noexcept {
+    //nearly every year is exactly 4 digits, which we convert without the general loop of from_chars
+    if (text.size() == 4) {
+        unsigned int digits[4];
+        for (int i = 0; i < 4; i++) {
+            digits[i] = static_cast<unsigned int>(text[i]) - '0';
+        }
+
+        if (digits[0] > 9 || digits[1] > 9 || digits[2] > 9 || digits[3] > 9 || digits[0] == 0) {
+            return false;
+        }
+
+        year = digits[0] * 1000 + digits[1] * 100 + digits[2] * 10 + digits[3];
+        return true;
+    }
+
+    unsigned int value;
+    const char* end = text.data() + text.size();
+    std::from_chars_result result = std::from_chars(text.data(), end, value);
+
+    if (text.empty() || result.ec != std::errc() || result.ptr != end || value < 1000 || value > 9999) {
+        return false;
+    }
+
+    year = value;
+    return true;
+}
@@ -0,0 +1,25 @@
+#ifndef NUMBERS_H_
+#define NUMBERS_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains the declarations of the functions that convert the text
+  of the datasets to numbers. Every populate function of Areas goes through
+  them, so all datasets accept exactly the same numbers.
+ */
+
+#include <string_view>
+
+namespace BethYw {
+
+    bool toDouble(std::string_view text, double& value) noexcept;
+    bool toYear(std::string_view text, unsigned int& year) noexcept;
+
+} // namespace BethYw
+
+#endif // NUMBERS_H_
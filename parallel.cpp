@@ -0,0 +1,133 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains the implementation of the helper functions for running
+  work on several threads. The pool of threads only lives for one call of
+  parallelFor(), as the work we give it (loading datasets) happens once per
+  run of the program and takes much longer than starting a thread.
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "parallel.h"
+#include "profile.h"
+
+/*
+  Work out how many threads to use for a number of tasks. There is no point in
+  having more threads than tasks, and asking for 0 threads means one thread
+  per core of the machine.
+
+  @param tasks
+    The number of independent tasks to run
+
+  @param requestedThreads
+    The number of threads asked for, or 0 to use the number of cores
+
+  @return
+    The number of threads to use, which is at least 1
+*/
+unsigned int BethYw::threadsFor(std::size_t tasks, unsigned int requestedThreads) noexcept {
+    unsigned int threads = requestedThreads;
+
+    if (threads == 0) {
+        //hardware_concurrency() is allowed to return 0 if it can not tell
+        threads = std::thread::hardware_concurrency();
+    }
+
+    if (threads > tasks) {
+        threads = tasks;
+    }
+
+    return threads > 0 ? threads : 1;
+}
+
+/*
+  Call a function once for every index from 0 to count - 1, spread over a
+  number of worker threads. Each worker takes the next index that has not
+  been started yet until there are none left, so the order in which tasks
+  finish is not defined and tasks must not depend on each other.
+
+  The tasks count towards the profiling phase of the calling thread (see
+  profile.h) whichever thread runs them. Each of the other threads counts in
+  a phase of its own, which is added to that phase once they have finished,
+  so no two threads add to the same counters.
+
+  If one or more tasks throw an exception, all the other tasks are still run,
+  and the exception of the task with the lowest index is rethrown once every
+  thread has finished. This is the same exception a loop running the tasks in
+  order would have stopped at.
+
+  @param count
+    The number of tasks to run
+
+  @param threads
+    The number of threads to run them on. With 1 thread the tasks are run in
+    order on the calling thread.
+
+  @param task
+    The function to call with the index of each task
+
+  @throws
+    Any exception thrown by a task
+*/
+void BethYw::parallelFor(std::size_t count, unsigned int threads, const std::function<void(std::size_t)>& task) {
+    if (threads <= 1 || count <= 1) {
+        for (std::size_t i = 0; i < count; i++) {
+            task(i);
+        }
+        return;
+    }
+
+    std::vector<std::exception_ptr> errors(count);
+    std::atomic<std::size_t> nextTask(0);
+
+    auto worker = [&]() {
+        for (std::size_t i = nextTask++; i < count; i = nextTask++) {
+            try {
+                task(i);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        }
+    };
+
+    Profile::Phase* const phase = Profile::current;
+    std::vector<Profile::Phase> counts(threads - 1, Profile::Phase{"", phase == nullptr ? 0 : phase->depth,
+                                                                   0, 0, 0, 0, 0});
+
+    //the calling thread does its share of the work instead of just waiting for the others
+    std::vector<std::thread> pool;
+    for (unsigned int i = 1; i < threads; i++) {
+        Profile::Phase* const threadCounts = phase == nullptr ? nullptr : &counts[i - 1];
+        pool.emplace_back([&worker, threadCounts]() {
+            Profile::Scope scope(threadCounts);
+            worker();
+        });
+    }
+    worker();
+
+    for (auto it = pool.begin(); it != pool.end(); it++) {
+        it->join();
+    }
+
+    if (phase != nullptr) {
+        for (auto it = counts.begin(); it != counts.end(); it++) {
+            Profile::addCounts(*phase, *it);
+        }
+    }
+
+    for (auto it = errors.begin(); it != errors.end(); it++) {
+        if (*it) {
+            std::rethrow_exception(*it);
+        }
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef PARALLEL_H_
+#define PARALLEL_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains declarations for the helper functions used to spread
+  independent pieces of work, such as parsing different dataset files, over
+  several threads.
+ */
+
+#include <cstddef>
+#include <functional>
+
+namespace BethYw {
+
+    /*
+      Work out how many threads to use for a number of tasks, given the
+      number of threads asked for by the user (0 meaning one per core).
+    */
+    unsigned int threadsFor(std::size_t tasks, unsigned int requestedThreads) noexcept;
+
+    /*
+      Call task(i) for every i in [0, count) on a pool of worker threads, and
+      wait for all of them to finish.
+    */
+    void parallelFor(std::size_t count, unsigned int threads, const std::function<void(std::size_t)>& task);
+
+} // namespace BethYw
+
+#endif // PARALLEL_H_
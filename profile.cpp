@@ -0,0 +1,251 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains the implementation of the profiling timers and counters,
+  and the replacement of the global operator new that counts allocations.
+*/
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "lib_json.hpp"
+#include "profile.h"
+
+thread_local BethYw::Profile::Phase* BethYw::Profile::current = nullptr;
+
+static std::atomic<bool> enabled(false);
+
+/*A deque rather than a vector, so that phases never move in memory while other threads hold pointers to them.*/
+static std::mutex phasesMutex;
+static std::deque<BethYw::Profile::Phase> phases;
+
+/*
+  Turn profiling on. Only phases added after this are reported.
+*/
+void BethYw::Profile::enable() noexcept {
+    enabled = true;
+}
+
+/*
+  Check if profiling is on.
+
+  @return
+    true if enable() was called
+*/
+bool BethYw::Profile::isEnabled() noexcept {
+    return enabled;
+}
+
+BethYw::Profile::Phase* BethYw::Profile::addPhase(const std::string& name) {
+    if (!enabled) {
+        return nullptr;
+    }
+
+    int depth = current == nullptr ? 0 : current->depth + 1;
+
+    std::lock_guard<std::mutex> lock(phasesMutex);
+    phases.push_back(Phase{name, depth, 0, 0, 0, 0, 0});
+    return &phases.back();
+}
+
+/*
+  Add the counters of one phase to those of another, e.g. those counted by
+  another thread for the phase of this one.
+
+  @param phase
+    The phase to add the counters to
+
+  @param counts
+    The phase whose counters are added
+*/
+void BethYw::Profile::addCounts(Phase& phase, const Phase& counts) noexcept {
+    phase.rowsParsed += counts.rowsParsed;
+    phase.rowsFilteredOut += counts.rowsFilteredOut;
+    phase.bytesRead += counts.bytesRead;
+    phase.allocations += counts.allocations;
+}
+
+/*
+  Start timing the given phase, which becomes the current phase of this thread.
+
+  @param phase
+    The phase from addPhase(), or null to not time anything
+
+  @param start
+    When the phase started, which is now unless it started before profiling
+    was turned on
+*/
+BethYw::Profile::Scope::Scope(Phase* phase, Clock::time_point start) noexcept : phase(phase),
+                                                                               previous(current),
+                                                                               start(start) {
+    if (phase != nullptr) {
+        current = phase;
+    }
+}
+
+/*
+  Add a phase with the given name, nested in the current phase, and start
+  timing it.
+
+  @param name
+    The name of the phase in the report
+
+  @param start
+    When the phase started, which is now unless it started before profiling
+    was turned on
+*/
+BethYw::Profile::Scope::Scope(const std::string& name, Clock::time_point start) : Scope(addPhase(name), start) {
+
+}
+
+BethYw::Profile::Scope::~Scope() {
+    stop();
+}
+
+/*
+  Stop timing the phase, and make the phase that was current before it current
+  again. Does nothing if the phase was already stopped.
+*/
+void BethYw::Profile::Scope::stop() noexcept {
+    if (phase != nullptr) {
+        phase->seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        current = previous;
+        phase = nullptr;
+    }
+}
+
+/*
+  Write the time and counters of every phase, in the order the phases were
+  added, either as a table or as JSON. The counters of a phase include those
+  of the phases nested in it.
+
+  @param os
+    The stream to write the report to
+
+  @param asJSON
+    true to write the report as JSON, false to write a table
+*/
+void BethYw::Profile::report(std::ostream& os, bool asJSON) {
+    std::lock_guard<std::mutex> lock(phasesMutex);
+
+    std::vector<Phase> inclusive(phases.begin(), phases.end());
+    for (size_t i = 0; i < inclusive.size(); i++) {
+        for (size_t j = i + 1; j < phases.size() && phases[j].depth > phases[i].depth; j++) {
+            addCounts(inclusive[i], phases[j]);
+        }
+    }
+
+    double totalSeconds = 0;
+    for (auto it = inclusive.begin(); it != inclusive.end(); it++) {
+        if (it->depth == 0) {
+            totalSeconds += it->seconds;
+        }
+    }
+
+    if (asJSON) {
+        nlohmann::json j;
+        j["phases"] = nlohmann::json::array();
+
+        for (auto it = inclusive.begin(); it != inclusive.end(); it++) {
+            j["phases"].push_back({{"name", it->name},
+                                   {"depth", it->depth},
+                                   {"ms", it->seconds * 1000},
+                                   {"rowsParsed", it->rowsParsed},
+                                   {"rowsFilteredOut", it->rowsFilteredOut},
+                                   {"bytesRead", it->bytesRead},
+                                   {"allocations", it->allocations}});
+        }
+        j["totalMs"] = totalSeconds * 1000;
+
+        os << j.dump() << std::endl;
+    } else {
+        char line[256];
+        std::snprintf(line, sizeof(line), "%-24s %10s %12s %14s %14s %12s\n", "phase", "time (ms)", "rows parsed",
+                      "rows filtered", "bytes read", "allocations");
+        os << line;
+
+        for (auto it = inclusive.begin(); it != inclusive.end(); it++) {
+            std::string name = std::string(it->depth * 2, ' ') + it->name;
+            std::snprintf(line, sizeof(line), "%-24s %10.3f %12llu %14llu %14llu %12llu\n", name.c_str(),
+                          it->seconds * 1000,
+                          static_cast<unsigned long long>(it->rowsParsed),
+                          static_cast<unsigned long long>(it->rowsFilteredOut),
+                          static_cast<unsigned long long>(it->bytesRead),
+                          static_cast<unsigned long long>(it->allocations));
+            os << line;
+        }
+
+        std::snprintf(line, sizeof(line), "%-24s %10.3f\n", "total", totalSeconds * 1000);
+        os << line;
+    }
+}
+
+/*
+  The global operator new is replaced so that allocations can be counted. It
+  allocates with malloc and calls the new handler when that fails, like the
+  standard library's does, and only adds the thread-local check of the current
+  phase to it.
+*/
+void* operator new(std::size_t size) {
+    if (BethYw::Profile::current != nullptr) {
+        BethYw::Profile::current->allocations++;
+    }
+
+    if (size == 0) {
+        size = 1;
+    }
+
+    void* p;
+    while ((p = std::malloc(size)) == nullptr) {
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+
+    return p;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return operator new(size);
+    } catch (const std::bad_alloc& ex) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return operator new(size, std::nothrow);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t size) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t size) noexcept {
+    std::free(p);
+}
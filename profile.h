@@ -0,0 +1,109 @@
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains the declarations of the timers and counters used to
+  report where the program spends its time when it is run with --profile.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+namespace BethYw {
+
+namespace Profile {
+
+    using Clock = std::chrono::steady_clock;
+
+    /*
+      The time and counters of one phase of the program, e.g. loading a
+      dataset. Phases can be nested, in which case depth is the number of
+      phases they are nested in.
+    */
+    struct Phase {
+        std::string name;
+        int depth;
+        double seconds;
+        uint64_t rowsParsed;
+        uint64_t rowsFilteredOut;
+        uint64_t bytesRead;
+        uint64_t allocations;
+    };
+
+    /*
+      The phase that the code running on this thread is part of, or null when
+      profiling is off. Counters are only ever added to this phase, so a phase
+      must only be current on one thread at a time, and counting something
+      when profiling is off is a single comparison. Threads that work towards
+      the phase of another thread, like the workers of parallelFor(), count
+      in a phase of their own that is added to it with addCounts() when they
+      are done.
+    */
+    extern thread_local Phase* current;
+
+    void enable() noexcept;
+    bool isEnabled() noexcept;
+
+    /*
+      Add a phase to the report, nested in the current phase of this thread,
+      and return it, or return null if profiling is off. The phase only starts
+      when a Scope is made for it, which can be on another thread.
+    */
+    Phase* addPhase(const std::string& name);
+
+    void addCounts(Phase& phase, const Phase& counts) noexcept;
+
+    /*
+      Times a phase, and makes it the current phase of this thread, for as
+      long as the Scope exists or until stop() is called.
+    */
+    class Scope {
+    private:
+        Phase* phase;
+        Phase* previous;
+        Clock::time_point start;
+
+    public:
+        Scope(Phase* phase, Clock::time_point start = Clock::now()) noexcept;
+        Scope(const std::string& name, Clock::time_point start = Clock::now());
+        ~Scope();
+
+        Scope(const Scope& other) = delete;
+        Scope& operator=(const Scope& other) = delete;
+
+        void stop() noexcept;
+    };
+
+    inline void countRowParsed() noexcept {
+        if (current != nullptr) {
+            current->rowsParsed++;
+        }
+    }
+
+    inline void countRowFilteredOut() noexcept {
+        if (current != nullptr) {
+            current->rowsFilteredOut++;
+        }
+    }
+
+    inline void countBytesRead(uint64_t bytes) noexcept {
+        if (current != nullptr) {
+            current->bytesRead += bytes;
+        }
+    }
+
+    void report(std::ostream& os, bool asJSON);
+
+} // namespace Profile
+
+} // namespace BethYw
+
+#endif // PROFILE_H_
@@ -0,0 +1,622 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains the implementation of the QueryIndex class.
+
+  Areas are ranked by one value each, worked out from the columns of the
+  first and last years of a measure. Ranks and percentiles are then found by
+  binary search in a sorted copy of those values, so ranking every area
+  takes as long as sorting them once. --top only sorts as many areas as it
+  lists.
+*/
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "query.h"
+#include "filter.h"
+#include "intern.h"
+#include "jsonwriter.h"
+
+/*
+  Construct a Query that asks for nothing, i.e. for the imported data to be
+  output as it is.
+*/
+Query::Query() : top(0), rank(false), areas(), metric(VALUE), aggregation(NONE), percentile(50) {
+
+}
+
+/*
+  Check if any query was asked for.
+
+  @return
+    true if --top, --rank or --aggregate was given
+*/
+bool Query::any() const noexcept {
+    return top > 0 || rank || aggregation != NONE;
+}
+
+/*Formats a number with 6 digits after the decimal point, as the tables of measures do.*/
+static std::string formatNumber(double value) {
+    //the largest double has 309 digits before the decimal point
+    char buffer[330];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed, 6);
+    return std::string(buffer, result.ptr - buffer);
+}
+
+/*
+  Build the index from all the areas and measures imported. Areas keep their
+  measures in a tree and their values by year, so this is the one time they
+  are all walked; every query afterwards only reads the columns.
+
+  @param areas
+    The imported data
+
+  @example
+    QueryIndex index(areas);
+    std::vector<RankedArea> top = index.top("pop", Query::GROWTH, 10);
+*/
+QueryIndex::QueryIndex(const Areas& areas) : codes(), names(), measures() {
+    //the areas are kept in order of code, so the rows of every measure are too
+    codes.reserve(areas.areas.size());
+    names.reserve(areas.areas.size());
+
+    //the measures by the ID of their codename, with the values of every row and the last year of any of them
+    std::unordered_map<BethYw::Intern::Id, std::size_t> measureIndexes;
+    std::vector<std::vector<const YearSeries*>> series;
+    std::vector<int> lastYears;
+
+    std::size_t i = 0;
+    for (auto areaIt = areas.areas.begin(); areaIt != areas.areas.end(); areaIt++, i++) {
+        const Area& area = areaIt->second;
+        codes.push_back(&areaIt->first);
+        names.push_back(area.displayName());
+
+        for (auto it = area.measures.begin(); it != area.measures.end(); it++) {
+            auto found = measureIndexes.emplace(it->first, measures.size());
+            if (found.second) {
+                MeasureColumns columns;
+                columns.codename = BethYw::Intern::lookup(it->first);
+                columns.label = it->second.getLabel();
+                columns.firstYear = std::numeric_limits<int>::max();
+                columns.numYears = 0;
+                measures.push_back(std::move(columns));
+                series.emplace_back();
+                lastYears.push_back(std::numeric_limits<int>::min());
+            }
+
+            const std::size_t index = found.first->second;
+            const YearSeries& values = it->second.values;
+            if (!values.empty()) {
+                measures[index].firstYear = std::min(measures[index].firstYear, values.firstYear());
+                lastYears[index] = std::max(lastYears[index], values.lastYear());
+            }
+
+            measures[index].rows.push_back(static_cast<std::uint32_t>(i));
+            series[index].push_back(&values);
+        }
+    }
+
+    for (std::size_t m = 0; m < measures.size(); m++) {
+        MeasureColumns& columns = measures[m];
+        const std::size_t numRows = columns.rows.size();
+
+        if (lastYears[m] < columns.firstYear) {
+            columns.firstYear = 0;
+            continue;
+        }
+
+        columns.numYears = lastYears[m] - columns.firstYear + 1;
+        columns.values.assign(static_cast<std::size_t>(columns.numYears) * numRows,
+                              std::numeric_limits<double>::quiet_NaN());
+
+        for (std::size_t row = 0; row < numRows; row++) {
+            for (auto it = series[m][row]->begin(); it != series[m][row]->end(); it++) {
+                columns.values[(it->first - columns.firstYear) * numRows + row] = it->second;
+            }
+        }
+    }
+
+    std::sort(measures.begin(), measures.end(), [](const MeasureColumns& lhs, const MeasureColumns& rhs) {
+        return lhs.codename < rhs.codename;
+    });
+}
+
+/*Returns the values of all rows for the given year, which must be one of the years of the measure.*/
+const double* QueryIndex::MeasureColumns::column(int year) const noexcept {
+    return values.data() + static_cast<std::size_t>(year - firstYear) * rows.size();
+}
+
+/*Returns the columns of the measure with the given codename, or throws std::out_of_range if no area has it.*/
+const QueryIndex::MeasureColumns& QueryIndex::find(const std::string& codename) const {
+    auto it = std::lower_bound(measures.begin(), measures.end(), codename,
+                               [](const MeasureColumns& columns, const std::string& key) {
+                                   return columns.codename < key;
+                               });
+
+    if (it == measures.end() || it->codename != codename) {
+        throw std::out_of_range("No measure found matching " + codename);
+    }
+
+    return *it;
+}
+
+/*Returns what each row is ranked by, from the columns of the first and last years; NaN for the rows that do not have
+ * a value for those years. The percentage change is worked out like Measure::getDifferenceAsPercentage(), and is NaN
+ * too when it has no finite value, i.e. when the value of the first year is 0.*/
+std::vector<double> QueryIndex::metricOf(const MeasureColumns& columns, Query::Metric metric) {
+    const std::size_t numRows = columns.rows.size();
+    std::vector<double> result(numRows, std::numeric_limits<double>::quiet_NaN());
+
+    if (columns.numYears == 0) {
+        return result;
+    }
+
+    const double* first = columns.column(columns.firstYear);
+    const double* last = columns.column(columns.firstYear + columns.numYears - 1);
+
+    switch (metric) {
+        case Query::CHANGE:
+            for (std::size_t row = 0; row < numRows; row++) {
+                result[row] = last[row] - first[row];
+            }
+            break;
+
+        case Query::GROWTH:
+            for (std::size_t row = 0; row < numRows; row++) {
+                const double growth = ((last[row] - first[row]) / first[row]) * 100;
+                if (first[row] != 0 && std::isfinite(growth)) {
+                    result[row] = growth;
+                }
+            }
+            break;
+
+        default:
+            std::copy(last, last + numRows, result.begin());
+            break;
+    }
+
+    return result;
+}
+
+/*Returns whether each row is one of the areas of the filter, i.e. whether a string of the filter is part of the code
+ * of its area or of the name it is output with, like the areas imported are filtered (see Areas::populate()). Every
+ * row is selected if the filter is empty.*/
+std::vector<bool> QueryIndex::selectedRows(const MeasureColumns& columns,
+                                           const std::unordered_set<std::string>& areasFilter) const {
+    const FilterMatcher areasMatcher(&areasFilter, FilterMatcher::UPPER);
+    std::vector<bool> selected(columns.rows.size(), true);
+
+    if (!areasMatcher.matchesAll()) {
+        for (std::size_t row = 0; row < columns.rows.size(); row++) {
+            const std::uint32_t area = columns.rows[row];
+            selected[row] = areasMatcher.matches(*codes[area]) || areasMatcher.matches(names[area]);
+        }
+    }
+
+    return selected;
+}
+
+/*Returns the rank and percentile of the selected rows among all the rows that have a value.*/
+std::vector<RankedArea> QueryIndex::ranked(const MeasureColumns& columns, const std::vector<double>& metric,
+                                           const std::vector<std::uint32_t>& selected) const {
+    std::vector<double> sortedValues;
+    sortedValues.reserve(metric.size());
+    for (auto it = metric.begin(); it != metric.end(); it++) {
+        if (!std::isnan(*it)) {
+            sortedValues.push_back(*it);
+        }
+    }
+    std::sort(sortedValues.begin(), sortedValues.end());
+
+    const std::size_t outOf = sortedValues.size();
+    std::vector<RankedArea> result;
+    result.reserve(selected.size());
+
+    for (auto it = selected.begin(); it != selected.end(); it++) {
+        const double value = metric[*it];
+        const std::size_t below = std::lower_bound(sortedValues.begin(), sortedValues.end(), value) -
+                                  sortedValues.begin();
+        const std::size_t notAbove = std::upper_bound(sortedValues.begin(), sortedValues.end(), value) -
+                                     sortedValues.begin();
+
+        RankedArea area;
+        area.code = codes[columns.rows[*it]];
+        area.name = &names[columns.rows[*it]];
+        area.value = value;
+        area.rank = outOf - notAbove + 1;
+        area.outOf = outOf;
+        area.percentile = (below + (notAbove - below) / 2.0) / outOf * 100;
+        result.push_back(area);
+    }
+
+    return result;
+}
+
+/*
+  Retrieve the number of areas in the index.
+
+  @return
+    The number of areas imported
+*/
+std::size_t QueryIndex::numAreas() const noexcept {
+    return codes.size();
+}
+
+/*
+  Retrieve the codenames of every measure in the index.
+
+  @return
+    The codenames, in alphabetical order
+*/
+std::vector<std::string> QueryIndex::codenames() const {
+    std::vector<std::string> result;
+    for (auto it = measures.begin(); it != measures.end(); it++) {
+        result.push_back(it->codename);
+    }
+    return result;
+}
+
+/*
+  Find the areas with the highest values of a measure, among all areas or
+  those of a filter. Areas without a value for the first or last year, or
+  without a finite percentage change, are left out.
+
+  @param codename
+    The codename of the measure
+
+  @param metric
+    What to rank the areas by: the value of the last year, or the change or
+    percentage change from the first year to the last one
+
+  @param count
+    The largest number of areas to return
+
+  @param areasFilter
+    The areas to rank, by (parts of) their codes or names in uppercase, or an
+    empty set for all
+
+  @return
+    The areas with the highest values, from the highest down, with areas
+    with equal values in order of code
+
+  @throws
+    std::out_of_range if no area has the measure
+*/
+std::vector<RankedArea> QueryIndex::top(const std::string& codename, Query::Metric metric, std::size_t count,
+                                        const std::unordered_set<std::string>& areasFilter) const {
+    const MeasureColumns& columns = find(codename);
+    std::vector<double> values = metricOf(columns, metric);
+    const std::vector<bool> selected = selectedRows(columns, areasFilter);
+
+    //the areas left out are not ranked at all, so they do not count towards the ranks of the others either
+    std::vector<std::uint32_t> order;
+    order.reserve(values.size());
+    for (std::size_t row = 0; row < values.size(); row++) {
+        if (!selected[row]) {
+            values[row] = std::numeric_limits<double>::quiet_NaN();
+        } else if (!std::isnan(values[row])) {
+            order.push_back(static_cast<std::uint32_t>(row));
+        }
+    }
+
+    //rows are in order of code, so equal values are kept in that order
+    count = std::min(count, order.size());
+    std::partial_sort(order.begin(), order.begin() + count, order.end(), [&values](std::uint32_t lhs, std::uint32_t rhs) {
+        return values[lhs] > values[rhs] || (values[lhs] == values[rhs] && lhs < rhs);
+    });
+    order.resize(count);
+
+    return ranked(columns, values, order);
+}
+
+/*
+  Find the rank of areas among all the areas that have a measure. Areas
+  without a value for the first or last year, or without a finite
+  percentage change, are left out.
+
+  @param codename
+    The codename of the measure
+
+  @param metric
+    What to rank the areas by (see top())
+
+  @param areasFilter
+    The areas to return the rank of, by (parts of) their codes or names in
+    uppercase, or an empty set for all
+
+  @return
+    The rank of each area, in order of code
+
+  @throws
+    std::out_of_range if no area has the measure
+*/
+std::vector<RankedArea> QueryIndex::rank(const std::string& codename, Query::Metric metric,
+                                         const std::unordered_set<std::string>& areasFilter) const {
+    const MeasureColumns& columns = find(codename);
+    const std::vector<double> values = metricOf(columns, metric);
+
+    const std::vector<bool> inFilter = selectedRows(columns, areasFilter);
+
+    std::vector<std::uint32_t> selected;
+    for (std::size_t row = 0; row < values.size(); row++) {
+        if (!std::isnan(values[row]) && inFilter[row]) {
+            selected.push_back(static_cast<std::uint32_t>(row));
+        }
+    }
+
+    return ranked(columns, values, selected);
+}
+
+/*
+  Combine the values of a measure for each year across all the areas, or
+  those of a filter, that have a value for it. The sum adds them up in order of area code.
+  Percentiles are interpolated between the two closest values, e.g. the
+  median of an even number of values is the mean of the two middle ones.
+
+  @param codename
+    The codename of the measure
+
+  @param aggregation
+    How to combine the values: their sum, mean or a percentile
+
+  @param percentile
+    The percentile, from 0 to 100, if that is how they are combined
+
+  @param areasFilter
+    The areas to combine the values of, by (parts of) their codes or names in
+    uppercase, or an empty set for all
+
+  @return
+    A Measure with the codename and label of the measure, and the combined
+    value of every year that any area has a value for
+
+  @throws
+    std::out_of_range if no area has the measure
+*/
+Measure QueryIndex::aggregate(const std::string& codename, Query::Aggregation aggregation, double percentile,
+                              const std::unordered_set<std::string>& areasFilter) const {
+    const MeasureColumns& columns = find(codename);
+    const std::vector<bool> selected = selectedRows(columns, areasFilter);
+    Measure result(columns.codename, columns.label);
+
+    std::vector<double> present;
+    present.reserve(columns.rows.size());
+
+    for (int year = columns.firstYear; year < columns.firstYear + columns.numYears; year++) {
+        const double* column = columns.column(year);
+
+        present.clear();
+        for (std::size_t row = 0; row < columns.rows.size(); row++) {
+            if (selected[row] && !std::isnan(column[row])) {
+                present.push_back(column[row]);
+            }
+        }
+
+        if (present.empty()) {
+            continue;
+        }
+
+        double value = 0;
+        if (aggregation == Query::PERCENTILE) {
+            const double position = percentile / 100 * (present.size() - 1);
+            const std::size_t lower = static_cast<std::size_t>(position);
+            const std::size_t upper = std::min(lower + 1, present.size() - 1);
+
+            std::nth_element(present.begin(), present.begin() + lower, present.end());
+            const double lowerValue = present[lower];
+            const double upperValue = upper == lower ? lowerValue :
+                                      *std::min_element(present.begin() + upper, present.end());
+
+            value = lowerValue + (upperValue - lowerValue) * (position - lower);
+        } else {
+            for (auto it = present.begin(); it != present.end(); it++) {
+                value += *it;
+            }
+
+            if (aggregation == Query::MEAN) {
+                value /= present.size();
+            }
+        }
+
+        result.setValue(year, value);
+    }
+
+    return result;
+}
+
+/*Describes what areas are ranked by, e.g. "by % change in Population (pop) from 2011 to 2019".*/
+std::string QueryIndex::describe(const MeasureColumns& columns, Query::Metric metric) {
+    const std::string measure = columns.label + " (" + columns.codename + ")";
+    const int lastYear = columns.firstYear + columns.numYears - 1;
+    const std::string years = columns.numYears == 0 ? "" :
+                              " from " + std::to_string(columns.firstYear) + " to " + std::to_string(lastYear);
+
+    switch (metric) {
+        case Query::CHANGE:
+            return "by change in " + measure + years;
+
+        case Query::GROWTH:
+            return "by % change in " + measure + years;
+
+        default:
+            return "by value of " + measure + (columns.numYears == 0 ? "" : " in " + std::to_string(lastYear));
+    }
+}
+
+/*Describes how values are combined across areas, e.g. "Mean" or "Percentile 90".*/
+std::string QueryIndex::describe(Query::Aggregation aggregation, double percentile) {
+    switch (aggregation) {
+        case Query::SUM:
+            return "Sum";
+
+        case Query::MEAN:
+            return "Mean";
+
+        default:
+            char buffer[32];
+            auto result = std::to_chars(buffer, buffer + sizeof(buffer), percentile);
+            return "Percentile " + std::string(buffer, result.ptr - buffer);
+    }
+}
+
+/*
+  Write the answers to the queries, for every measure in the index: the
+  areas of --top with their values, the ranks of --rank, and the values of
+  --aggregate as a table like that of a Measure. With json, they are written
+  as a JSON object with the keys "aggregate", "rank" and "top" of the queries
+  asked for, each an object keyed by measure codename.
+
+  @param os
+    The stream to write to
+
+  @param query
+    The queries to answer
+
+  @param json
+    true to write JSON, false to write text
+*/
+void QueryIndex::write(std::ostream& os, const Query& query, bool json) const {
+    if (json) {
+        writeJSON(os, query);
+    } else {
+        writeTables(os, query);
+    }
+}
+
+/*Writes the answers to the queries as text.*/
+void QueryIndex::writeTables(std::ostream& os, const Query& query) const {
+    if (query.top > 0) {
+        for (auto it = measures.begin(); it != measures.end(); it++) {
+            os << "Top " << query.top << " areas " << describe(*it, query.metric) << '\n';
+
+            const std::vector<RankedArea> areas = top(it->codename, query.metric, query.top, query.areas);
+            for (auto area = areas.begin(); area != areas.end(); area++) {
+                os << area->rank << ". " << *area->name << " (" << *area->code << "): " << formatNumber(area->value)
+                   << '\n';
+            }
+            if (areas.empty()) {
+                os << "<no data>" << '\n';
+            }
+            os << '\n';
+        }
+    }
+
+    if (query.rank) {
+        for (auto it = measures.begin(); it != measures.end(); it++) {
+            os << "Rank of areas " << describe(*it, query.metric) << '\n';
+
+            const std::vector<RankedArea> areas = rank(it->codename, query.metric, query.areas);
+            for (auto area = areas.begin(); area != areas.end(); area++) {
+                os << *area->name << " (" << *area->code << "): " << area->rank << " of " << area->outOf
+                   << ", percentile " << formatNumber(area->percentile) << ", value " << formatNumber(area->value)
+                   << '\n';
+            }
+            if (areas.empty()) {
+                os << "<no data>" << '\n';
+            }
+            os << '\n';
+        }
+    }
+
+    if (query.aggregation != Query::NONE) {
+        for (auto it = measures.begin(); it != measures.end(); it++) {
+            //the description is not set as the label of the Measure, as that would intern a new label every query
+            const std::string label = describe(query.aggregation, query.percentile) + " of " + it->label + " across areas";
+            aggregate(it->codename, query.aggregation, query.percentile, query.areas).writeTable(os, nullptr, label);
+            os << '\n';
+        }
+    }
+}
+
+/*Writes the areas of a --top or --rank query as a JSON array of objects, with their keys in order.*/
+static void writeRankedJSON(JsonWriter& out, const std::vector<RankedArea>& areas) {
+    out.raw('[');
+    for (auto it = areas.begin(); it != areas.end(); it++) {
+        if (it != areas.begin()) {
+            out.raw(',');
+        }
+
+        out.raw("{\"area\":");
+        out.string(*it->code);
+        out.raw(",\"name\":");
+        out.string(*it->name);
+        out.raw(",\"of\":");
+        out.raw(std::to_string(it->outOf));
+        out.raw(",\"percentile\":");
+        out.number(it->percentile);
+        out.raw(",\"rank\":");
+        out.raw(std::to_string(it->rank));
+        out.raw(",\"value\":");
+        out.number(it->value);
+        out.raw('}');
+    }
+    out.raw(']');
+}
+
+/*Writes the answers to the queries as JSON, with the keys of every object in order like the rest of the output.*/
+void QueryIndex::writeJSON(std::ostream& os, const Query& query) const {
+    JsonWriter out(os);
+    bool first = true;
+
+    out.raw('{');
+
+    if (query.aggregation != Query::NONE) {
+        out.raw("\"aggregate\":{");
+        for (auto it = measures.begin(); it != measures.end(); it++) {
+            if (it != measures.begin()) {
+                out.raw(',');
+            }
+
+            out.string(it->codename);
+            out.raw(':');
+            aggregate(it->codename, query.aggregation, query.percentile, query.areas).writeJSON(out);
+        }
+        out.raw('}');
+        first = false;
+    }
+
+    if (query.rank) {
+        out.raw(first ? "\"rank\":{" : ",\"rank\":{");
+        for (auto it = measures.begin(); it != measures.end(); it++) {
+            if (it != measures.begin()) {
+                out.raw(',');
+            }
+
+            out.string(it->codename);
+            out.raw(':');
+            writeRankedJSON(out, rank(it->codename, query.metric, query.areas));
+        }
+        out.raw('}');
+        first = false;
+    }
+
+    if (query.top > 0) {
+        out.raw(first ? "\"top\":{" : ",\"top\":{");
+        for (auto it = measures.begin(); it != measures.end(); it++) {
+            if (it != measures.begin()) {
+                out.raw(',');
+            }
+
+            out.string(it->codename);
+            out.raw(':');
+            writeRankedJSON(out, top(it->codename, query.metric, query.top, query.areas));
+        }
+        out.raw('}');
+    }
+
+    out.raw('}');
+}
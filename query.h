@@ -0,0 +1,139 @@
+#ifndef QUERY_H_
+#define QUERY_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains the declaration of the QueryIndex class, which answers
+  the queries of --top, --rank and --aggregate across all the areas that were
+  imported, and of the Query they are parsed into.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "areas.h"
+
+/*
+  The queries asked for on the command line, parsed by BethYw::parseQueryArgs().
+  Each query is answered for every measure that was imported, over the years
+  that were imported.
+*/
+struct Query {
+    //what areas are ranked by: the value in the last year, or its change since the first year as is or in %
+    enum Metric {
+        VALUE,
+        CHANGE,
+        GROWTH
+    };
+
+    //how the values of a year are combined across areas
+    enum Aggregation {
+        NONE,
+        SUM,
+        MEAN,
+        PERCENTILE
+    };
+
+    //the number of areas --top lists, or 0 if it was not given
+    std::size_t top;
+    //whether --rank was given
+    bool rank;
+    //the areas of --areas the queries are about, as (parts of) their codes or names in uppercase, or all if empty
+    std::unordered_set<std::string> areas;
+    Metric metric;
+    Aggregation aggregation;
+    //the percentile of --aggregate=pNN, from 0 to 100
+    double percentile;
+
+    Query();
+
+    bool any() const noexcept;
+};
+
+/*
+  An area in the answer to a --top or --rank query.
+*/
+struct RankedArea {
+    const std::pmr::string* code;
+    const std::string* name;
+    //what the area was ranked by
+    double value;
+    //1 for the highest value, with equal values sharing a rank
+    std::size_t rank;
+    //the number of areas ranked, i.e. those with a value for the years
+    std::size_t outOf;
+    //the percentage of areas with a lower value, counting those with an equal value as half lower
+    double percentile;
+};
+
+/*
+  A QueryIndex is built once from the imported Areas, and keeps the values of
+  every measure in columns: for each measure, the areas that have it are the
+  rows, and each year is one contiguous array of the values of those areas,
+  with NaN for the areas that have no value for the year. A query then reads
+  one or two arrays of doubles instead of looking up the measure in every
+  area and the year in every measure.
+
+  The index copies the values, so the Areas object can be changed or
+  destroyed afterwards.
+*/
+class QueryIndex {
+private:
+    //the values of one measure across all areas that have it
+    struct MeasureColumns {
+        std::string codename;
+        std::string label;
+        int firstYear;
+        int numYears;
+        //the index in codes and names of the area of each row
+        std::vector<std::uint32_t> rows;
+        //numYears columns of rows.size() values each
+        std::vector<double> values;
+
+        const double* column(int year) const noexcept;
+    };
+
+    //the codes and names of every area, sorted by code
+    std::vector<const std::pmr::string*> codes;
+    std::vector<std::string> names;
+    //every measure, sorted by codename
+    std::vector<MeasureColumns> measures;
+
+    const MeasureColumns& find(const std::string& codename) const;
+    static std::vector<double> metricOf(const MeasureColumns& columns, Query::Metric metric);
+    std::vector<bool> selectedRows(const MeasureColumns& columns,
+                                   const std::unordered_set<std::string>& areasFilter) const;
+    std::vector<RankedArea> ranked(const MeasureColumns& columns, const std::vector<double>& metric,
+                                   const std::vector<std::uint32_t>& selected) const;
+    static std::string describe(const MeasureColumns& columns, Query::Metric metric);
+    static std::string describe(Query::Aggregation aggregation, double percentile);
+
+    void writeTables(std::ostream& os, const Query& query) const;
+    void writeJSON(std::ostream& os, const Query& query) const;
+
+public:
+    explicit QueryIndex(const Areas& areas);
+
+    std::size_t numAreas() const noexcept;
+    std::vector<std::string> codenames() const;
+
+    std::vector<RankedArea> top(const std::string& codename, Query::Metric metric, std::size_t count,
+                                const std::unordered_set<std::string>& areasFilter = {}) const;
+    std::vector<RankedArea> rank(const std::string& codename, Query::Metric metric,
+                                 const std::unordered_set<std::string>& areasFilter) const;
+    Measure aggregate(const std::string& codename, Query::Aggregation aggregation, double percentile = 50,
+                      const std::unordered_set<std::string>& areasFilter = {}) const;
+
+    void write(std::ostream& os, const Query& query, bool json) const;
+};
+
+#endif // QUERY_H_
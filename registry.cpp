@@ -0,0 +1,239 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains the implementation of the DatasetRegistry class.
+
+  Ruling a dataset out has to be certain, as a dataset that is wrongly skipped
+  silently changes the output. Whenever we can not be sure, e.g. a file that
+  can not be opened (its error is reported when it is loaded instead), the
+  dataset is kept.
+*/
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "registry.h"
+#include "bethyw.h"
+#include "input.h"
+#include "parallel.h"
+
+/*
+  Construct a registry of areas.csv and every dataset in datasets.h, in the
+  given directory. No file is opened until it is needed.
+
+  @param dir
+    The directory the files are in, ending with a directory separator
+*/
+DatasetRegistry::DatasetRegistry(const std::string& dir) : dir(dir), entries() {
+    std::vector<const BethYw::InputFileSource*> sources;
+    sources.push_back(&BethYw::InputFiles::AREAS);
+    for (unsigned int i = 0; i < BethYw::InputFiles::NUM_DATASETS; i++) {
+        sources.push_back(&BethYw::InputFiles::DATASETS[i]);
+    }
+
+    for (auto it = sources.begin(); it != sources.end(); it++) {
+        std::unique_ptr<Entry> entry(new Entry());
+        entry->source = *it;
+        entry->loaded = false;
+        entries.push_back(std::move(entry));
+    }
+}
+
+/*Finds the entry of a source by its file, as the sources passed to us are often copies of the ones in datasets.h.*/
+DatasetRegistry::Entry& DatasetRegistry::find(const BethYw::InputFileSource& source) const {
+    for (auto it = entries.begin(); it != entries.end(); it++) {
+        if ((*it)->source->FILE == source.FILE) {
+            return **it;
+        }
+    }
+
+    throw std::runtime_error("No dataset file matches " + source.FILE);
+}
+
+/*Parses the file of an entry without any filters, unless it has already been parsed. A file that can not be parsed
+ * leaves the entry empty with its error, which get() then throws every time it is asked for.*/
+void DatasetRegistry::load(Entry& entry) const {
+    std::call_once(entry.once, [&]() {
+        try {
+            MmapInputFile file(dir + entry.source->FILE);
+            entry.areas.populate(file.open(), entry.source->PARSER, entry.source->COLS, nullptr, nullptr, nullptr);
+            entry.measureCodes = entry.areas.measureCodes();
+        } catch (const std::exception& ex) {
+            entry.areas = Areas();
+            entry.error = ex.what();
+        }
+
+        entry.loaded.store(true, std::memory_order_release);
+    });
+}
+
+/*Checks if the file of an entry could have a measure matching the filter, from the cheapest way of knowing onwards.*/
+bool DatasetRegistry::mayContribute(Entry& entry, const FilterMatcher& measuresMatcher,
+                                    const StringFilterSet& measuresFilter) const {
+    const BethYw::InputFileSource& source = *entry.source;
+
+    if (measuresMatcher.matchesAll() || source.PARSER == BethYw::AuthorityCodeCSV) {
+        return true;
+    }
+
+    auto singleMeasure = source.COLS.find(BethYw::SourceColumn::SINGLE_MEASURE_CODE);
+    if (singleMeasure != source.COLS.end()) {
+        return measuresMatcher.matches(BethYw::toLower(singleMeasure->second));
+    }
+
+    if (entry.loaded.load(std::memory_order_acquire)) {
+        if (!entry.error.empty()) {
+            return true;
+        }
+
+        for (auto it = entry.measureCodes.begin(); it != entry.measureCodes.end(); it++) {
+            if (measuresMatcher.matches(*it)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    try {
+        MmapInputFile file(dir + source.FILE);
+        file.open();
+        return textMayMatch(file.bytes(), measuresMatcher, measuresFilter);
+    } catch (const std::exception& ex) {
+        return true;
+    }
+}
+
+/*
+  Find which datasets could contribute to the output of a query with a
+  measures filter, i.e. the datasets that have, or might have, a measure that
+  matches the filter.
+
+  @param datasets
+    The datasets requested by the query
+
+  @param measuresFilter
+    The measures filter of the query, or an empty set for all measures
+
+  @return
+    The datasets that may contribute, in the same order
+
+  @example
+    DatasetRegistry registry("datasets/");
+    auto needed = registry.contributing({BethYw::InputFiles::AQI, BethYw::InputFiles::TRAINS}, {"rail"});
+    // needed holds only TRAINS
+*/
+std::vector<BethYw::InputFileSource> DatasetRegistry::contributing(
+        const std::vector<BethYw::InputFileSource>& datasets,
+        const StringFilterSet& measuresFilter) const {
+    const FilterMatcher measuresMatcher(&measuresFilter, FilterMatcher::LOWER);
+
+    std::vector<BethYw::InputFileSource> needed;
+    for (auto it = datasets.begin(); it != datasets.end(); it++) {
+        bool contributes = true;
+
+        try {
+            contributes = mayContribute(find(*it), measuresMatcher, measuresFilter);
+        } catch (const std::runtime_error& ex) {
+            //a dataset we know nothing about is kept
+        }
+
+        if (contributes) {
+            needed.push_back(*it);
+        }
+    }
+
+    return needed;
+}
+
+/*
+  Return the data of a file, parsed without any filters. The file is parsed
+  the first time it is asked for, and every later call returns the same data.
+
+  @param source
+    areas.csv or one of the datasets in datasets.h
+
+  @return
+    The data of the file
+
+  @throws
+    std::runtime_error with the error of parsing the file if it could not be
+    parsed, or if the source is not one of the registry's files
+*/
+const Areas& DatasetRegistry::get(const BethYw::InputFileSource& source) const {
+    Entry& entry = find(source);
+    load(entry);
+
+    if (!entry.error.empty()) {
+        throw std::runtime_error(entry.error);
+    }
+
+    return entry.areas;
+}
+
+/*
+  Check if a file has been parsed (or failed to be) by get() or loadAll().
+
+  @param source
+    areas.csv or one of the datasets in datasets.h
+
+  @return
+    true if the file has been parsed
+
+  @throws
+    std::runtime_error if the source is not one of the registry's files
+*/
+bool DatasetRegistry::isLoaded(const BethYw::InputFileSource& source) const {
+    return find(source).loaded.load(std::memory_order_acquire);
+}
+
+/*
+  Parse every file that has not been parsed yet, e.g. before a server starts
+  answering queries.
+
+  @param threads
+    The number of threads to parse the files on, or 0 to use one per core
+*/
+void DatasetRegistry::loadAll(unsigned int threads) const {
+    BethYw::parallelFor(entries.size(), BethYw::threadsFor(entries.size(), threads), [&](size_t i) {
+        load(*entries[i]);
+    });
+}
+
+/*
+  Check if the text of a JSON file could contain a measure code matching the
+  measures filter. Every measure code is a string in the file, so unless the
+  matcher finds one of the strings of the filter somewhere in the whole text,
+  no measure code can match it. That only holds when the codes are written
+  as they are, so text with \u escapes, or a filter with characters that the
+  other escapes stand for, may always match.
+
+  @param text
+    The contents of the file
+
+  @param measuresMatcher
+    The matcher of the filter, with lowercase folding
+
+  @param measuresFilter
+    The filter the matcher was built from
+
+  @return
+    false if no measure code in the text can match the filter
+*/
+bool DatasetRegistry::textMayMatch(std::string_view text, const FilterMatcher& measuresMatcher,
+                                   const StringFilterSet& measuresFilter) noexcept {
+    for (auto it = measuresFilter.begin(); it != measuresFilter.end(); it++) {
+        for (char c : *it) {
+            if (c == '"' || c == '\\' || c == '/' || static_cast<unsigned char>(c) < 0x20) {
+                return true;
+            }
+        }
+    }
+
+    return text.find("\\u") != std::string_view::npos || measuresMatcher.matches(text);
+}
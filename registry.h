@@ -0,0 +1,81 @@
+#ifndef REGISTRY_H_
+#define REGISTRY_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains the declaration of the DatasetRegistry class, which knows
+  the files of a data directory, works out which of them could contribute to a
+  query, and parses each of them only when it is first needed.
+ */
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "areas.h"
+#include "datasets.h"
+#include "filter.h"
+
+/*
+  A DatasetRegistry has an entry for areas.csv and for every dataset in
+  datasets.h. Nothing is read when it is constructed.
+
+  contributing() removes the datasets that provably can not add anything to
+  the output of a query with a given measures filter, e.g. -m pop never needs
+  envi0201.json. A dataset with a single measure is ruled out by the code of
+  that measure in its column mapping, without opening the file. Any other
+  dataset is ruled out by the measure codes it was found to contain if it has
+  already been loaded, or else by scanning the text of the file for the
+  filter, which is much quicker than parsing it.
+
+  get() parses a file without any filters the first time it is called for it,
+  and returns the same data on every later call, so the registry can answer
+  queries with different filters like QueryServer does. Both functions may be
+  called from several threads at once.
+*/
+class DatasetRegistry {
+private:
+    struct Entry {
+        const BethYw::InputFileSource* source;
+        std::once_flag once;
+        //set once the file has been parsed, or has failed to
+        std::atomic<bool> loaded;
+        Areas areas;
+        std::string error;
+        //the lowercase codes of the measures found in the file, once it is loaded
+        std::vector<std::string> measureCodes;
+    };
+
+    std::string dir;
+    std::vector<std::unique_ptr<Entry>> entries;
+
+    Entry& find(const BethYw::InputFileSource& source) const;
+    void load(Entry& entry) const;
+    bool mayContribute(Entry& entry, const FilterMatcher& measuresMatcher,
+                       const StringFilterSet& measuresFilter) const;
+
+public:
+    DatasetRegistry(const std::string& dir);
+    DatasetRegistry(const DatasetRegistry& other) = delete;
+    DatasetRegistry& operator=(const DatasetRegistry& other) = delete;
+
+    std::vector<BethYw::InputFileSource> contributing(const std::vector<BethYw::InputFileSource>& datasets,
+                                                      const StringFilterSet& measuresFilter) const;
+
+    const Areas& get(const BethYw::InputFileSource& source) const;
+    bool isLoaded(const BethYw::InputFileSource& source) const;
+    void loadAll(unsigned int threads) const;
+
+    static bool textMayMatch(std::string_view text, const FilterMatcher& measuresMatcher,
+                             const StringFilterSet& measuresFilter) noexcept;
+};
+
+#endif // REGISTRY_H_
@@ -0,0 +1,432 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains the implementation of the RowIndex class. See rowindex.h
+  for the layout of an index file.
+
+  An index is a cache: whenever it is missing, damaged, or was built from a
+  different version of its file, it is built again, and if that fails the
+  file is simply parsed in full.
+*/
+
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "rowindex.h"
+#include "binary.h"
+#include "datasets.h"
+#include "filter.h"
+#include "input.h"
+#include "jsonstream.h"
+#include "snapshot.h"
+
+/*
+  The version of the index format, which must be changed whenever the layout
+  of the file, or the way rows are grouped, changes. Indexes with another
+  version are built again.
+*/
+const uint32_t RowIndex::VERSION = 1;
+
+//the measure of the runs of datasets whose single measure is in their column mapping
+const uint32_t RowIndex::NO_MEASURE = UINT32_MAX;
+
+//the magic number at the beginning of every index file, including its terminating zero
+static const char MAGIC[8] = "BYWINDX";
+
+RowIndex::RowIndex() : fingerprint{0, 0, 0}, areas(), measures(), runs() {
+
+}
+
+/*
+  Build the index of the text of a StatsWales JSON file. The rows are located
+  by JsonRowReader::findRows(), and each of them is matched up with the row a
+  JsonRowReader parses at the same position, which gives its area and
+  measure. If the two do not find the same number of rows, the text is not a
+  file we can index safely.
+
+  @param text
+    The contents of the file
+
+  @param fingerprint
+    The fingerprint of the file, stored in the index
+
+  @param cols
+    The column mapping of the dataset
+
+  @return
+    The index of the file
+
+  @throws
+    std::runtime_error if the file can not be parsed, or its rows can not be
+    located
+    std::out_of_range if there are not enough columns in cols
+
+  @example
+    MmapInputFile file("datasets/envi0201.json");
+    file.open();
+    RowIndex index = RowIndex::build(file.bytes(),
+                                     FileFingerprint::sampled(file.getSource(), file.bytes()),
+                                     BethYw::InputFiles::AQI.COLS);
+*/
+RowIndex RowIndex::build(std::string_view text, const FileFingerprint& fingerprint,
+                         const BethYw::SourceColumnMapping& cols) {
+    const bool singleMeasure = cols.find(BethYw::SourceColumn::SINGLE_MEASURE_CODE) != cols.end();
+    const JsonRowSchema schema = singleMeasure
+            ? JsonRowSchema(cols, {BethYw::SourceColumn::AUTH_CODE, BethYw::SourceColumn::AUTH_NAME_ENG})
+            : JsonRowSchema(cols, {BethYw::SourceColumn::AUTH_CODE, BethYw::SourceColumn::AUTH_NAME_ENG,
+                                   BethYw::SourceColumn::MEASURE_CODE});
+
+    const std::size_t authorityCodeSlot = schema.slot(BethYw::SourceColumn::AUTH_CODE);
+    const std::size_t areaEngNameSlot = schema.slot(BethYw::SourceColumn::AUTH_NAME_ENG);
+    const std::size_t measureCodeSlot = singleMeasure ? 0 : schema.slot(BethYw::SourceColumn::MEASURE_CODE);
+
+    const std::vector<JsonRowSpan> spans = JsonRowReader::findRows(text);
+
+    RowIndex index;
+    index.fingerprint = fingerprint;
+
+    std::map<std::pair<std::string, std::string>, uint32_t> areaNumbers;
+    std::unordered_map<std::string, uint32_t> measureNumbers;
+    std::size_t row = 0;
+
+    JsonRowReader reader(schema, [&](const JsonRow& data) {
+        if (row == spans.size()) {
+            throw std::runtime_error("The rows of the file could not be located");
+        }
+        const JsonRowSpan& span = spans[row++];
+
+        auto area = areaNumbers.emplace(std::make_pair(data.getString(authorityCodeSlot),
+                                                       data.getString(areaEngNameSlot)),
+                                        index.areas.size());
+        if (area.second) {
+            index.areas.push_back({area.first->first.first, area.first->first.second});
+        }
+
+        uint32_t measure = RowIndex::NO_MEASURE;
+        if (!singleMeasure) {
+            auto found = measureNumbers.emplace(data.getString(measureCodeSlot), index.measures.size());
+            if (found.second) {
+                index.measures.push_back(found.first->first);
+            }
+            measure = found.first->second;
+        }
+
+        //rows of the same area and measure are next to each other, so they usually extend the last run
+        if (!index.runs.empty() && index.runs.back().area == area.first->second &&
+                index.runs.back().measure == measure) {
+            index.runs.back().end = span.end;
+        } else {
+            index.runs.push_back({span.begin, span.end, area.first->second, measure});
+        }
+    });
+
+    MemoryStreamBuffer buffer;
+    buffer.reset(text.data(), text.size());
+    std::istream is(&buffer);
+    reader.parse(is);
+
+    if (!reader.foundRows() || row != spans.size()) {
+        throw std::runtime_error("The rows of the file could not be located");
+    }
+
+    return index;
+}
+
+/*
+  Read the index file at the given path, if there is one for a dataset file
+  with the given fingerprint.
+
+  @param path
+    The path of the index file
+
+  @param fingerprint
+    The fingerprint of the dataset file as it is now
+
+  @param index
+    The index to replace with the one in the file
+
+  @return
+    true if `index` was read from the file, false if there is no usable index
+    (in which case `index` is left unchanged)
+*/
+bool RowIndex::load(const std::string& path, const FileFingerprint& fingerprint, RowIndex& index) {
+    MmapInputFile file(path);
+
+    try {
+        BinaryReader reader(file.bytes());
+        if (reader.readBytes(sizeof(MAGIC)) != std::string_view(MAGIC, sizeof(MAGIC)) ||
+                reader.read<uint32_t>() != RowIndex::VERSION) {
+            return false;
+        }
+
+        RowIndex loaded;
+        loaded.fingerprint.size = reader.read<uint64_t>();
+        loaded.fingerprint.modified = reader.read<int64_t>();
+        loaded.fingerprint.hash = reader.read<uint64_t>();
+        if (!(loaded.fingerprint == fingerprint)) {
+            return false;
+        }
+
+        const uint32_t numAreas = reader.read<uint32_t>();
+        for (uint32_t i = 0; i < numAreas; i++) {
+            AreaKey area;
+            area.code = reader.readString();
+            area.name = reader.readString();
+            loaded.areas.push_back(std::move(area));
+        }
+
+        const uint32_t numMeasures = reader.read<uint32_t>();
+        for (uint32_t i = 0; i < numMeasures; i++) {
+            loaded.measures.emplace_back(reader.readString());
+        }
+
+        /*Every run is checked against the tables and the size of the file, so a damaged index is never used to cut
+         * the file in the wrong places.*/
+        const uint64_t numRuns = reader.read<uint64_t>();
+        for (uint64_t i = 0; i < numRuns; i++) {
+            Run run;
+            run.begin = reader.read<uint64_t>();
+            run.end = reader.read<uint64_t>();
+            run.area = reader.read<uint32_t>();
+            run.measure = reader.read<uint32_t>();
+
+            if (run.begin >= run.end || run.end > fingerprint.size || run.area >= numAreas ||
+                    (run.measure != RowIndex::NO_MEASURE && run.measure >= numMeasures)) {
+                return false;
+            }
+            loaded.runs.push_back(run);
+        }
+
+        if (!reader.atEnd()) {
+            return false;
+        }
+
+        index = std::move(loaded);
+        return true;
+    } catch (const std::runtime_error& ex) {
+        return false;
+    }
+}
+
+/*
+  Write the index to a file, replacing the file if there is one.
+
+  @param path
+    The path of the index file
+
+  @throws
+    std::runtime_error if the file can not be written, with the message:
+    RowIndex::save: Failed to write file <file name>
+*/
+void RowIndex::save(const std::string& path) const {
+    std::string out(MAGIC, sizeof(MAGIC));
+    writeBinary<uint32_t>(out, RowIndex::VERSION);
+    writeBinary<uint64_t>(out, fingerprint.size);
+    writeBinary<int64_t>(out, fingerprint.modified);
+    writeBinary<uint64_t>(out, fingerprint.hash);
+
+    writeBinary<uint32_t>(out, areas.size());
+    for (auto it = areas.begin(); it != areas.end(); it++) {
+        writeBinaryString(out, it->code);
+        writeBinaryString(out, it->name);
+    }
+
+    writeBinary<uint32_t>(out, measures.size());
+    for (auto it = measures.begin(); it != measures.end(); it++) {
+        writeBinaryString(out, *it);
+    }
+
+    writeBinary<uint64_t>(out, runs.size());
+    for (auto it = runs.begin(); it != runs.end(); it++) {
+        writeBinary<uint64_t>(out, it->begin);
+        writeBinary<uint64_t>(out, it->end);
+        writeBinary<uint32_t>(out, it->area);
+        writeBinary<uint32_t>(out, it->measure);
+    }
+
+    try {
+        BethYw::replaceFile(path, out);
+    } catch (const std::runtime_error& ex) {
+        throw std::runtime_error(std::string("RowIndex::save: ") + ex.what());
+    }
+}
+
+/*
+  Return the path of the index of a dataset, which is a hidden file in the
+  directory of the dataset, e.g. datasets/.envi0201.json.bethyw-index
+
+  @param dir
+    The directory the dataset is in, ending with a directory separator
+
+  @param source
+    The dataset
+
+  @return
+    The path of its index file
+*/
+std::string RowIndex::pathFor(const std::string& dir, const BethYw::InputFileSource& source) {
+    return dir + "." + source.FILE + ".bethyw-index";
+}
+
+/*
+  Return the index of a dataset, reading it from its index file if that is up
+  to date, or otherwise building it and saving it for the next run. Failing
+  to save the index is not an error, as it can still be used.
+
+  @param dir
+    The directory the dataset is in, ending with a directory separator
+
+  @param source
+    The dataset, which must be a WelshStatsJSON one
+
+  @param text
+    The contents of the dataset file
+
+  @return
+    The index of the dataset
+
+  @throws
+    std::runtime_error if the index has to be built and the file can not be
+    indexed (see build())
+*/
+RowIndex RowIndex::forDataset(const std::string& dir, const BethYw::InputFileSource& source,
+                              std::string_view text) {
+    const std::string path = RowIndex::pathFor(dir, source);
+    const FileFingerprint fingerprint = FileFingerprint::sampled(dir + source.FILE, text);
+
+    RowIndex index;
+    if (!RowIndex::load(path, fingerprint, index)) {
+        index = RowIndex::build(text, fingerprint, source.COLS);
+
+        try {
+            index.save(path);
+        } catch (const std::runtime_error& ex) {
+            std::cerr << "Warning: " << ex.what() << std::endl;
+        }
+    }
+
+    return index;
+}
+
+/*
+  Check if an index can make importing a dataset with the given filters any
+  quicker, i.e. if it is a WelshStatsJSON dataset and the filters may leave
+  out some of its areas or measures. The years filter does not count, as the
+  index does not know the years of the rows.
+
+  @param source
+    The dataset
+
+  @param areasFilter
+    The areas to import, or an empty set for all of them
+
+  @param measuresFilter
+    The measures to import, or an empty set for all of them
+
+  @return
+    true if the dataset should be imported through its index
+*/
+bool RowIndex::canNarrow(const BethYw::InputFileSource& source,
+                         const std::unordered_set<std::string>& areasFilter,
+                         const std::unordered_set<std::string>& measuresFilter) noexcept {
+    if (source.PARSER != BethYw::WelshStatsJSON) {
+        return false;
+    }
+
+    const bool singleMeasure = source.COLS.find(BethYw::SourceColumn::SINGLE_MEASURE_CODE) != source.COLS.end();
+    return !areasFilter.empty() || (!singleMeasure && !measuresFilter.empty());
+}
+
+/*
+  Return the text of a JSON file with only the rows of the areas and measures
+  that match the filters, in the same order as in the file. The filters are
+  matched the same way Areas::populate() matches them, so every row it would
+  import is kept (along with, for single measure datasets, the rows of a
+  measure the filter does not match).
+
+  @param text
+    The contents of the file the index was built from
+
+  @param areasFilter
+    The areas to keep, or an empty set or nullptr for all of them
+
+  @param measuresFilter
+    The measures to keep, or an empty set or nullptr for all of them
+
+  @return
+    A StatsWales JSON file with the selected rows
+
+  @throws
+    std::runtime_error if the text is not as long as the file the index was
+    built from
+
+  @example
+    std::string rows = index.selectedRows(file.bytes(), &areasFilter, &measuresFilter);
+    MemoryStreamBuffer buffer;
+    buffer.reset(rows.data(), rows.size());
+    std::istream is(&buffer);
+    areas.populate(is, BethYw::WelshStatsJSON, BethYw::InputFiles::AQI.COLS,
+                   &areasFilter, &measuresFilter, &yearsFilter);
+*/
+std::string RowIndex::selectedRows(std::string_view text, const std::unordered_set<std::string>* const areasFilter,
+                                   const std::unordered_set<std::string>* const measuresFilter) const {
+    if (text.size() != fingerprint.size) {
+        throw std::runtime_error("The index is not of this file");
+    }
+
+    const FilterMatcher areasMatcher(areasFilter, FilterMatcher::UPPER);
+    const FilterMatcher measuresMatcher(measuresFilter, FilterMatcher::LOWER);
+
+    //each area and measure is matched once, rather than once per run
+    std::vector<char> areaSelected(areas.size());
+    for (std::size_t i = 0; i < areas.size(); i++) {
+        areaSelected[i] = areasMatcher.matches(areas[i].code) || areasMatcher.matches(areas[i].name);
+    }
+
+    std::vector<char> measureSelected(measures.size());
+    for (std::size_t i = 0; i < measures.size(); i++) {
+        measureSelected[i] = measuresMatcher.matches(measures[i]);
+    }
+
+    std::vector<const Run*> selected;
+    std::size_t length = 0;
+    for (auto it = runs.begin(); it != runs.end(); it++) {
+        if (areaSelected[it->area] && (it->measure == RowIndex::NO_MEASURE || measureSelected[it->measure])) {
+            selected.push_back(&*it);
+            length += it->end - it->begin + 1;
+        }
+    }
+
+    const std::string_view head = "{\"value\":[";
+    const std::string_view tail = "]}";
+
+    std::string rows;
+    rows.reserve(head.size() + length + tail.size());
+    rows.append(head);
+    for (auto it = selected.begin(); it != selected.end(); it++) {
+        if (it != selected.begin()) {
+            rows.push_back(',');
+        }
+        rows.append(text.substr((*it)->begin, (*it)->end - (*it)->begin));
+    }
+    rows.append(tail);
+
+    return rows;
+}
+
+/*Returns the number of runs of rows in the index.*/
+std::size_t RowIndex::numRuns() const noexcept {
+    return runs.size();
+}
@@ -0,0 +1,98 @@
+#ifndef ROWINDEX_H_
+#define ROWINDEX_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains the declaration of the RowIndex class, an index of where
+  the rows of each area and measure are in a StatsWales JSON file, which is
+  kept on disk next to the file so that a query for a few areas or measures
+  only has to parse the rows it needs.
+ */
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "datasets.h"
+#include "snapshot.h"
+
+/*
+  The rows of a StatsWales file are grouped by area and then by measure, so a
+  RowIndex stores one run per group of consecutive rows with the same area
+  and measure: the span of the group in the file, and which area and measure
+  it holds. Areas are kept as their code and English name, as the areas
+  filter may match either of them, and measures as their code.
+
+  selectedRows() gives the text of a JSON file holding only the rows of the
+  areas and measures that match the filters. As it only ever leaves out rows
+  that the filters would have rejected, parsing that text with the same
+  filters gives exactly the same Areas object as parsing the whole file.
+
+  An index is only used for the file it was built from, which is checked with
+  the sampled fingerprint of the file, so a large file is not read in full
+  just to check it. The layout of the file is:
+
+    "BYWINDX" magic number (8 bytes, including a terminating zero)
+    uint32  version
+    uint64  size, int64 modification time, uint64 hash of the dataset file
+    uint32  number of areas, followed by the code and name of each
+    uint32  number of measures, followed by the code of each
+    uint64  number of runs
+    for each run:
+      uint64  offset of its first byte, uint64 offset past its last byte
+      uint32  area, uint32 measure (NO_MEASURE for single measure datasets)
+
+  where every string is stored as a uint32 length followed by its bytes, and
+  all numbers are in the byte order of the machine.
+*/
+class RowIndex {
+private:
+    struct AreaKey {
+        std::string code;
+        std::string name;
+    };
+
+    struct Run {
+        uint64_t begin;
+        uint64_t end;
+        uint32_t area;
+        uint32_t measure;
+    };
+
+    FileFingerprint fingerprint;
+    std::vector<AreaKey> areas;
+    std::vector<std::string> measures;
+    std::vector<Run> runs;
+
+public:
+    static const uint32_t VERSION;
+    static const uint32_t NO_MEASURE;
+
+    RowIndex();
+
+    static RowIndex build(std::string_view text, const FileFingerprint& fingerprint,
+                          const BethYw::SourceColumnMapping& cols);
+    static bool load(const std::string& path, const FileFingerprint& fingerprint, RowIndex& index);
+    void save(const std::string& path) const;
+
+    static std::string pathFor(const std::string& dir, const BethYw::InputFileSource& source);
+    static RowIndex forDataset(const std::string& dir, const BethYw::InputFileSource& source,
+                               std::string_view text);
+    static bool canNarrow(const BethYw::InputFileSource& source,
+                          const std::unordered_set<std::string>& areasFilter,
+                          const std::unordered_set<std::string>& measuresFilter) noexcept;
+
+    std::string selectedRows(std::string_view text, const std::unordered_set<std::string>* const areasFilter,
+                             const std::unordered_set<std::string>* const measuresFilter) const;
+
+    std::size_t numRuns() const noexcept;
+};
+
+#endif // ROWINDEX_H_
@@ -0,0 +1,495 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains the implementation of the QueryServer class and of the
+  client side of its protocol.
+
+  The protocol is deliberately simple, as both ends are always this program
+  on the same machine. Numbers are sent as 64-bit integers in the byte order
+  of the machine, and strings as their length followed by their bytes. A
+  request is the number of command line arguments followed by each argument,
+  and the response is the exit code followed by the standard output and the
+  standard error of the query. Each connection carries a single query.
+*/
+
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "lib_cxxopts.hpp"
+
+#include "server.h"
+#include "bethyw.h"
+#include "input.h"
+#include "parallel.h"
+
+//limits on requests, so a connection sending garbage can not make the server allocate lots of memory
+static const uint64_t MAX_ARGUMENTS = 4096;
+static const uint64_t MAX_ARGUMENT_LENGTH = 1 << 20;
+//how long a connection may take to send its request or read the response, in seconds
+static const int CONNECTION_TIMEOUT = 10;
+
+/*
+  Load areas.csv and every dataset in datasets.h from a directory, without any
+  filters. A file that can not be loaded does not stop the server, but any
+  query that needs it will fail with the same error bethyw would output.
+
+  @param dir
+    The directory the files are in, ending with a directory separator
+
+  @param threads
+    The number of threads to load the files on, or 0 to use one per core
+
+  @param lazy
+    If true, no file is loaded here, and each file is loaded by the first
+    query that needs it instead
+*/
+QueryServer::QueryServer(const std::string& dir, unsigned int threads, bool lazy) : registry(dir),
+                                                                                    lazy(lazy),
+                                                                                    listener(-1),
+                                                                                    socketPath() {
+    if (!lazy) {
+        registry.loadAll(threads);
+    }
+}
+
+/*
+  Close the listening socket if the server is still listening.
+*/
+QueryServer::~QueryServer() {
+#ifndef _WIN32
+    if (listener >= 0) {
+        close(listener);
+        unlink(socketPath.c_str());
+    }
+#endif
+}
+
+/*Finds the loaded data of a file, loading it first if needed. If the file could not be loaded, the error is output
+ * like loadAreas() and loadDatasets() do, and nullptr is returned.*/
+const Areas* QueryServer::shardFor(const BethYw::InputFileSource& source, std::ostream& err) const {
+    try {
+        return &registry.get(source);
+    } catch (const std::runtime_error& ex) {
+        err << "Error importing dataset:" << std::endl << ex.what();
+        return nullptr;
+    }
+}
+
+/*
+  Answer a query, which is the command line arguments of bethyw. The output is
+  the same as running bethyw with these arguments, except that the --dir,
+  --threads, --cache, --lazy and --profile arguments are ignored, as the data
+  is already loaded.
+
+  @param args
+    The command line arguments, starting with the name of the program
+
+  @param out
+    Where the output of the query is written, as tables or JSON
+
+  @param err
+    Where errors and the help message are written
+
+  @return
+    The exit code bethyw would have returned
+
+  @example
+    QueryServer server("datasets/");
+    std::ostringstream out, err;
+    int code = server.query({"bethyw", "-d", "popden", "-a", "W06000011", "-j"}, out, err);
+*/
+int QueryServer::query(const std::vector<std::string>& args, std::ostream& out, std::ostream& err) const {
+    try {
+        //cxxopts reorders the array of arguments it is given, so it gets its own copy of them
+        std::vector<std::string> copies(args);
+        std::vector<char*> argv;
+        for (auto it = copies.begin(); it != copies.end(); it++) {
+            argv.push_back(&(*it)[0]);
+        }
+
+        int argc = argv.size();
+        char** argvData = argv.data();
+
+        auto cxxopts = BethYw::cxxoptsSetup();
+        auto parsedArgs = cxxopts.parse(argc, argvData);
+
+        if (parsedArgs.count("help")) {
+            err << cxxopts.help() << std::endl;
+            return 0;
+        }
+
+        //the arguments are checked in the same order as BethYw::run() does, so the same errors are reported
+        BethYw::parseProfileArg(parsedArgs);
+        auto datasetsToImport = BethYw::parseDatasetsArg(parsedArgs);
+        auto areasFilter = BethYw::parseAreasArg(parsedArgs);
+        auto measuresFilter = BethYw::parseMeasuresArg(parsedArgs);
+        auto yearsFilter = BethYw::parseYearsArg(parsedArgs);
+        BethYw::parseThreadsArg(parsedArgs);
+        auto query = BethYw::parseQueryArgs(parsedArgs);
+
+        /*--rank ranks the areas asked for among all areas, so all of them are imported. The queries still only answer
+         * for the areas asked for, as they filter the areas themselves (see Query::areas).*/
+        if (query.rank) {
+            areasFilter.clear();
+        }
+
+        Areas data = Areas();
+
+        const Areas* areasShard = shardFor(BethYw::InputFiles::AREAS, err);
+        if (areasShard == nullptr) {
+            return 1;
+        }
+        data.mergeFiltered(*areasShard, BethYw::AuthorityCodeCSV, &areasFilter, &measuresFilter, &yearsFilter);
+
+        const std::vector<BethYw::InputFileSource> datasetsNeeded =
+                lazy ? registry.contributing(datasetsToImport, measuresFilter) : datasetsToImport;
+
+        for (auto it = datasetsNeeded.begin(); it != datasetsNeeded.end(); it++) {
+            const Areas* shard = shardFor(*it, err);
+            if (shard == nullptr) {
+                return 1;
+            }
+            data.mergeFiltered(*shard, it->PARSER, &areasFilter, &measuresFilter, &yearsFilter);
+        }
+
+        BethYw::writeOutput(out, data, parsedArgs);
+
+        return 0;
+    } catch (const std::exception& ex) {
+        err << ex.what();
+        return 1;
+    }
+}
+
+#ifndef _WIN32
+
+/*
+  A file descriptor that is closed when it goes out of scope.
+*/
+class FileDescriptor {
+private:
+    int fd;
+
+public:
+    explicit FileDescriptor(int fd) : fd(fd) {}
+    FileDescriptor(const FileDescriptor& other) = delete;
+    FileDescriptor& operator=(const FileDescriptor& other) = delete;
+
+    ~FileDescriptor() {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    int get() const noexcept {
+        return fd;
+    }
+};
+
+static sockaddr_un socketAddress(const std::string& socketPath) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+
+    if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("Invalid socket path: " + socketPath);
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    return address;
+}
+
+static void sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+
+    while (sent < data.size()) {
+        //MSG_NOSIGNAL stops a client that went away from killing the server with SIGPIPE
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            throw std::runtime_error(std::string("Could not send on socket: ") + std::strerror(errno));
+        }
+        sent += n;
+    }
+}
+
+static void receiveAll(int fd, char* data, size_t size) {
+    size_t received = 0;
+
+    while (received < size) {
+        ssize_t n = recv(fd, data + received, size - received, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            throw std::runtime_error(std::string("Could not receive on socket: ") + std::strerror(errno));
+        }
+        if (n == 0) {
+            throw std::runtime_error("Connection closed before the whole message was received");
+        }
+        received += n;
+    }
+}
+
+static void appendNumber(std::string& message, uint64_t number) {
+    message.append(reinterpret_cast<const char*>(&number), sizeof(number));
+}
+
+static void appendString(std::string& message, const std::string& str) {
+    appendNumber(message, str.size());
+    message.append(str);
+}
+
+static uint64_t receiveNumber(int fd) {
+    uint64_t number;
+    receiveAll(fd, reinterpret_cast<char*>(&number), sizeof(number));
+    return number;
+}
+
+static std::string receiveString(int fd, uint64_t maxLength) {
+    uint64_t length = receiveNumber(fd);
+    if (length > maxLength) {
+        throw std::runtime_error("Message on socket is too long");
+    }
+
+    std::string str(length, '\0');
+    receiveAll(fd, &str[0], length);
+    return str;
+}
+
+static void setTimeouts(int fd) {
+    timeval timeout;
+    timeout.tv_sec = CONNECTION_TIMEOUT;
+    timeout.tv_usec = 0;
+
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+}
+
+//the listening socket of the server that stop() is called on by the signal handler, or -1
+static volatile sig_atomic_t signalledListener = -1;
+
+static void stopOnSignal(int signal) {
+    if (signalledListener >= 0) {
+        shutdown(signalledListener, SHUT_RDWR);
+    }
+}
+
+#endif
+
+/*Reads a query from a connection, answers it and sends back the response. Errors only affect this connection, so
+ * they are not reported.*/
+void QueryServer::handleConnection(int fd) const noexcept {
+#ifndef _WIN32
+    try {
+        setTimeouts(fd);
+
+        uint64_t argc = receiveNumber(fd);
+        if (argc == 0 || argc > MAX_ARGUMENTS) {
+            return;
+        }
+
+        std::vector<std::string> args;
+        for (uint64_t i = 0; i < argc; i++) {
+            args.push_back(receiveString(fd, MAX_ARGUMENT_LENGTH));
+        }
+
+        std::ostringstream out;
+        std::ostringstream err;
+        int code = query(args, out, err);
+
+        std::string response;
+        appendNumber(response, static_cast<uint64_t>(code));
+        appendString(response, out.str());
+        appendString(response, err.str());
+        sendAll(fd, response);
+    } catch (const std::exception& ex) {
+        return;
+    }
+#endif
+}
+
+/*
+  Create the socket the server listens on. A socket file left behind by a
+  server that is no longer running is replaced, but not one that a server is
+  still listening on, or a file that is not a socket.
+
+  @param path
+    The path of the socket file
+
+  @throws
+    std::runtime_error if the socket can not be created, or
+    std::invalid_argument if the path is too long for a socket
+*/
+void QueryServer::listen(const std::string& path) {
+#ifdef _WIN32
+    throw std::runtime_error("Serving queries needs Unix domain sockets, which this platform does not have");
+#else
+    const sockaddr_un address = socketAddress(path);
+
+    struct stat info;
+    if (lstat(path.c_str(), &info) == 0) {
+        if (!S_ISSOCK(info.st_mode)) {
+            throw std::runtime_error("Can not create socket, a file already exists: " + path);
+        }
+
+        FileDescriptor probe(socket(AF_UNIX, SOCK_STREAM, 0));
+        if (connect(probe.get(), reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0) {
+            throw std::runtime_error("A server is already listening on " + path);
+        }
+        unlink(path.c_str());
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw std::runtime_error(std::string("Could not create socket: ") + std::strerror(errno));
+    }
+
+    if (bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || ::listen(fd, SOMAXCONN) != 0) {
+        const std::string error = std::strerror(errno);
+        close(fd);
+        throw std::runtime_error("Could not listen on " + path + ": " + error);
+    }
+
+    listener = fd;
+    socketPath = path;
+#endif
+}
+
+/*
+  Answer queries on the socket created by listen() until stop() is called or
+  the process receives SIGINT or SIGTERM, and then remove the socket file.
+  Each worker thread takes the next connection and answers its query, so this
+  many queries can be answered at the same time.
+
+  @param workers
+    The number of worker threads, or 0 to use one per core
+
+  @throws
+    std::logic_error if listen() has not been called
+*/
+void QueryServer::serve(unsigned int workers) {
+#ifndef _WIN32
+    if (listener < 0) {
+        throw std::logic_error("QueryServer::serve: listen() has not been called");
+    }
+
+    signalledListener = listener;
+    std::signal(SIGINT, stopOnSignal);
+    std::signal(SIGTERM, stopOnSignal);
+
+    std::vector<std::thread> threads;
+    const unsigned int numWorkers = BethYw::threadsFor(static_cast<size_t>(-1), workers);
+
+    for (unsigned int i = 0; i < numWorkers; i++) {
+        threads.emplace_back([this]() {
+            while (true) {
+                int fd = accept(listener, nullptr, nullptr);
+
+                if (fd >= 0) {
+                    handleConnection(fd);
+                    close(fd);
+                } else if (errno != EINTR && errno != ECONNABORTED) {
+                    //shutdown() on the listening socket ends up here
+                    break;
+                }
+            }
+        });
+    }
+
+    for (auto it = threads.begin(); it != threads.end(); it++) {
+        it->join();
+    }
+
+    signalledListener = -1;
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+
+    close(listener);
+    unlink(socketPath.c_str());
+    listener = -1;
+#endif
+}
+
+/*
+  Make serve() return once the queries being answered are finished. This can
+  be called from any thread.
+*/
+void QueryServer::stop() noexcept {
+#ifndef _WIN32
+    if (listener >= 0) {
+        shutdown(listener, SHUT_RDWR);
+    }
+#endif
+}
+
+/*
+  Send the command line arguments of a query to the QueryServer listening on
+  a socket, and write the output and errors of the query to out and err.
+
+  @param socketPath
+    The path of the socket the server listens on
+
+  @param args
+    The command line arguments, starting with the name of the program
+
+  @param out
+    Where the output of the query is written
+
+  @param err
+    Where the errors of the query are written
+
+  @return
+    The exit code of the query
+
+  @throws
+    std::runtime_error if there is no server listening on the socket, or the
+    connection fails
+*/
+int BethYw::forwardQuery(const std::string& socketPath, const std::vector<std::string>& args, std::ostream& out,
+                         std::ostream& err) {
+#ifdef _WIN32
+    throw std::runtime_error("Connecting to a server needs Unix domain sockets, which this platform does not have");
+#else
+    const sockaddr_un address = socketAddress(socketPath);
+
+    FileDescriptor fd(socket(AF_UNIX, SOCK_STREAM, 0));
+    if (fd.get() < 0 || connect(fd.get(), reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        throw std::runtime_error("Could not connect to a server on " + socketPath + ": " + std::strerror(errno));
+    }
+
+    std::string request;
+    appendNumber(request, args.size());
+    for (auto it = args.begin(); it != args.end(); it++) {
+        appendString(request, *it);
+    }
+    sendAll(fd.get(), request);
+
+    int code = static_cast<int>(receiveNumber(fd.get()));
+    out << receiveString(fd.get(), static_cast<uint64_t>(-1));
+    err << receiveString(fd.get(), static_cast<uint64_t>(-1));
+
+    return code;
+#endif
+}
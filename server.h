@@ -0,0 +1,78 @@
+#ifndef SERVER_H_
+#define SERVER_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains the declaration of the QueryServer class, which keeps
+  every file of a data directory loaded and answers queries sent over a Unix
+  domain socket by bethyw --connect, and of the client side of that protocol.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "areas.h"
+#include "datasets.h"
+#include "registry.h"
+
+/*
+  A QueryServer loads areas.csv and every dataset once, each into its own
+  Areas object without any filters. A query is the same command line arguments
+  bethyw takes, and is answered by merging the requested datasets into a new
+  Areas object with the requested filters, as bethyw --cache does with the
+  files in its snapshot. This gives the same output as running bethyw with
+  those arguments, without starting a process or parsing any file.
+
+  A lazy server does not load anything in its constructor. Each file is loaded
+  by the first query that needs it, and a query skips the datasets that can
+  not contribute to its output (see DatasetRegistry), so the server starts at
+  once and never loads the files no query asks for.
+
+  The loaded data is never changed once it is loaded, so any number of queries
+  can be answered at the same time. Queries come either from calling query()
+  directly, or over a socket once listen() and serve() are called.
+*/
+class QueryServer {
+private:
+    //areas.csv and every dataset in datasets.h, each loaded without any filters
+    DatasetRegistry registry;
+    bool lazy;
+
+    //the listening socket and its path, once listen() has been called
+    int listener;
+    std::string socketPath;
+
+    const Areas* shardFor(const BethYw::InputFileSource& source, std::ostream& err) const;
+    void handleConnection(int fd) const noexcept;
+
+public:
+    QueryServer(const std::string& dir, unsigned int threads = 0, bool lazy = false);
+    QueryServer(const QueryServer& other) = delete;
+    QueryServer& operator=(const QueryServer& other) = delete;
+    ~QueryServer();
+
+    int query(const std::vector<std::string>& args, std::ostream& out, std::ostream& err) const;
+
+    void listen(const std::string& path);
+    void serve(unsigned int workers = 0);
+    void stop() noexcept;
+};
+
+namespace BethYw {
+
+    /*
+      Send the command line arguments of a query to the QueryServer listening
+      on a socket, and write its output to out and err.
+    */
+    int forwardQuery(const std::string& socketPath, const std::vector<std::string>& args, std::ostream& out,
+                     std::ostream& err);
+
+} // namespace BethYw
+
+#endif // SERVER_H_
@@ -0,0 +1,349 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains the implementation of the Snapshot class and of file
+  fingerprints. See snapshot.h for the layout of a snapshot file.
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "snapshot.h"
+#include "areas.h"
+#include "intern.h"
+#include "area.h"
+#include "measure.h"
+#include "input.h"
+#include "binary.h"
+
+/*
+  The version of the snapshot format, which must be changed whenever the layout
+  of the file, or the way datasets are parsed, changes. Snapshots with another
+  version are ignored.
+*/
+const uint32_t Snapshot::VERSION = 1;
+
+//the magic number at the beginning of every snapshot file, including its terminating zero
+static const char MAGIC[8] = "BYWSNAP";
+
+/*Adds the bytes to a 64-bit FNV-1a hash.*/
+static uint64_t fnv1a(uint64_t hash, std::string_view bytes) noexcept {
+    for (auto it = bytes.begin(); it != bytes.end(); it++) {
+        hash ^= static_cast<unsigned char>(*it);
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+/*
+  Work out the fingerprint of a file from its path and contents. The hash is
+  the 64-bit FNV-1a hash of the contents, which is quick to compute and good
+  enough to notice a file being changed without its size or modification time
+  changing.
+
+  @param path
+    The path of the file, used to retrieve its modification time
+
+  @param contents
+    The contents of the file
+
+  @return
+    The fingerprint of the file
+
+  @throws
+    std::filesystem::filesystem_error if the modification time can not be read
+*/
+FileFingerprint FileFingerprint::of(const std::string& path, std::string_view contents) {
+    uint64_t hash = fnv1a(14695981039346656037ULL, contents);
+
+    int64_t modified = std::filesystem::last_write_time(path).time_since_epoch().count();
+
+    return FileFingerprint{contents.size(), modified, hash};
+}
+
+/*
+  Work out the fingerprint of a file like of() does, but with the hash of a
+  sample of its contents: 64 blocks of 4 KB spread evenly over the file, and
+  its last block. This reads at most 260 KB whatever the size of the file, so
+  it is meant for checking files that are too big to hash on every run. Only
+  a change outside the sampled blocks that keeps both the size and the
+  modification time goes unnoticed.
+
+  @param path
+    The path of the file, used to retrieve its modification time
+
+  @param contents
+    The contents of the file
+
+  @return
+    The fingerprint of the file
+
+  @throws
+    std::filesystem::filesystem_error if the modification time can not be read
+*/
+FileFingerprint FileFingerprint::sampled(const std::string& path, std::string_view contents) {
+    const std::size_t BLOCK = 4096;
+    const std::size_t BLOCKS = 64;
+
+    uint64_t hash = 14695981039346656037ULL;
+    if (contents.size() <= BLOCK * (BLOCKS + 1)) {
+        hash = fnv1a(hash, contents);
+    } else {
+        const std::size_t stride = (contents.size() - BLOCK) / BLOCKS;
+        for (std::size_t i = 0; i < BLOCKS; i++) {
+            hash = fnv1a(hash, contents.substr(i * stride, BLOCK));
+        }
+        hash = fnv1a(hash, contents.substr(contents.size() - BLOCK));
+    }
+
+    int64_t modified = std::filesystem::last_write_time(path).time_since_epoch().count();
+
+    return FileFingerprint{contents.size(), modified, hash};
+}
+
+bool FileFingerprint::operator==(const FileFingerprint& other) const noexcept {
+    return size == other.size && modified == other.modified && hash == other.hash;
+}
+
+/*
+  Open the snapshot file at the given path, if there is one. A missing file, or
+  one that is damaged or was made by another version of the program, is treated
+  as an empty snapshot and will be replaced when save() is called.
+
+  @param path
+    The path of the snapshot file
+*/
+Snapshot::Snapshot(const std::string& path) : path(path),
+                                              file(new MmapInputFile(path)),
+                                              entries(),
+                                              changed(false) {
+    try {
+        readEntries(file->bytes());
+    } catch (const std::runtime_error& ex) {
+        entries.clear();
+    }
+}
+
+/*Reads the header and the table of files of the snapshot. The encoded Areas objects are skipped, and only decoded
+ * by load().*/
+void Snapshot::readEntries(std::string_view contents) {
+    if (contents.empty()) {
+        return;
+    }
+
+    BinaryReader reader(contents);
+    if (reader.readBytes(sizeof(MAGIC)) != std::string_view(MAGIC, sizeof(MAGIC)) ||
+            reader.read<uint32_t>() != Snapshot::VERSION) {
+        throw std::runtime_error("Not a snapshot of this version");
+    }
+
+    uint32_t numEntries = reader.read<uint32_t>();
+    for (uint32_t i = 0; i < numEntries; i++) {
+        std::string fileName(reader.readString());
+
+        Entry& entry = entries[fileName];
+        entry.fingerprint.size = reader.read<uint64_t>();
+        entry.fingerprint.modified = reader.read<int64_t>();
+        entry.fingerprint.hash = reader.read<uint64_t>();
+        entry.type = static_cast<BethYw::SourceDataType>(reader.read<uint32_t>());
+        entry.bytes = reader.readBytes(reader.read<uint64_t>());
+    }
+
+    if (!reader.atEnd()) {
+        throw std::runtime_error("Snapshot has trailing data");
+    }
+}
+
+/*
+  Retrieve the Areas object stored for a dataset file, if the snapshot has one
+  for a file with the same fingerprint and type.
+
+  @param fileName
+    The name of the dataset file
+
+  @param fingerprint
+    The fingerprint of the dataset file as it is now
+
+  @param type
+    The type of the dataset
+
+  @param areas
+    An empty Areas object to populate with the stored data
+
+  @return
+    true if `areas` was populated from the snapshot, false if the file has to
+    be parsed instead (in which case `areas` is left empty)
+*/
+bool Snapshot::load(const std::string& fileName, const FileFingerprint& fingerprint,
+                    const BethYw::SourceDataType& type, Areas& areas) const {
+    auto it = entries.find(fileName);
+    if (it == entries.end() || !(it->second.fingerprint == fingerprint) || it->second.type != type) {
+        return false;
+    }
+
+    try {
+        Snapshot::readAreas(it->second.bytes, areas);
+        return true;
+    } catch (const std::runtime_error& ex) {
+        areas = Areas();
+        return false;
+    }
+}
+
+/*
+  Add or replace the Areas object stored for a dataset file.
+
+  @param fileName
+    The name of the dataset file
+
+  @param fingerprint
+    The fingerprint of the dataset file the Areas object was populated from
+
+  @param type
+    The type of the dataset
+
+  @param areas
+    The Areas object populated from the file without any filters
+*/
+void Snapshot::store(const std::string& fileName, const FileFingerprint& fingerprint,
+                     const BethYw::SourceDataType& type, const Areas& areas) {
+    Entry& entry = entries[fileName];
+    entry.fingerprint = fingerprint;
+    entry.type = type;
+    entry.encoded.clear();
+    Snapshot::writeAreas(entry.encoded, areas);
+    entry.bytes = entry.encoded;
+
+    changed = true;
+}
+
+/*
+  Retrieve the number of dataset files stored in the snapshot.
+
+  @return
+    The number of files
+*/
+int Snapshot::size() const noexcept {
+    return entries.size();
+}
+
+/*
+  Check if anything was stored since the snapshot was opened.
+
+  @return
+    true if the snapshot needs to be saved
+*/
+bool Snapshot::hasChanged() const noexcept {
+    return changed;
+}
+
+/*
+  Write the snapshot to its file. It is first written to a temporary file that
+  then replaces the old one, so that other runs of the program never see a half
+  written snapshot, and the memory we mapped the old one to stays valid.
+
+  @throws
+    std::runtime_error if the file can not be written
+*/
+void Snapshot::save() const {
+    std::string out(MAGIC, sizeof(MAGIC));
+    writeBinary<uint32_t>(out, Snapshot::VERSION);
+    writeBinary<uint32_t>(out, entries.size());
+
+    for (auto it = entries.begin(); it != entries.end(); it++) {
+        writeBinaryString(out, it->first);
+        writeBinary<uint64_t>(out, it->second.fingerprint.size);
+        writeBinary<int64_t>(out, it->second.fingerprint.modified);
+        writeBinary<uint64_t>(out, it->second.fingerprint.hash);
+        writeBinary<uint32_t>(out, it->second.type);
+        writeBinary<uint64_t>(out, it->second.bytes.size());
+        out.append(it->second.bytes);
+    }
+
+    try {
+        BethYw::replaceFile(path, out);
+    } catch (const std::runtime_error& ex) {
+        throw std::runtime_error(std::string("Snapshot::save: ") + ex.what());
+    }
+}
+
+/*Encodes an Areas object, with all its Area and Measure objects, at the end of the given string.*/
+void Snapshot::writeAreas(std::string& out, const Areas& areas) {
+    writeBinary<uint32_t>(out, areas.areas.size());
+
+    for (auto areaIt = areas.areas.begin(); areaIt != areas.areas.end(); areaIt++) {
+        const Area& area = areaIt->second;
+        writeBinaryString(out, areaIt->first);
+        writeBinaryString(out, area.authorityCode);
+
+        writeBinary<uint32_t>(out, area.names.size());
+        for (auto nameIt = area.names.begin(); nameIt != area.names.end(); nameIt++) {
+            writeBinaryString(out, nameIt->first);
+            writeBinaryString(out, nameIt->second);
+        }
+
+        writeBinary<uint32_t>(out, area.measures.size());
+        for (auto measureIt = area.measures.begin(); measureIt != area.measures.end(); measureIt++) {
+            const Measure& measure = measureIt->second;
+            writeBinaryString(out, BethYw::Intern::lookup(measureIt->first));
+            writeBinaryString(out, BethYw::Intern::lookup(measure.code));
+            writeBinaryString(out, BethYw::Intern::lookup(measure.label));
+
+            writeBinary<uint32_t>(out, measure.values.size());
+            for (auto valueIt = measure.values.begin(); valueIt != measure.values.end(); valueIt++) {
+                writeBinary<int32_t>(out, valueIt->first);
+                writeBinary<double>(out, valueIt->second);
+            }
+        }
+    }
+}
+
+/*Decodes an Areas object encoded by writeAreas() into the given (empty) Areas object.*/
+void Snapshot::readAreas(std::string_view bytes, Areas& areas) {
+    BinaryReader reader(bytes);
+
+    uint32_t numAreas = reader.read<uint32_t>();
+    for (uint32_t i = 0; i < numAreas; i++) {
+        std::pmr::string key(reader.readString(), areas.areas.get_allocator());
+        std::string_view authorityCode = reader.readString();
+        Area& area = areas.areas.try_emplace(std::move(key), authorityCode).first->second;
+
+        uint32_t numNames = reader.read<uint32_t>();
+        for (uint32_t j = 0; j < numNames; j++) {
+            std::pmr::string lang(reader.readString(), area.names.get_allocator());
+            area.names[std::move(lang)] = reader.readString();
+        }
+
+        uint32_t numMeasures = reader.read<uint32_t>();
+        for (uint32_t j = 0; j < numMeasures; j++) {
+            BethYw::Intern::Id measureKey = BethYw::Intern::intern(reader.readString());
+            std::string code(reader.readString());
+            std::string label(reader.readString());
+            Measure& measure = area.measures.try_emplace(measureKey, code, label).first->second;
+
+            uint32_t numValues = reader.read<uint32_t>();
+            for (uint32_t k = 0; k < numValues; k++) {
+                int32_t year = reader.read<int32_t>();
+                if (year < YearSeries::MIN_YEAR || year > YearSeries::MAX_YEAR) {
+                    throw std::runtime_error("Snapshot has an invalid year");
+                }
+                measure.values.set(year, reader.read<double>());
+            }
+        }
+    }
+
+    if (!reader.atEnd()) {
+        throw std::runtime_error("Snapshot has trailing data");
+    }
+}
@@ -0,0 +1,103 @@
+#ifndef SNAPSHOT_H_
+#define SNAPSHOT_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains the declaration of the Snapshot class, a binary cache of
+  parsed datasets that is kept on disk between runs of the program, so that
+  unchanged dataset files do not have to be parsed again.
+ */
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "areas.h"
+#include "datasets.h"
+#include "input.h"
+
+/*
+  Identifies the contents of a dataset file: a snapshot or index of a file is
+  only used if the file still has the same size, modification time and hash.
+*/
+struct FileFingerprint {
+    uint64_t size;
+    int64_t modified;
+    uint64_t hash;
+
+    static FileFingerprint of(const std::string& path, std::string_view contents);
+    static FileFingerprint sampled(const std::string& path, std::string_view contents);
+
+    bool operator==(const FileFingerprint& other) const noexcept;
+};
+
+/*
+  A Snapshot holds, for any number of dataset files, the Areas object that was
+  populated from the file without any filters, together with the fingerprint
+  of the file at that time.
+
+  The snapshot file is memory mapped when it is opened, and only the table of
+  files is read then. The Areas object of a file is only decoded when it is
+  asked for with load(), straight from the mapped memory.
+
+  All numbers are stored in the byte order of the machine, so a snapshot made
+  on one machine may be ignored (but is never misread) on another, as it will
+  not have the right magic number. The layout of the file is:
+
+    "BYWSNAP" magic number (8 bytes, including a terminating zero)
+    uint32  version
+    uint32  number of files
+    for each file:
+      string  file name
+      uint64  size, int64 modification time, uint64 hash
+      uint32  SourceDataType
+      uint64  length of the encoded Areas object, followed by that many bytes
+
+  where every string is stored as a uint32 length followed by its bytes. An
+  Areas object is stored as its number of Area objects, followed by each Area
+  (its key, local authority code, names and Measures), and each Measure as its
+  key, codename, label and year/value pairs.
+*/
+class Snapshot {
+private:
+    struct Entry {
+        FileFingerprint fingerprint;
+        BethYw::SourceDataType type;
+        //the encoded Areas object, either in the mapped file or in `encoded`
+        std::string_view bytes;
+        std::string encoded;
+    };
+
+    const std::string path;
+    std::unique_ptr<MmapInputFile> file;
+    std::map<std::string, Entry> entries;
+    bool changed;
+
+    void readEntries(std::string_view contents);
+
+    static void writeAreas(std::string& out, const Areas& areas);
+    static void readAreas(std::string_view bytes, Areas& areas);
+
+public:
+    static const uint32_t VERSION;
+
+    Snapshot(const std::string& path);
+
+    bool load(const std::string& fileName, const FileFingerprint& fingerprint,
+              const BethYw::SourceDataType& type, Areas& areas) const;
+    void store(const std::string& fileName, const FileFingerprint& fingerprint,
+               const BethYw::SourceDataType& type, const Areas& areas);
+
+    int size() const noexcept;
+    bool hasChanged() const noexcept;
+    void save() const;
+};
+
+#endif // SNAPSHOT_H_
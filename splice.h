@@ -0,0 +1,54 @@
+#ifndef SPLICE_H_
+#define SPLICE_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains the helper that Areas and Area use to merge one of their
+  containers into another without copying what is in it.
+ */
+
+#include <utility>
+
+namespace BethYw {
+
+    /*
+      Move every element of source into target, looking each key up once. The
+      elements whose key target does not have yet are added, and the others
+      are passed to merge(targetValue, std::move(sourceValue)).
+
+      If both containers use the same allocator, the nodes of source are
+      spliced into target as they are, so nothing is allocated or copied.
+      Otherwise the values are moved into new nodes of target. Either way,
+      source is left empty.
+
+      Container must be a std::map or std::unordered_map (or their pmr
+      versions).
+    */
+    template <typename Container, typename Merge>
+    void spliceOrMerge(Container& target, Container& source, Merge merge) {
+        if (target.get_allocator() == source.get_allocator()) {
+            while (!source.empty()) {
+                auto result = target.insert(source.extract(source.begin()));
+                if (!result.inserted) {
+                    merge(result.position->second, std::move(result.node.mapped()));
+                }
+            }
+        } else {
+            for (auto it = source.begin(); it != source.end(); it++) {
+                auto result = target.try_emplace(it->first, std::move(it->second));
+                if (!result.second) {
+                    merge(result.first->second, std::move(it->second));
+                }
+            }
+            source.clear();
+        }
+    }
+
+} // namespace BethYw
+
+#endif // SPLICE_H_
@@ -0,0 +1,403 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains the implementation of the StatsTable class.
+
+  The statistics of a measure take two passes over its values: the first
+  finds the smallest and largest values and the sums the means are worked out
+  from, and the second adds up the squared differences from the means, which
+  gives the variance and the slope without the loss of precision of adding
+  up squares of large values.
+
+  Both passes add up four partial sums, one for every fourth value, which are
+  then added together in a fixed order. The AVX2 kernel keeps the four sums in
+  one register, and is compiled for AVX2 on its own like the kernels in
+  csv.cpp, so the rest of the program still runs on any x86-64 processor. It
+  is not compiled for FMA, so the compiler can not fuse its multiplications
+  and additions and round them differently from the plain C++ kernel.
+*/
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BETHYW_STATS_X86
+#include <immintrin.h>
+#endif
+
+#include "stats.h"
+#include "areas.h"
+
+//the number of partial sums of each pass, which is the number of doubles in an AVX2 register
+static const std::size_t LANES = 4;
+
+/*The partial results of the first pass over a series.*/
+struct FirstPass {
+    double min[LANES];
+    double max[LANES];
+    double sumYears[LANES];
+    double sumValues[LANES];
+};
+
+/*The partial results of the second pass over a series.*/
+struct SecondPass {
+    double sumYearsSquared[LANES];
+    double sumProducts[LANES];
+    double sumValuesSquared[LANES];
+};
+
+/*Returns the first pass of a series with no values yet.*/
+static FirstPass startFirstPass() noexcept {
+    FirstPass pass;
+    for (std::size_t lane = 0; lane < LANES; lane++) {
+        pass.min[lane] = std::numeric_limits<double>::infinity();
+        pass.max[lane] = -std::numeric_limits<double>::infinity();
+        pass.sumYears[lane] = 0;
+        pass.sumValues[lane] = 0;
+    }
+    return pass;
+}
+
+/*Adds one year and value to the first pass. The comparisons are those of the AVX2 min and max instructions, which
+ * keep the second operand if either is NaN.*/
+static inline void firstStep(FirstPass& pass, std::size_t lane, double year, double value) noexcept {
+    pass.min[lane] = value < pass.min[lane] ? value : pass.min[lane];
+    pass.max[lane] = value > pass.max[lane] ? value : pass.max[lane];
+    pass.sumYears[lane] += year;
+    pass.sumValues[lane] += value;
+}
+
+/*Adds one year and value to the second pass.*/
+static inline void secondStep(SecondPass& pass, std::size_t lane, double year, double value, double meanYear,
+                              double meanValue) noexcept {
+    const double yearDifference = year - meanYear;
+    const double valueDifference = value - meanValue;
+    pass.sumYearsSquared[lane] += yearDifference * yearDifference;
+    pass.sumProducts[lane] += yearDifference * valueDifference;
+    pass.sumValuesSquared[lane] += valueDifference * valueDifference;
+}
+
+/*Adds up the partial sums, always in the same order.*/
+static inline double addLanes(const double lanes[LANES]) noexcept {
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+/*Works out the statistics from the results of both passes, and the first and last years and values.*/
+static MeasureStats finish(const FirstPass& first, const SecondPass& second, const double* years,
+                           const double* values, std::size_t count) noexcept {
+    MeasureStats stats = {0, 0, 0, 0, 0, 0};
+    if (count == 0) {
+        return stats;
+    }
+
+    stats.min = first.min[0];
+    stats.max = first.max[0];
+    for (std::size_t lane = 1; lane < LANES; lane++) {
+        stats.min = first.min[lane] < stats.min ? first.min[lane] : stats.min;
+        stats.max = first.max[lane] > stats.max ? first.max[lane] : stats.max;
+    }
+
+    stats.variance = addLanes(second.sumValuesSquared) / count;
+    stats.standardDeviation = std::sqrt(stats.variance);
+
+    const double sumYearsSquared = addLanes(second.sumYearsSquared);
+    if (sumYearsSquared > 0) {
+        stats.slope = addLanes(second.sumProducts) / sumYearsSquared;
+    }
+
+    const double span = years[count - 1] - years[0];
+    if (span > 0 && values[0] > 0 && values[count - 1] >= 0) {
+        stats.growth = (std::pow(values[count - 1] / values[0], 1 / span) - 1) * 100;
+    }
+
+    return stats;
+}
+
+/*Computes the statistics of a series one value at a time, for processors without AVX2.*/
+static MeasureStats seriesScalar(const double* years, const double* values, std::size_t count) noexcept {
+    FirstPass first = startFirstPass();
+    for (std::size_t i = 0; i < count; i++) {
+        firstStep(first, i % LANES, years[i], values[i]);
+    }
+
+    const double meanYear = addLanes(first.sumYears) / count;
+    const double meanValue = addLanes(first.sumValues) / count;
+
+    SecondPass second = {};
+    for (std::size_t i = 0; i < count; i++) {
+        secondStep(second, i % LANES, years[i], values[i], meanYear, meanValue);
+    }
+
+    return finish(first, second, years, values, count);
+}
+
+#ifdef BETHYW_STATS_X86
+
+/*Computes the statistics of a series four values at a time. The values left over at the end are added to the same
+ * partial sums the plain C++ kernel would add them to.*/
+__attribute__((target("avx2")))
+static MeasureStats seriesAVX2(const double* years, const double* values, std::size_t count) noexcept {
+    __m256d min = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+    __m256d max = _mm256_set1_pd(-std::numeric_limits<double>::infinity());
+    __m256d sumYears = _mm256_setzero_pd();
+    __m256d sumValues = _mm256_setzero_pd();
+
+    std::size_t i = 0;
+    for (; i + LANES <= count; i += LANES) {
+        const __m256d year = _mm256_loadu_pd(years + i);
+        const __m256d value = _mm256_loadu_pd(values + i);
+        min = _mm256_min_pd(value, min);
+        max = _mm256_max_pd(value, max);
+        sumYears = _mm256_add_pd(sumYears, year);
+        sumValues = _mm256_add_pd(sumValues, value);
+    }
+
+    FirstPass first;
+    _mm256_storeu_pd(first.min, min);
+    _mm256_storeu_pd(first.max, max);
+    _mm256_storeu_pd(first.sumYears, sumYears);
+    _mm256_storeu_pd(first.sumValues, sumValues);
+    for (; i < count; i++) {
+        firstStep(first, i % LANES, years[i], values[i]);
+    }
+
+    const double meanYear = addLanes(first.sumYears) / count;
+    const double meanValue = addLanes(first.sumValues) / count;
+    const __m256d meanYears = _mm256_set1_pd(meanYear);
+    const __m256d meanValues = _mm256_set1_pd(meanValue);
+
+    __m256d sumYearsSquared = _mm256_setzero_pd();
+    __m256d sumProducts = _mm256_setzero_pd();
+    __m256d sumValuesSquared = _mm256_setzero_pd();
+
+    i = 0;
+    for (; i + LANES <= count; i += LANES) {
+        const __m256d yearDifference = _mm256_sub_pd(_mm256_loadu_pd(years + i), meanYears);
+        const __m256d valueDifference = _mm256_sub_pd(_mm256_loadu_pd(values + i), meanValues);
+        sumYearsSquared = _mm256_add_pd(sumYearsSquared, _mm256_mul_pd(yearDifference, yearDifference));
+        sumProducts = _mm256_add_pd(sumProducts, _mm256_mul_pd(yearDifference, valueDifference));
+        sumValuesSquared = _mm256_add_pd(sumValuesSquared, _mm256_mul_pd(valueDifference, valueDifference));
+    }
+
+    SecondPass second;
+    _mm256_storeu_pd(second.sumYearsSquared, sumYearsSquared);
+    _mm256_storeu_pd(second.sumProducts, sumProducts);
+    _mm256_storeu_pd(second.sumValuesSquared, sumValuesSquared);
+    for (; i < count; i++) {
+        secondStep(second, i % LANES, years[i], values[i], meanYear, meanValue);
+    }
+
+    return finish(first, second, years, values, count);
+}
+
+#endif // BETHYW_STATS_X86
+
+/*
+  Construct an empty StatsTable.
+*/
+StatsTable::StatsTable() : years(), values(), offsets(1, 0), indexes(), results() {
+
+}
+
+/*
+  Copy the years and values of a Measure into the table, so that compute()
+  works out its statistics. A Measure that was already added is not added
+  again.
+
+  @param measure
+    The Measure to add, which must not be changed or destroyed while the
+    table is used
+*/
+void StatsTable::add(const Measure& measure) {
+    if (!indexes.emplace(&measure, offsets.size() - 1).second) {
+        return;
+    }
+
+    const std::size_t start = years.size();
+    years.resize(start + measure.values.size());
+    values.resize(start + measure.values.size());
+    measure.values.copyTo(years.data() + start, values.data() + start);
+
+    offsets.push_back(years.size());
+}
+
+/*
+  Add every Measure of every Area in an Areas object to the table.
+
+  @param areas
+    The Areas object whose measures to add, which must not be changed or
+    destroyed while the table is used
+
+  @example
+    StatsTable stats;
+    stats.add(areas);
+    stats.compute();
+    const MeasureStats* popStats = stats.find(areas.getArea("W06000011").getMeasure("pop"));
+*/
+void StatsTable::add(const Areas& areas) {
+    //everything is reserved up front, as there can be millions of measures
+    std::size_t numMeasures = indexes.size();
+    std::size_t numValues = years.size();
+    for (auto areaIt = areas.areas.begin(); areaIt != areas.areas.end(); areaIt++) {
+        const Area& area = areaIt->second;
+        numMeasures += area.measures.size();
+        for (auto measureIt = area.measures.begin(); measureIt != area.measures.end(); measureIt++) {
+            numValues += measureIt->second.values.size();
+        }
+    }
+    indexes.reserve(numMeasures);
+    offsets.reserve(numMeasures + 1);
+    years.reserve(numValues);
+    values.reserve(numValues);
+
+    for (auto areaIt = areas.areas.begin(); areaIt != areas.areas.end(); areaIt++) {
+        const Area& area = areaIt->second;
+        for (auto measureIt = area.measures.begin(); measureIt != area.measures.end(); measureIt++) {
+            add(measureIt->second);
+        }
+    }
+}
+
+/*
+  Compute the statistics of every Measure added to the table.
+
+  @param kernel
+    How to compute them, which must be supported by the processor; every
+    kernel gives exactly the same results
+*/
+void StatsTable::compute(Kernel kernel) {
+    results.resize(offsets.size() - 1);
+
+    for (std::size_t i = 0; i + 1 < offsets.size(); i++) {
+        results[i] = computeSeries(years.data() + offsets[i], values.data() + offsets[i],
+                                   offsets[i + 1] - offsets[i], kernel);
+    }
+}
+
+/*
+  Retrieve the number of Measure objects in the table.
+
+  @return
+    The number of measures added
+*/
+std::size_t StatsTable::size() const noexcept {
+    return indexes.size();
+}
+
+/*
+  Find the statistics of a Measure computed by compute().
+
+  @param measure
+    The Measure to find
+
+  @return
+    A pointer to its statistics, or nullptr if it was not added or they have
+    not been computed yet
+*/
+const MeasureStats* StatsTable::find(const Measure& measure) const noexcept {
+    auto it = indexes.find(&measure);
+    if (it == indexes.end() || it->second >= results.size()) {
+        return nullptr;
+    }
+
+    return &results[it->second];
+}
+
+/*
+  Get the fastest kernel the processor this program runs on supports.
+
+  @return
+    The kernel compute() uses by default
+*/
+StatsTable::Kernel StatsTable::bestKernel() noexcept {
+    static const Kernel best = supports(AVX2) ? AVX2 : SCALAR;
+    return best;
+}
+
+/*
+  Check whether a kernel can be used on the processor this program runs on.
+
+  @param kernel
+    The kernel to check
+
+  @return
+    true if the kernel was built into the program and the processor has the
+    instructions it needs
+*/
+bool StatsTable::supports(Kernel kernel) noexcept {
+    switch (kernel) {
+#ifdef BETHYW_STATS_X86
+        case AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+
+        case SCALAR:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+/*
+  Get the name of a kernel, e.g. for the output of benchmarks.
+
+  @param kernel
+    The kernel
+
+  @return
+    The name of the kernel, e.g. "AVX2"
+*/
+const char* StatsTable::kernelName(Kernel kernel) noexcept {
+    switch (kernel) {
+        case AVX2:
+            return "AVX2";
+
+        default:
+            return "scalar";
+    }
+}
+
+/*
+  Compute the statistics of one series of years and values.
+
+  @param years
+    The years, in ascending order
+
+  @param values
+    The value of each year
+
+  @param count
+    The number of years and values
+
+  @param kernel
+    How to compute them, which must be supported by the processor
+
+  @return
+    The statistics of the series, all 0 if it is empty
+
+  @example
+    const double years[] = {2010, 2011, 2012};
+    const double values[] = {100, 110, 121};
+    MeasureStats stats = StatsTable::computeSeries(years, values, 3, StatsTable::bestKernel());
+    // stats.min is 100, stats.max is 121 and stats.growth is 10
+*/
+MeasureStats StatsTable::computeSeries(const double* years, const double* values, std::size_t count,
+                                       Kernel kernel) noexcept {
+    switch (kernel) {
+#ifdef BETHYW_STATS_X86
+        case AVX2:
+            return seriesAVX2(years, values, count);
+#endif
+
+        default:
+            return seriesScalar(years, values, count);
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef STATS_H_
+#define STATS_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains the declaration of the StatsTable class, which computes
+  the statistics that --stats adds to the output for every Measure at once,
+  and of the vectorised kernels it computes them with.
+ */
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include "measure.h"
+
+class Areas;
+
+/*
+  The statistics of the values of one Measure, on top of the average and
+  differences Measure works out itself. Those that can not be calculated,
+  e.g. the slope of a measure with a single year, are 0.
+*/
+struct MeasureStats {
+    double min;
+    double max;
+    //the population variance, i.e. divided by the number of years
+    double variance;
+    double standardDeviation;
+    //the compound annual growth rate from the first to the last year, as a percentage like getDifferenceAsPercentage()
+    double growth;
+    //the slope of the least squares line through the values by year
+    double slope;
+};
+
+/*
+  A StatsTable copies the years and values of many Measure objects into two
+  contiguous arrays, one measure after the other, and then computes the
+  statistics of every measure in one pass over them. The values of a Measure
+  are spread over its YearSeries with gaps for the missing years, so copying
+  them out first lets the kernels read whole registers of values at a time.
+
+  The AVX2 kernel adds up four partial sums side by side, and the plain C++
+  kernel adds up the same four partial sums in the same order, so both give
+  exactly the same results and the output does not depend on the processor.
+*/
+class StatsTable {
+public:
+    //the ways of computing the statistics, from the slowest to the fastest
+    enum Kernel {
+        SCALAR,
+        AVX2
+    };
+
+private:
+    //the years and values of every measure added, one measure after the other
+    std::vector<double> years;
+    std::vector<double> values;
+    //where the years and values of each measure begin, and where those of the last one end
+    std::vector<std::size_t> offsets;
+    //the index of each measure in offsets and results
+    std::unordered_map<const Measure*, std::size_t> indexes;
+    std::vector<MeasureStats> results;
+
+public:
+    StatsTable();
+
+    void add(const Measure& measure);
+    void add(const Areas& areas);
+    void compute(Kernel kernel = bestKernel());
+
+    std::size_t size() const noexcept;
+    const MeasureStats* find(const Measure& measure) const noexcept;
+
+    static Kernel bestKernel() noexcept;
+    static bool supports(Kernel kernel) noexcept;
+    static const char* kernelName(Kernel kernel) noexcept;
+    static MeasureStats computeSeries(const double* years, const double* values, std::size_t count,
+                                      Kernel kernel) noexcept;
+};
+
+#endif // STATS_H_
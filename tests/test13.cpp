@@ -0,0 +1,86 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <string>
+
+#include "../areas.h"
+#include "../area.h"
+#include "../measure.h"
+
+SCENARIO( "values can be upserted into an Areas instance", "[Areas][upsert]" ) {
+
+  GIVEN( "a newly constructed Areas" ) {
+
+    Areas areas;
+
+    WHEN( "a value is upserted for an area that does not exist" ) {
+
+      REQUIRE_NOTHROW( areas.upsertValue("W06000011", "Swansea", "Pop", "Population", 2019, 246563) );
+
+      THEN( "the Area and Measure are created" ) {
+
+        REQUIRE( areas.size() == 1 );
+        REQUIRE( areas.getArea("W06000011").getName("eng") == "Swansea" );
+        REQUIRE( areas.getArea("W06000011").getMeasure("pop").getLabel() == "Population" );
+        REQUIRE( areas.getArea("W06000011").getMeasure("pop").getValue(2019) == 246563 );
+
+      } // THEN
+
+      AND_WHEN( "more values are upserted for the same area and measure" ) {
+
+        areas.upsertValue("W06000011", "City of Swansea", "POP", "Other label", 2018, 245480);
+        areas.upsertValue("W06000011", "City of Swansea", "pop", "Other label", 2019, 246993);
+
+        THEN( "they are merged into the existing Area and Measure" ) {
+
+          REQUIRE( areas.size() == 1 );
+          REQUIRE( areas.getArea("W06000011").size() == 1 );
+          REQUIRE( areas.getArea("W06000011").getName("eng") == "City of Swansea" );
+
+          Measure& measure = areas.getArea("W06000011").getMeasure("pop");
+          REQUIRE( measure.getLabel() == "Population" );
+          REQUIRE( measure.size() == 2 );
+          REQUIRE( measure.getValue(2018) == 245480 );
+          REQUIRE( measure.getValue(2019) == 246993 );
+
+        } // THEN
+
+      } // AND_WHEN
+
+    } // WHEN
+
+    AND_GIVEN( "an Area that was set with a Welsh name" ) {
+
+      Area area("W06000011");
+      area.setName("cym", "Abertawe");
+      areas.setArea("W06000011", area);
+
+      WHEN( "a value is upserted for that area" ) {
+
+        areas.upsertValue("W06000011", "Swansea", "dens", "Population density", 2019, 647.5);
+
+        THEN( "the existing names are kept alongside the English name" ) {
+
+          REQUIRE( areas.getArea("W06000011").getName("cym") == "Abertawe" );
+          REQUIRE( areas.getArea("W06000011").getName("eng") == "Swansea" );
+          REQUIRE( areas.getArea("W06000011").getMeasure("dens").getValue(2019) == 647.5 );
+
+        } // THEN
+
+      } // WHEN
+
+    } // AND_GIVEN
+
+  } // GIVEN
+
+} // SCENARIO
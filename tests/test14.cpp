@@ -0,0 +1,123 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <unordered_set>
+
+#include "../input.h"
+#include "../csv.h"
+#include "../areas.h"
+#include "../datasets.h"
+
+SCENARIO( "a source file can be memory mapped and read", "[MmapInputFile]" ) {
+
+  GIVEN( "a memory mapped existing file" ) {
+
+    const std::string test_file = "datasets/areas.csv";
+    MmapInputFile input(test_file);
+
+    THEN( "its contents are available as bytes and through a stream" ) {
+
+      REQUIRE( input.getSource() == test_file );
+      REQUIRE( std::string(input.bytes().substr(0, 20)) == "Local authority code" );
+
+      std::string firstLine;
+      std::getline(input.open(), firstLine);
+      REQUIRE( firstLine == "Local authority code,Name (eng),Name (cym)" );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "a memory mapped file that does not exist" ) {
+
+    const std::string test_file = "datasets/doesnotexist.csv";
+    MmapInputFile input(test_file);
+
+    THEN( "opening it throws the same exception as InputFile" ) {
+
+      REQUIRE_THROWS_AS( input.open(), std::runtime_error );
+      REQUIRE_THROWS_WITH( input.open(), "InputFile::open: Failed to open file " + test_file );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "CSV text can be split into rows and fields", "[CsvTokenizer]" ) {
+
+  GIVEN( "CSV text with both kinds of line endings and a trailing comma" ) {
+
+    CsvTokenizer csv("a,b\r\nc,,d,\n");
+
+    THEN( "the rows and fields are returned without line endings" ) {
+
+      std::string_view field;
+
+      REQUIRE( csv.nextRow() );
+      REQUIRE( std::string(csv.row()) == "a,b" );
+      REQUIRE( csv.nextField(field) );
+      REQUIRE( std::string(field) == "a" );
+      REQUIRE( csv.nextField(field) );
+      REQUIRE( std::string(field) == "b" );
+      REQUIRE_FALSE( csv.nextField(field) );
+
+      REQUIRE( csv.nextRow() );
+      REQUIRE( csv.nextField(field) );
+      REQUIRE( std::string(field) == "c" );
+      REQUIRE( csv.nextField(field) );
+      REQUIRE( field.empty() );
+      REQUIRE( csv.nextField(field) );
+      REQUIRE( std::string(field) == "d" );
+      REQUIRE_FALSE( csv.nextField(field) );
+
+      REQUIRE_FALSE( csv.nextRow() );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "an authority by year CSV file can be filtered by years", "[Areas][authorityByYearCSV]" ) {
+
+  GIVEN( "a CSV file with values for four years" ) {
+
+    std::stringstream stream("AuthorityCode,2001,2002,2003,2004\nW06000011,1,2,3,4\n");
+    Areas areas;
+
+    WHEN( "only the last two years are imported" ) {
+
+      const std::unordered_set<std::string> noFilter;
+      const std::tuple<unsigned int, unsigned int> years(2003, 2004);
+
+      areas.populateFromAuthorityByYearCSV(stream, BethYw::InputFiles::COMPLETE_POP.COLS,
+                                           &noFilter, &noFilter, &years);
+
+      THEN( "each value is imported for its own year" ) {
+
+        Measure& measure = areas.getArea("W06000011").getMeasure("pop");
+        REQUIRE( measure.size() == 2 );
+        REQUIRE( measure.getValue(2003) == 3 );
+        REQUIRE( measure.getValue(2004) == 4 );
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+} // SCENARIO
@@ -0,0 +1,107 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <cstdio>
+#include <string>
+#include <tuple>
+#include <unordered_set>
+
+#include "../input.h"
+#include "../areas.h"
+#include "../datasets.h"
+#include "../snapshot.h"
+
+SCENARIO( "parsed datasets can be kept in a snapshot file", "[Snapshot]" ) {
+
+  const std::string snapshot_file = "tests/test15.snapshot";
+  std::remove(snapshot_file.c_str());
+
+  GIVEN( "a snapshot holding the unfiltered popden dataset" ) {
+
+    const auto& dataset = BethYw::InputFiles::DATASETS[0];
+    const std::string test_file = "datasets/" + dataset.FILE;
+
+    MmapInputFile input(test_file);
+    Areas parsed;
+    parsed.populate(input.open(), dataset.PARSER, dataset.COLS, nullptr, nullptr, nullptr);
+    const FileFingerprint fingerprint = FileFingerprint::of(test_file, input.bytes());
+
+    {
+      Snapshot snapshot(snapshot_file);
+      REQUIRE( snapshot.size() == 0 );
+
+      snapshot.store(dataset.FILE, fingerprint, dataset.PARSER, parsed);
+      REQUIRE( snapshot.hasChanged() );
+      snapshot.save();
+    }
+
+    Snapshot snapshot(snapshot_file);
+
+    THEN( "the dataset is read back from the file unchanged" ) {
+
+      REQUIRE( snapshot.size() == 1 );
+      REQUIRE_FALSE( snapshot.hasChanged() );
+
+      Areas loaded;
+      REQUIRE( snapshot.load(dataset.FILE, fingerprint, dataset.PARSER, loaded) );
+      REQUIRE( loaded.toJSON() == parsed.toJSON() );
+
+    } // THEN
+
+    THEN( "filtering the snapshot gives the same result as parsing with the filters" ) {
+
+      const std::unordered_set<std::string> areasFilter = {"W06000011", "W06000024"};
+      const std::unordered_set<std::string> measuresFilter = {"pop"};
+      const std::tuple<unsigned int, unsigned int> yearsFilter(2010, 2015);
+
+      Areas filtered;
+      filtered.populate(input.open(), dataset.PARSER, dataset.COLS, &areasFilter, &measuresFilter, &yearsFilter);
+
+      Areas loaded;
+      REQUIRE( snapshot.load(dataset.FILE, fingerprint, dataset.PARSER, loaded) );
+      Areas merged;
+      merged.mergeFiltered(loaded, dataset.PARSER, &areasFilter, &measuresFilter, &yearsFilter);
+
+      REQUIRE( merged.size() == 1 );
+      REQUIRE( merged.toJSON() == filtered.toJSON() );
+
+    } // THEN
+
+    THEN( "the dataset is not used once the file has changed" ) {
+
+      FileFingerprint changed = fingerprint;
+      changed.hash++;
+
+      Areas loaded;
+      REQUIRE_FALSE( snapshot.load(dataset.FILE, changed, dataset.PARSER, loaded) );
+      REQUIRE( loaded.size() == 0 );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "a file that is not a snapshot" ) {
+
+    Snapshot snapshot("datasets/areas.csv");
+
+    THEN( "it is treated as an empty snapshot" ) {
+
+      REQUIRE( snapshot.size() == 0 );
+
+    } // THEN
+
+  } // GIVEN
+
+  std::remove(snapshot_file.c_str());
+
+} // SCENARIO
@@ -0,0 +1,213 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <climits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "../measure.h"
+#include "../yearseries.h"
+
+SCENARIO( "a YearSeries stores values by year like an ordered map", "[YearSeries]" ) {
+
+  GIVEN( "an empty YearSeries" ) {
+
+    YearSeries series;
+
+    THEN( "it has no values" ) {
+
+      REQUIRE( series.empty() );
+      REQUIRE( series.size() == 0 );
+      REQUIRE( series.begin() == series.end() );
+      REQUIRE( series.find(2010) == nullptr );
+
+    } // THEN
+
+    WHEN( "values are set out of order, with a gap between them" ) {
+
+      series.set(2015, 15);
+      series.set(2010, 10);
+      series.set(2012, 12);
+      series.set(2008, 8);
+
+      THEN( "only the years that were set have a value" ) {
+
+        REQUIRE( series.size() == 4 );
+        REQUIRE( series.contains(2008) );
+        REQUIRE( series.contains(2015) );
+        REQUIRE_FALSE( series.contains(2009) );
+        REQUIRE_FALSE( series.contains(2007) );
+        REQUIRE_FALSE( series.contains(2016) );
+        REQUIRE( *series.find(2012) == 12 );
+
+      } // THEN
+
+      THEN( "the years are iterated over in ascending order" ) {
+
+        std::vector<std::pair<int, double>> pairs(series.begin(), series.end());
+        std::vector<std::pair<int, double>> expected = {{2008, 8}, {2010, 10}, {2012, 12}, {2015, 15}};
+
+        REQUIRE( pairs == expected );
+
+      } // THEN
+
+      THEN( "the first and last values and the sum are those of the years set" ) {
+
+        REQUIRE( series.firstYear() == 2008 );
+        REQUIRE( series.lastYear() == 2015 );
+        REQUIRE( series.front() == 8 );
+        REQUIRE( series.back() == 15 );
+        REQUIRE( series.sum() == 45 );
+
+      } // THEN
+
+      AND_WHEN( "a year is set again" ) {
+
+        series.set(2010, 100);
+
+        THEN( "its value is replaced without adding a year" ) {
+
+          REQUIRE( series.size() == 4 );
+          REQUIRE( *series.find(2010) == 100 );
+
+        } // THEN
+
+      } // AND_WHEN
+
+      THEN( "it is equal to a series with the same values set in another order" ) {
+
+        YearSeries other;
+        other.set(2008, 8);
+        other.set(2010, 10);
+        other.set(2012, 12);
+        other.set(2015, 15);
+
+        REQUIRE( series == other );
+
+        other.set(2011, 11);
+        REQUIRE_FALSE( series == other );
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+/*Adds up the values of a series in ascending order of year, as YearSeries::sum() used to on every call.*/
+static double sumInOrder(const YearSeries& series) {
+  double total = 0;
+  for (auto it = series.begin(); it != series.end(); it++) {
+    total += it->second;
+  }
+  return total;
+}
+
+SCENARIO( "a YearSeries keeps the sum of its values up to date", "[YearSeries]" ) {
+
+  GIVEN( "values whose sum depends on the order they are added up in" ) {
+
+    YearSeries series;
+    unsigned long seed = 7;
+
+    WHEN( "they are set in any order, replacing some of them, and other series are merged in" ) {
+
+      THEN( "the sum is always exactly that of the values added up in ascending order of year" ) {
+
+        for (unsigned int i = 0; i < 2000; i++) {
+          seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+          const int year = 1990 + static_cast<int>((seed >> 33) % 40) + (i < 500 ? static_cast<int>(i) : 0);
+          const double value = ((seed >> 20) % 100000) / 7.0 - 5000;
+
+          if (i % 100 == 99) {
+            YearSeries other;
+            other.set(year, value);
+            other.set(year + 3, value * 1e9);
+            series.merge(other);
+          } else {
+            series.set(year, value);
+          }
+
+          REQUIRE( series.sum() == sumInOrder(series) );
+        }
+
+        YearSeries copy = series;
+        YearSeries moved = std::move(copy);
+
+        REQUIRE( moved.sum() == sumInOrder(series) );
+        REQUIRE( copy.sum() == 0 );
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "a YearSeries only stores years of up to 4 digits", "[YearSeries][Measure]" ) {
+
+  GIVEN( "a YearSeries and a Measure" ) {
+
+    YearSeries series;
+    Measure measure("pop", "Population");
+
+    WHEN( "the first and last years that can be set are set" ) {
+
+      series.set(YearSeries::MIN_YEAR, 1);
+      series.set(YearSeries::MAX_YEAR, 2);
+      measure.setValue(1, 3);
+      measure.setValue(9999, 4);
+
+      THEN( "both have a value" ) {
+
+        REQUIRE( series.size() == 2 );
+        REQUIRE( series.firstYear() == 0 );
+        REQUIRE( series.lastYear() == 9999 );
+        REQUIRE( measure.getValue(1) == 3 );
+        REQUIRE( measure.getValue(9999) == 4 );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "years just outside of that range, or that do not fit in an int, are set" ) {
+
+      series.set(2010, 1);
+      measure.setValue(2010, 1);
+
+      THEN( "an exception is thrown and the values are unchanged" ) {
+
+        REQUIRE_THROWS_AS( series.set(-1, 2), std::out_of_range );
+        REQUIRE_THROWS_AS( series.set(10000, 2), std::out_of_range );
+        REQUIRE_THROWS_AS( series.set(INT_MIN, 2), std::out_of_range );
+        REQUIRE_THROWS_AS( series.set(INT_MAX, 2), std::out_of_range );
+        REQUIRE_THROWS_AS( measure.setValue(10000, 2), std::out_of_range );
+        REQUIRE_THROWS_AS( measure.setValue(UINT_MAX, 2), std::out_of_range );
+        REQUIRE_THROWS_AS( measure.setValue(static_cast<unsigned int>(INT_MAX) + 1, 2), std::out_of_range );
+
+        REQUIRE( series.size() == 1 );
+        REQUIRE( series.firstYear() == 2010 );
+        REQUIRE( series.lastYear() == 2010 );
+        REQUIRE( measure.size() == 1 );
+        REQUIRE( measure.getValue(2010) == 1 );
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+} // SCENARIO
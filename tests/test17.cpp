@@ -0,0 +1,93 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <string>
+#include <unordered_set>
+
+#include "../filter.h"
+
+SCENARIO( "a filter is compiled into a matcher", "[FilterMatcher]" ) {
+
+  GIVEN( "a null or empty filter" ) {
+
+    const std::unordered_set<std::string> filter;
+
+    THEN( "all data is included" ) {
+
+      REQUIRE( FilterMatcher(nullptr, FilterMatcher::UPPER).matches("W06000011") );
+      REQUIRE( FilterMatcher(&filter, FilterMatcher::UPPER).matches("") );
+      REQUIRE( FilterMatcher(&filter, FilterMatcher::LOWER).matchesAll() );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "an areas filter with an authority code and part of a name" ) {
+
+    const std::unordered_set<std::string> filter = {"W06000011", "SWAN"};
+    const FilterMatcher matcher(&filter, FilterMatcher::UPPER);
+
+    THEN( "data equal to one of the strings is included" ) {
+
+      REQUIRE( matcher.matches("W06000011") );
+
+    } // THEN
+
+    THEN( "data containing one of the strings is included, whatever its case" ) {
+
+      REQUIRE( matcher.matches("Swansea") );
+      REQUIRE( matcher.matches("xw06000011x") );
+
+    } // THEN
+
+    THEN( "other data is not included" ) {
+
+      REQUIRE_FALSE( matcher.matches("W06000012") );
+      REQUIRE_FALSE( matcher.matches("Cardiff") );
+      REQUIRE_FALSE( matcher.matches("SWA") );
+      REQUIRE_FALSE( matcher.matches("") );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "a filter whose strings overlap each other" ) {
+
+    const std::unordered_set<std::string> filter = {"abcd", "bce", "cx"};
+    const FilterMatcher matcher(&filter, FilterMatcher::LOWER);
+
+    THEN( "a string is found after a partial match of another one fails" ) {
+
+      REQUIRE( matcher.matches("abce") );
+      REQUIRE( matcher.matches("ABCX") );
+      REQUIRE( matcher.matches("ababcd") );
+      REQUIRE_FALSE( matcher.matches("abcbc") );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "a filter with strings in another case than the data is folded to" ) {
+
+    const std::unordered_set<std::string> filter = {"pop"};
+    const FilterMatcher matcher(&filter, FilterMatcher::UPPER);
+
+    THEN( "the strings of the filter are not folded" ) {
+
+      REQUIRE_FALSE( matcher.matches("pop") );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
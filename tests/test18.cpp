@@ -0,0 +1,84 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <string>
+
+#include "../lib_json.hpp"
+#include "../areas.h"
+#include "../area.h"
+#include "../measure.h"
+
+SCENARIO( "Areas are written as JSON without building a JSON object", "[Areas][writeJSON]" ) {
+
+  GIVEN( "an Areas instance with names and values that need escaping or special formatting" ) {
+
+    Areas areas;
+
+    Area swansea("W06000011");
+    swansea.setName("eng", "Swansea \"City\"\tand\\County");
+    swansea.setName("cym", "Abertawe\n");
+    Measure pop("pop", "Population");
+    pop.setValue(2015, 239000);
+    pop.setValue(2016, 0.1);
+    pop.setValue(2018, -0.0);
+    pop.setValue(2019, 1e22);
+    swansea.setMeasure("pop", pop);
+    areas.setArea("W06000011", swansea);
+
+    Area anglesey("W06000001");
+    anglesey.setName("eng", "Isle of Anglesey");
+    anglesey.setName("cym", "Ynys M\xC3\xB4n");
+    areas.setArea("W06000001", anglesey);
+
+    Area measuresOnly("W06000002");
+    Measure odd("odd", "Years with different numbers of digits");
+    odd.setValue(999, 1.5);
+    odd.setValue(1000, 2.5);
+    odd.setValue(20, std::numeric_limits<double>::quiet_NaN());
+    measuresOnly.setMeasure("odd", odd);
+    measuresOnly.setMeasure("none", Measure("none", "No values"));
+    areas.setArea("W06000002", measuresOnly);
+
+    areas.setArea("W06000003", Area("W06000003"));
+
+    THEN( "the text is the same as dumping a JSON object of it" ) {
+
+      json j;
+      to_json(j, areas);
+
+      REQUIRE( areas.toJSON() == j.dump() );
+
+      std::ostringstream stream;
+      areas.writeJSON(stream);
+      REQUIRE( stream.str() == j.dump() );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "an empty Areas instance" ) {
+
+    Areas areas;
+
+    THEN( "it is written as an empty object" ) {
+
+      REQUIRE( areas.toJSON() == "{}" );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
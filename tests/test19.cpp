@@ -0,0 +1,58 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <sstream>
+#include <string>
+
+#include "../measure.h"
+
+SCENARIO( "a Measure is printed as a table", "[Measure][table]" ) {
+
+  GIVEN( "a Measure whose first value is 0" ) {
+
+    Measure measure("pop", "Population");
+    measure.setValue(2010, 0);
+    measure.setValue(2011, 25);
+
+    THEN( "the infinite percentage difference is printed instead of failing" ) {
+
+      std::ostringstream stream;
+      REQUIRE_NOTHROW( stream << measure );
+      REQUIRE( stream.str() ==
+               "Population (pop) \n"
+               "    2010      2011   Average     Diff.   % Diff. \n"
+               "0.000000 25.000000 12.500000 25.000000       inf \n" );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "a Measure with a value just below a power of ten" ) {
+
+    Measure measure("pop", "Population");
+    measure.setValue(2010, 999.9999999);
+
+    THEN( "the value rounded up to the next power of ten is cut to its column as it always was" ) {
+
+      std::ostringstream stream;
+      stream << measure;
+      REQUIRE( stream.str() ==
+               "Population (pop) \n"
+               "      2010    Average    Diff.  % Diff. \n"
+               "1000.0000001000.0000000.000000 0.000000 \n" );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
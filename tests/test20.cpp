@@ -0,0 +1,79 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <sstream>
+#include <string>
+#include <unordered_set>
+
+#include "../lib_json.hpp"
+#include "../areas.h"
+#include "../datasets.h"
+#include "../input.h"
+#include "../profile.h"
+
+SCENARIO( "phases of the program can be profiled", "[Profile]" ) {
+
+  GIVEN( "profiling is turned on" ) {
+
+    BethYw::Profile::enable();
+
+    WHEN( "areas.csv is imported with a filter in a phase" ) {
+
+      const std::unordered_set<std::string> filter = {"W06000011", "W06000024"};
+      const std::string test_file = "datasets/areas.csv";
+
+      BethYw::Profile::Phase* phase = BethYw::Profile::addPhase("test20");
+      REQUIRE( phase != nullptr );
+
+      {
+        BethYw::Profile::Scope scope(phase);
+        REQUIRE( BethYw::Profile::current == phase );
+
+        MmapInputFile input(test_file);
+        Areas areas;
+        areas.populate(input.open(), BethYw::AuthorityCodeCSV, BethYw::InputFiles::AREAS.COLS, &filter);
+      }
+
+      THEN( "the rows, bytes and allocations are counted in the phase" ) {
+
+        REQUIRE( BethYw::Profile::current == nullptr );
+        REQUIRE( phase->rowsParsed == 22 );
+        REQUIRE( phase->rowsFilteredOut == 20 );
+        REQUIRE( phase->bytesRead == MmapInputFile(test_file).bytes().size() );
+        REQUIRE( phase->allocations > 0 );
+        REQUIRE( phase->seconds > 0 );
+
+      } // THEN
+
+      THEN( "the phase is in the JSON report" ) {
+
+        std::ostringstream stream;
+        BethYw::Profile::report(stream, true);
+        json report = json::parse(stream.str());
+
+        bool found = false;
+        for (auto& entry : report["phases"]) {
+          if (entry["name"] == "test20") {
+            found = true;
+            REQUIRE( entry["rowsParsed"] == 22 );
+          }
+        }
+        REQUIRE( found );
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+} // SCENARIO
@@ -0,0 +1,133 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+#include <unistd.h>
+
+#include "../areas.h"
+#include "../bethyw.h"
+#include "../datasets.h"
+#include "../intern.h"
+#include "../server.h"
+
+SCENARIO( "a QueryServer answers queries like bethyw does", "[QueryServer]" ) {
+
+  GIVEN( "a QueryServer with the bundled datasets loaded" ) {
+
+    QueryServer server(std::string("datasets") + DIR_SEP, 1);
+
+    WHEN( "a query with filters is answered" ) {
+
+      std::ostringstream out, err;
+      int code = server.query({"bethyw", "-d", "popden,trains", "-a", "W06000011,W06000024",
+                               "-m", "pop,rail", "-y", "2010-2015", "-j"}, out, err);
+
+      THEN( "the output is the same as loading the datasets with the filters" ) {
+
+        const std::unordered_set<std::string> areasFilter = {"W06000011", "W06000024"};
+        const std::unordered_set<std::string> measuresFilter = {"pop", "rail"};
+        const std::tuple<unsigned int, unsigned int> yearsFilter(2010, 2015);
+        std::vector<BethYw::InputFileSource> datasets = {*BethYw::getInputSource("popden"),
+                                                         *BethYw::getInputSource("trains")};
+
+        Areas areas;
+        BethYw::loadAreas(areas, std::string("datasets") + DIR_SEP, areasFilter);
+        BethYw::loadDatasets(areas, std::string("datasets") + DIR_SEP, datasets, areasFilter, measuresFilter,
+                             yearsFilter);
+
+        REQUIRE( code == 0 );
+        REQUIRE( err.str() == "" );
+        REQUIRE( out.str() == areas.toJSON() + "\n" );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "a query has an invalid argument" ) {
+
+      std::ostringstream out, err;
+      int code = server.query({"bethyw", "-d", "invalidataset"}, out, err);
+
+      THEN( "the error is reported like bethyw does" ) {
+
+        REQUIRE( code == 1 );
+        REQUIRE( out.str() == "" );
+        REQUIRE( err.str() == "No dataset matches key: invalidataset" );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "many different queries are answered" ) {
+
+      const std::size_t internedBefore = BethYw::Intern::size();
+
+      for (int i = 0; i < 50; i++) {
+        std::ostringstream out, err;
+        const std::string suffix = std::to_string(i);
+        server.query({"bethyw", "-a", "W0600" + suffix + ",Area " + suffix, "-m", "made-up-" + suffix, "-j"}, out,
+                     err);
+        server.query({"bethyw", "-d", "popden", "-y", std::to_string(1990 + i), "--stats"}, out, err);
+        server.query({"bethyw", "-d", "popden", "--top", suffix + "1", "--by", "growth", "-j"}, out, err);
+      }
+
+      THEN( "no string is added to the intern table, so it is bounded by the loaded data" ) {
+
+        REQUIRE( BethYw::Intern::size() == internedBefore );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "a query is sent over a socket" ) {
+
+      const std::string socketPath = "/tmp/bethyw-test21-" + std::to_string(getpid()) + ".sock";
+      server.listen(socketPath);
+      std::thread serving([&]() {
+        server.serve(2);
+      });
+
+      std::ostringstream out, err, expectedOut, expectedErr;
+      const std::vector<std::string> query = {"bethyw", "-d", "aqi", "-a", "swan"};
+      int code = BethYw::forwardQuery(socketPath, query, out, err);
+      int expectedCode = server.query(query, expectedOut, expectedErr);
+
+      server.stop();
+      serving.join();
+
+      THEN( "the response is the same as answering the query directly" ) {
+
+        REQUIRE( code == expectedCode );
+        REQUIRE( out.str() == expectedOut.str() );
+        REQUIRE( err.str() == expectedErr.str() );
+        REQUIRE( out.str().find("Swansea") != std::string::npos );
+
+      } // THEN
+
+      THEN( "the socket is removed once the server stops" ) {
+
+        REQUIRE_THROWS_AS( BethYw::forwardQuery(socketPath, query, out, err), std::runtime_error );
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+} // SCENARIO
@@ -0,0 +1,167 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../area.h"
+#include "../intern.h"
+#include "../measure.h"
+
+SCENARIO( "strings can be interned", "[Intern]" ) {
+
+  GIVEN( "a string that is interned" ) {
+
+    const BethYw::Intern::Id id = BethYw::Intern::intern("test22-W06000011");
+
+    WHEN( "the same string is interned again" ) {
+
+      const std::string copy = "test22-W06000011";
+      const BethYw::Intern::Id again = BethYw::Intern::intern(copy);
+
+      THEN( "it has the same ID, which gives back the string" ) {
+
+        REQUIRE( again == id );
+        REQUIRE( BethYw::Intern::lookup(id) == copy );
+
+        BethYw::Intern::Id found;
+        REQUIRE( BethYw::Intern::find(copy, found) );
+        REQUIRE( found == id );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "a different string is interned" ) {
+
+      const BethYw::Intern::Id other = BethYw::Intern::intern("test22-w06000011");
+
+      THEN( "it has a different ID" ) {
+
+        REQUIRE( other != id );
+        REQUIRE( BethYw::Intern::lookup(other) == "test22-w06000011" );
+        REQUIRE( BethYw::Intern::lookup(id) == "test22-W06000011" );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "a string that was never interned is searched for" ) {
+
+      BethYw::Intern::Id found = 12345;
+      const std::size_t size = BethYw::Intern::size();
+
+      THEN( "it is not found and is not added" ) {
+
+        REQUIRE_FALSE( BethYw::Intern::find("test22-never-interned", found) );
+        REQUIRE( found == 12345 );
+        REQUIRE( BethYw::Intern::size() == size );
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+  GIVEN( "several threads interning the same strings at once" ) {
+
+    const unsigned int numThreads = 4;
+    const unsigned int numStrings = 2000;
+    std::vector<std::vector<BethYw::Intern::Id>> ids(numThreads);
+
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < numThreads; t++) {
+      threads.emplace_back([&ids, t]() {
+        for (unsigned int i = 0; i < numStrings; i++) {
+          ids[t].push_back(BethYw::Intern::intern("test22-thread-" + std::to_string(i)));
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    THEN( "every thread gets the same ID for each string" ) {
+
+      for (unsigned int t = 1; t < numThreads; t++) {
+        REQUIRE( ids[t] == ids[0] );
+      }
+
+      for (unsigned int i = 0; i < numStrings; i++) {
+        REQUIRE( BethYw::Intern::lookup(ids[0][i]) == "test22-thread-" + std::to_string(i) );
+      }
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "Area and Measure objects keep their codes in the intern table", "[Intern][Area][Measure]" ) {
+
+  GIVEN( "an Area made with a lowercase code, and a Measure with an uppercase codename" ) {
+
+    Area area("w06000011");
+    Measure measure("POP", "Population");
+    measure.setValue(2015, 100);
+
+    area.setMeasure("POP", measure);
+
+    THEN( "the codes are returned as the Area and Measure would have stored them" ) {
+
+      REQUIRE( area.getLocalAuthorityCode() == "W06000011" );
+      REQUIRE( measure.getCodename() == "pop" );
+      REQUIRE( measure.getLabel() == "Population" );
+      REQUIRE( area.getMeasure("pop").getValue(2015) == 100 );
+
+    } // THEN
+
+    THEN( "the Measure can be found with its codename in any case" ) {
+
+      REQUIRE( area.getMeasure("POP").getValue(2015) == 100 );
+      REQUIRE( area.getMeasure("Pop").getCodename() == "pop" );
+      REQUIRE_THROWS_AS( area.getMeasure("Popu"), std::out_of_range );
+
+    } // THEN
+
+    WHEN( "the label of the Measure is changed" ) {
+
+      measure.setLabel("Residents");
+
+      THEN( "only that Measure has the new label" ) {
+
+        REQUIRE( measure.getLabel() == "Residents" );
+        REQUIRE( area.getMeasure("pop").getLabel() == "Population" );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "an equal Area is made with an uppercase code" ) {
+
+      Area other("W06000011");
+      other.setMeasure("pop", measure);
+
+      THEN( "the two Areas are equal" ) {
+
+        REQUIRE( area == other );
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+} // SCENARIO
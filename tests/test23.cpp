@@ -0,0 +1,187 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../areas.h"
+#include "../datasets.h"
+#include "../jsonstream.h"
+
+SCENARIO( "a JsonRowSchema gives each key of a dataset a slot", "[JsonRowSchema]" ) {
+
+  GIVEN( "the schema of the AQI dataset, whose measure code and name are the same key" ) {
+
+    JsonRowSchema schema(BethYw::InputFiles::AQI.COLS,
+                         {BethYw::SourceColumn::AUTH_CODE, BethYw::SourceColumn::MEASURE_CODE,
+                          BethYw::SourceColumn::MEASURE_NAME, BethYw::SourceColumn::VALUE});
+
+    THEN( "the columns with the same key share a slot" ) {
+
+      REQUIRE( schema.size() == 3 );
+      REQUIRE( schema.slot(BethYw::SourceColumn::MEASURE_CODE) == schema.slot(BethYw::SourceColumn::MEASURE_NAME) );
+      REQUIRE( schema.find("Pollutant_ItemName_ENG") == schema.slot(BethYw::SourceColumn::MEASURE_CODE) );
+      REQUIRE( schema.key(schema.slot(BethYw::SourceColumn::VALUE)) == "Data" );
+
+    } // THEN
+
+    THEN( "keys and columns that are not part of it have no slot" ) {
+
+      REQUIRE( schema.find("Year_Code") == JsonRowSchema::NO_SLOT );
+      REQUIRE_THROWS_AS( schema.slot(BethYw::SourceColumn::YEAR), std::out_of_range );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "a column that is not in the dataset's mapping" ) {
+
+    THEN( "the schema can not be constructed" ) {
+
+      REQUIRE_THROWS_AS( JsonRowSchema(BethYw::InputFiles::TRAINS.COLS, {BethYw::SourceColumn::MEASURE_CODE}),
+                         std::out_of_range );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "a JsonRowReader fills the slots of each row", "[JsonRowReader]" ) {
+
+  GIVEN( "a schema with a code and a value" ) {
+
+    BethYw::SourceColumnMapping cols = {{BethYw::SourceColumn::AUTH_CODE, "Code"},
+                                        {BethYw::SourceColumn::VALUE, "Data"}};
+    JsonRowSchema schema(cols, {BethYw::SourceColumn::AUTH_CODE, BethYw::SourceColumn::VALUE});
+    const std::size_t codeSlot = schema.slot(BethYw::SourceColumn::AUTH_CODE);
+    const std::size_t valueSlot = schema.slot(BethYw::SourceColumn::VALUE);
+
+    std::vector<std::string> codes;
+    std::vector<double> values;
+    JsonRowReader reader(schema, [&](const JsonRow& row) {
+      codes.push_back(row.getString(codeSlot));
+      values.push_back(row.getNumber(valueSlot));
+    });
+
+    WHEN( "rows with numbers, numbers as strings, and other keys are read" ) {
+
+      std::istringstream is("{\"odata.metadata\": {\"Code\": \"X\"}, \"value\": ["
+                            "{\"Code\": \"W1\", \"Other\": {\"Code\": \"W9\", \"Data\": [1, 2]}, \"Data\": 1.5},"
+                            "{\"Data\": \"2.25\", \"Code\": \"W2\", \"Flag\": true},"
+                            "{\"Code\": \"W3\", \"Data\": 7}"
+                            "], \"odata.nextLink\": \"x\"}");
+      reader.parse(is);
+
+      THEN( "each row has the values of its own keys" ) {
+
+        REQUIRE( reader.foundRows() );
+        REQUIRE( codes == std::vector<std::string>({"W1", "W2", "W3"}) );
+        REQUIRE( values == std::vector<double>({1.5, 2.25, 7}) );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "a row does not have one of the keys" ) {
+
+      std::istringstream is("{\"value\": [{\"Code\": \"W1\", \"Data\": 1}, {\"Code\": \"W2\"}]}");
+
+      THEN( "a runtime_error naming the key is thrown" ) {
+
+        REQUIRE_THROWS_WITH( reader.parse(is), "Malformed JSON file! No value for key:Data" );
+        REQUIRE( values.size() == 1 );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "a key of the schema holds a value of the wrong type" ) {
+
+      std::istringstream is("{\"value\": [{\"Code\": 12, \"Data\": 1}]}");
+
+      THEN( "a runtime_error is thrown" ) {
+
+        REQUIRE_THROWS_AS( reader.parse(is), std::runtime_error );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "the file has no value array" ) {
+
+      std::istringstream is("{\"values\": [{\"Code\": \"W1\", \"Data\": 1}]}");
+      reader.parse(is);
+
+      THEN( "no rows are found" ) {
+
+        REQUIRE_FALSE( reader.foundRows() );
+        REQUIRE( codes.empty() );
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "single measure and string valued JSON datasets are imported", "[Areas][WelshStatsJSON]" ) {
+
+  GIVEN( "rows in the format of the trains dataset" ) {
+
+    std::istringstream is("{\"value\": [{\"LocalAuthority_Code\": \"W06000011\","
+                          "\"LocalAuthority_ItemName_ENG\": \"Swansea\", \"Year_Code\": \"2015\", \"Data\": 12}]}");
+
+    WHEN( "they are imported" ) {
+
+      Areas areas;
+      areas.populate(is, BethYw::WelshStatsJSON, BethYw::InputFiles::TRAINS.COLS, nullptr, nullptr, nullptr);
+
+      THEN( "the measure comes from the column mapping" ) {
+
+        Measure& measure = areas.getArea("W06000011").getMeasure("rail");
+        REQUIRE( measure.getLabel() == "Rail passenger journeys" );
+        REQUIRE( measure.getValue(2015) == 12 );
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+  GIVEN( "rows in the format of the AQI dataset" ) {
+
+    std::istringstream is("{\"value\": [{\"Area_Code\": \"W06000011\", \"Area_ItemName_ENG\": \"Swansea\","
+                          "\"Pollutant_ItemName_ENG\": \"NO2\", \"Year_Code\": \"2015\", \"Data\": \"10.5\"}]}");
+
+    WHEN( "they are imported" ) {
+
+      Areas areas;
+      areas.populate(is, BethYw::WelshStatsJSON, BethYw::InputFiles::AQI.COLS, nullptr, nullptr, nullptr);
+
+      THEN( "the values stored as strings are converted" ) {
+
+        Measure& measure = areas.getArea("W06000011").getMeasure("no2");
+        REQUIRE( measure.getLabel() == "NO2" );
+        REQUIRE( measure.getValue(2015) == 10.5 );
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+} // SCENARIO
@@ -0,0 +1,94 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <string>
+
+#include "../numbers.h"
+
+SCENARIO( "text is converted to real numbers", "[toDouble]" ) {
+
+  GIVEN( "text that is a number" ) {
+
+    double value = 0;
+
+    THEN( "it is converted" ) {
+
+      REQUIRE( BethYw::toDouble("12.5", value) );
+      REQUIRE( value == 12.5 );
+      REQUIRE( BethYw::toDouble("-3", value) );
+      REQUIRE( value == -3 );
+      REQUIRE( BethYw::toDouble("1e3", value) );
+      REQUIRE( value == 1000 );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "text that is not only a number" ) {
+
+    double value = 7;
+
+    THEN( "it is not converted and the value is unchanged" ) {
+
+      REQUIRE_FALSE( BethYw::toDouble("", value) );
+      REQUIRE_FALSE( BethYw::toDouble("12.5 ", value) );
+      REQUIRE_FALSE( BethYw::toDouble(" 12.5", value) );
+      REQUIRE_FALSE( BethYw::toDouble("12,5", value) );
+      REQUIRE_FALSE( BethYw::toDouble("abc", value) );
+      REQUIRE( value == 7 );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "text is converted to years", "[toYear]" ) {
+
+  GIVEN( "text that is a 4 digit year" ) {
+
+    unsigned int year = 0;
+
+    THEN( "it is converted" ) {
+
+      REQUIRE( BethYw::toYear("2015", year) );
+      REQUIRE( year == 2015 );
+      REQUIRE( BethYw::toYear("1000", year) );
+      REQUIRE( year == 1000 );
+      REQUIRE( BethYw::toYear("02015", year) );
+      REQUIRE( year == 2015 );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "text that is not a 4 digit year" ) {
+
+    unsigned int year = 7;
+
+    THEN( "it is not converted and the year is unchanged" ) {
+
+      REQUIRE_FALSE( BethYw::toYear("", year) );
+      REQUIRE_FALSE( BethYw::toYear("999", year) );
+      REQUIRE_FALSE( BethYw::toYear("0999", year) );
+      REQUIRE_FALSE( BethYw::toYear("10000", year) );
+      REQUIRE_FALSE( BethYw::toYear("20a5", year) );
+      REQUIRE_FALSE( BethYw::toYear("-201", year) );
+      REQUIRE_FALSE( BethYw::toYear("2015.5", year) );
+      REQUIRE( year == 7 );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
@@ -0,0 +1,151 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../bethyw.h"
+#include "../datasets.h"
+#include "../registry.h"
+#include "../server.h"
+
+/*Returns the codes of the given datasets, to compare them easily.*/
+static std::vector<std::string> codesOf(const std::vector<BethYw::InputFileSource>& datasets) {
+  std::vector<std::string> codes;
+  for (auto it = datasets.begin(); it != datasets.end(); it++) {
+    codes.push_back(it->CODE);
+  }
+  return codes;
+}
+
+SCENARIO( "a DatasetRegistry finds the datasets that can contribute to a query", "[DatasetRegistry]" ) {
+
+  GIVEN( "a registry of the bundled datasets" ) {
+
+    DatasetRegistry registry(std::string("datasets") + DIR_SEP);
+    std::vector<BethYw::InputFileSource> all(BethYw::InputFiles::DATASETS,
+                                             BethYw::InputFiles::DATASETS + BethYw::InputFiles::NUM_DATASETS);
+
+    WHEN( "there is no measures filter" ) {
+
+      THEN( "every dataset can contribute" ) {
+
+        REQUIRE( codesOf(registry.contributing(all, {})) == codesOf(all) );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "the filter is the measure of a single measure dataset" ) {
+
+      THEN( "only the datasets that have it are kept" ) {
+
+        REQUIRE( codesOf(registry.contributing(all, {"rail"})) == std::vector<std::string>({"trains"}) );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "the filter is pop" ) {
+
+      auto needed = codesOf(registry.contributing(all, {"pop"}));
+
+      THEN( "the datasets without pop in them are skipped without being loaded" ) {
+
+        REQUIRE( std::find(needed.begin(), needed.end(), "popden") != needed.end() );
+        REQUIRE( std::find(needed.begin(), needed.end(), "complete-pop") != needed.end() );
+        REQUIRE( std::find(needed.begin(), needed.end(), "aqi") == needed.end() );
+        REQUIRE( std::find(needed.begin(), needed.end(), "trains") == needed.end() );
+        REQUIRE_FALSE( registry.isLoaded(BethYw::InputFiles::AQI) );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "a dataset has been loaded" ) {
+
+      const Areas& first = registry.get(BethYw::InputFiles::BIZ);
+      const Areas& second = registry.get(BethYw::InputFiles::BIZ);
+
+      THEN( "it is loaded once, and its measures decide if it can contribute" ) {
+
+        REQUIRE( &first == &second );
+        REQUIRE( registry.isLoaded(BethYw::InputFiles::BIZ) );
+        REQUIRE( registry.contributing({BethYw::InputFiles::BIZ}, {"pop"}).empty() );
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+  GIVEN( "a registry of a directory without the datasets" ) {
+
+    DatasetRegistry registry("doesnotexist/");
+
+    THEN( "datasets that can not be checked are kept, and loading them fails" ) {
+
+      REQUIRE( registry.contributing({BethYw::InputFiles::AQI}, {"pop"}).size() == 1 );
+      REQUIRE( registry.contributing({BethYw::InputFiles::TRAINS}, {"pop"}).empty() );
+      REQUIRE_THROWS_AS( registry.get(BethYw::InputFiles::AQI), std::runtime_error );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "the text of a JSON file" ) {
+
+    StringFilterSet filter = {"no2"};
+    FilterMatcher matcher(&filter, FilterMatcher::LOWER);
+
+    THEN( "it may match only if the filter is in it, or it can not be sure" ) {
+
+      REQUIRE( DatasetRegistry::textMayMatch("{\"Code\": \"NO2\"}", matcher, filter) );
+      REQUIRE_FALSE( DatasetRegistry::textMayMatch("{\"Code\": \"PM10\"}", matcher, filter) );
+      REQUIRE( DatasetRegistry::textMayMatch("{\"Code\": \"\\u004eO2\"}", matcher, filter) );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "a lazy QueryServer answers queries like an eager one", "[QueryServer][DatasetRegistry]" ) {
+
+  GIVEN( "a lazy and an eager QueryServer with the bundled datasets" ) {
+
+    QueryServer lazy(std::string("datasets") + DIR_SEP, 1, true);
+    QueryServer eager(std::string("datasets") + DIR_SEP, 1);
+
+    THEN( "they give the same output" ) {
+
+      const std::vector<std::vector<std::string>> queries = {
+          {"bethyw", "-d", "all", "-m", "pop", "-j"},
+          {"bethyw", "-d", "all", "-a", "swan", "-m", "no2,rail", "-y", "2010-2015"},
+          {"bethyw", "-d", "aqi", "-m", "pop", "-j"},
+      };
+
+      for (auto it = queries.begin(); it != queries.end(); it++) {
+        std::ostringstream lazyOut, lazyErr, eagerOut, eagerErr;
+        REQUIRE( lazy.query(*it, lazyOut, lazyErr) == eager.query(*it, eagerOut, eagerErr) );
+        REQUIRE( lazyOut.str() == eagerOut.str() );
+        REQUIRE( lazyErr.str() == eagerErr.str() );
+      }
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
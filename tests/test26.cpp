@@ -0,0 +1,200 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <cstdio>
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+#include "../areas.h"
+#include "../datasets.h"
+#include "../input.h"
+#include "../jsonstream.h"
+#include "../rowindex.h"
+#include "../snapshot.h"
+
+/*Parses a dataset through the rows an index selects for the filters, like loadDatasets() does with --index.*/
+static Areas populateSelected(const RowIndex& index, std::string_view text, const BethYw::InputFileSource& dataset,
+                              const std::unordered_set<std::string>& areasFilter,
+                              const std::unordered_set<std::string>& measuresFilter) {
+  const std::string rows = index.selectedRows(text, &areasFilter, &measuresFilter);
+
+  MemoryStreamBuffer buffer;
+  buffer.reset(rows.data(), rows.size());
+  std::istream is(&buffer);
+
+  Areas areas;
+  areas.populate(is, dataset.PARSER, dataset.COLS, &areasFilter, &measuresFilter, nullptr);
+  return areas;
+}
+
+SCENARIO( "the rows of a StatsWales JSON file can be located without parsing them", "[JsonRowReader]" ) {
+
+  GIVEN( "a file whose strings contain brackets and escaped quotes, with a value key in its metadata" ) {
+
+    const std::string text = "{\"odata.metadata\": {\"value\": [{\"a\": 0}]}, \"note\": \"[{\\\"}\", \"value\": ["
+                             "{\"a\": \"}\\\\\"}, {\"b\": [1, {\"c\": 2}]}"
+                             "], \"odata.nextLink\": [{\"d\": 3}]}";
+
+    WHEN( "its rows are found" ) {
+
+      const std::vector<JsonRowSpan> rows = JsonRowReader::findRows(text);
+
+      THEN( "only the rows of the top level value array are found" ) {
+
+        REQUIRE( rows.size() == 2 );
+        REQUIRE( text.substr(rows[0].begin, rows[0].end - rows[0].begin) == "{\"a\": \"}\\\\\"}" );
+        REQUIRE( text.substr(rows[1].begin, rows[1].end - rows[1].begin) == "{\"b\": [1, {\"c\": 2}]}" );
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+  GIVEN( "a file with no value array" ) {
+
+    THEN( "no rows are found" ) {
+
+      REQUIRE( JsonRowReader::findRows("{\"values\": [{\"a\": 1}]}").empty() );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "a RowIndex narrows a dataset down to the rows that match the filters", "[RowIndex]" ) {
+
+  const std::string index_file = "tests/test26.index";
+  std::remove(index_file.c_str());
+
+  GIVEN( "the index of the AQI dataset" ) {
+
+    const BethYw::InputFileSource& dataset = BethYw::InputFiles::AQI;
+    const std::string test_file = "datasets/" + dataset.FILE;
+
+    MmapInputFile input(test_file);
+    input.open();
+    const FileFingerprint fingerprint = FileFingerprint::sampled(test_file, input.bytes());
+    const RowIndex index = RowIndex::build(input.bytes(), fingerprint, dataset.COLS);
+
+    REQUIRE( index.numRuns() > 0 );
+
+    WHEN( "the dataset is imported through it with areas and measures filters" ) {
+
+      const std::unordered_set<std::string> areasFilter = {"W06000011", "CARDIFF"};
+      const std::unordered_set<std::string> measuresFilter = {"no2", "pm"};
+
+      Areas filtered;
+      filtered.populate(input.open(), dataset.PARSER, dataset.COLS, &areasFilter, &measuresFilter, nullptr);
+
+      THEN( "the result is the same as parsing the whole file with the filters" ) {
+
+        REQUIRE( filtered.size() == 3 );
+        REQUIRE( populateSelected(index, input.bytes(), dataset, areasFilter, measuresFilter).toJSON() ==
+                 filtered.toJSON() );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "the filters match nothing" ) {
+
+      const std::unordered_set<std::string> areasFilter = {"W99999999"};
+
+      THEN( "nothing is imported" ) {
+
+        REQUIRE( populateSelected(index, input.bytes(), dataset, areasFilter, {}).size() == 0 );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "the index is saved and loaded again" ) {
+
+      index.save(index_file);
+
+      THEN( "it is loaded for the same fingerprint and selects the same rows" ) {
+
+        RowIndex loaded;
+        REQUIRE( RowIndex::load(index_file, fingerprint, loaded) );
+        REQUIRE( loaded.numRuns() == index.numRuns() );
+
+        const std::unordered_set<std::string> areasFilter = {"W06000011"};
+        REQUIRE( loaded.selectedRows(input.bytes(), &areasFilter, nullptr) ==
+                 index.selectedRows(input.bytes(), &areasFilter, nullptr) );
+
+      } // THEN
+
+      THEN( "it is not loaded for another fingerprint" ) {
+
+        FileFingerprint changed = fingerprint;
+        changed.hash++;
+
+        RowIndex loaded;
+        REQUIRE_FALSE( RowIndex::load(index_file, changed, loaded) );
+        REQUIRE( loaded.numRuns() == 0 );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "the text given to it is not the file it was built from" ) {
+
+      THEN( "a runtime_error is thrown" ) {
+
+        REQUIRE_THROWS_AS( index.selectedRows("{\"value\": []}", nullptr, nullptr), std::runtime_error );
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+  GIVEN( "an index file that is damaged" ) {
+
+    std::FILE* file = std::fopen(index_file.c_str(), "wb");
+    std::fputs("BYWINDX", file);
+    std::fclose(file);
+
+    THEN( "it is not loaded" ) {
+
+      RowIndex loaded;
+      REQUIRE_FALSE( RowIndex::load(index_file, FileFingerprint{0, 0, 0}, loaded) );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "the filters of a query" ) {
+
+    THEN( "only JSON datasets whose rows the filters can leave out are imported through an index" ) {
+
+      REQUIRE( RowIndex::canNarrow(BethYw::InputFiles::AQI, {"W06000011"}, {}) );
+      REQUIRE( RowIndex::canNarrow(BethYw::InputFiles::AQI, {}, {"no2"}) );
+      REQUIRE_FALSE( RowIndex::canNarrow(BethYw::InputFiles::AQI, {}, {}) );
+      REQUIRE_FALSE( RowIndex::canNarrow(BethYw::InputFiles::TRAINS, {}, {"rail"}) );
+      REQUIRE_FALSE( RowIndex::canNarrow(BethYw::InputFiles::COMPLETE_POPDEN, {"W06000011"}, {}) );
+
+    } // THEN
+
+  } // GIVEN
+
+  std::remove(index_file.c_str());
+
+} // SCENARIO
@@ -0,0 +1,247 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <istream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+#include "../areas.h"
+#include "../datasets.h"
+#include "../input.h"
+#include "../jsonstream.h"
+#include "../profile.h"
+
+/*Returns the text of every row of the chunks, found by wrapping each chunk in a value array of its own.*/
+static std::vector<std::string> rowsOfChunks(std::string_view text, const std::vector<JsonRowSpan>& chunks) {
+  std::vector<std::string> rows;
+  for (auto it = chunks.begin(); it != chunks.end(); it++) {
+    const std::string chunk = "{\"value\":[" + std::string(text.substr(it->begin, it->end - it->begin)) + "]}";
+    const std::vector<JsonRowSpan> spans = JsonRowReader::findRows(chunk);
+    for (auto span = spans.begin(); span != spans.end(); span++) {
+      rows.push_back(chunk.substr(span->begin, span->end - span->begin));
+    }
+  }
+  return rows;
+}
+
+/*Returns a file in the format of the popden dataset with the given number of rows, where the same areas, measures and
+ * years come back every few rows with other values, and the name of an area changes half way through.*/
+static std::string generatedFile(unsigned int numRows) {
+  std::string text = "{\"odata.metadata\": \"x\", \"value\": [\n";
+  for (unsigned int i = 0; i < numRows; i++) {
+    const std::string name = i < numRows / 2 ? "Area \\\"" + std::to_string(i % 7) + "\\\" {[" : "Area " + std::to_string(i % 7);
+    text += std::string(i == 0 ? "" : ",\n") + "  {\"Data\": " + std::to_string(i) + ".5, "
+            "\"Localauthority_Code\": \"W0600000" + std::to_string(i % 7) + "\", "
+            "\"Localauthority_ItemName_ENG\": \"" + name + "\", "
+            "\"Measure_Code\": \"M" + std::to_string(i % 3) + "\", "
+            "\"Measure_ItemName_ENG\": \"Measure " + std::to_string(i % 3) + "\", "
+            "\"Year_Code\": \"" + std::to_string(1990 + i % 11) + "\", \"Padding\": [{}, \"" + std::string(40, 'x') + "\"]}";
+  }
+  text += "\n], \"odata.nextLink\": {\"value\": \"y\"}}";
+  return text;
+}
+
+SCENARIO( "the rows of a StatsWales JSON file can be split into chunks", "[JsonRowReader]" ) {
+
+  GIVEN( "a file whose rows contain strings with brackets and escaped quotes" ) {
+
+    const std::string text = generatedFile(50);
+    const std::vector<JsonRowSpan> spans = JsonRowReader::findRows(text);
+
+    std::vector<std::string> rows;
+    for (auto it = spans.begin(); it != spans.end(); it++) {
+      rows.push_back(text.substr(it->begin, it->end - it->begin));
+    }
+
+    WHEN( "it is split into any number of chunks" ) {
+
+      THEN( "the chunks hold every row once, in order" ) {
+
+        REQUIRE( rows.size() == 50 );
+
+        for (std::size_t numChunks = 2; numChunks <= 64; numChunks++) {
+          const std::vector<JsonRowSpan> chunks = JsonRowReader::splitRows(text, numChunks, 3);
+
+          REQUIRE( chunks.size() > 1 );
+          REQUIRE( chunks.size() <= numChunks );
+          REQUIRE( rowsOfChunks(text, chunks) == rows );
+        }
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+  GIVEN( "files that can not be split safely" ) {
+
+    const std::string rows = "{\"a\": 1}, {\"a\": 2}, {\"a\": 3}, {\"a\": 4}";
+
+    THEN( "no chunks are returned" ) {
+
+      REQUIRE( JsonRowReader::splitRows("{\"values\": [" + rows + "]}", 4, 2).empty() );
+      REQUIRE( JsonRowReader::splitRows("{\"value\": []}", 4, 2).empty() );
+      REQUIRE( JsonRowReader::splitRows("{\"value\": [" + rows + "]", 4, 2).empty() );
+      REQUIRE( JsonRowReader::splitRows("{\"value\": [" + rows + "], \"value\": [{\"a\": 5}]}", 4, 2).empty() );
+      REQUIRE( JsonRowReader::splitRows("{\"value\": [" + rows + "]}", 1, 2).empty() );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "a ChainedStreamBuffer reads several blocks of memory as one", "[ChainedStreamBuffer]" ) {
+
+  GIVEN( "a stream reading a head, a part of some text and a tail, with an empty block between them" ) {
+
+    const std::string text = "xx{\"a\": 1}, {\"a\": 2}yy";
+    ChainedStreamBuffer buffer({"[", "", std::string_view(text).substr(2, text.size() - 4), "]"});
+    std::istream is(&buffer);
+
+    THEN( "it reads the blocks one after the other, and then ends" ) {
+
+      const std::string read((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+
+      REQUIRE( read == "[{\"a\": 1}, {\"a\": 2}]" );
+      REQUIRE( is.get() == std::char_traits<char>::eof() );
+
+    } // THEN
+
+    THEN( "the JSON library can parse it" ) {
+
+      REQUIRE( json::parse(is) == json::parse("[{\"a\": 1}, {\"a\": 2}]") );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "a StatsWales JSON file can be imported on several threads", "[Areas][WelshStatsJSON]" ) {
+
+  GIVEN( "a file large enough to be split, with values that are overwritten by later rows" ) {
+
+    const std::string text = generatedFile(12000);
+    const BethYw::SourceColumnMapping& cols = BethYw::InputFiles::POPDEN.COLS;
+
+    WHEN( "it is imported on one thread and on four threads" ) {
+
+      const std::unordered_set<std::string> areasFilter = {"W06000001", "W06000004", "AREA 5"};
+      const std::unordered_set<std::string> measuresFilter = {"m0", "m2"};
+      const std::tuple<unsigned int, unsigned int> yearsFilter(1992, 1998);
+
+      MemoryStreamBuffer buffer;
+      buffer.reset(text.data(), text.size());
+      std::istream is(&buffer);
+
+      Areas sequential;
+      sequential.populateFromWelshStatsJSON(is, cols, &areasFilter, &measuresFilter, &yearsFilter);
+
+      Areas parallel;
+      parallel.populateFromWelshStatsJSON(text, cols, &areasFilter, &measuresFilter, &yearsFilter, 4);
+
+      THEN( "the result is the same" ) {
+
+        REQUIRE( sequential.size() == 3 );
+        REQUIRE( parallel.toJSON() == sequential.toJSON() );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "a row in the middle of it is malformed" ) {
+
+      std::string malformed = text;
+      malformed.replace(malformed.find("\"Year_Code\": \"", malformed.size() / 2) + 14, 4, "19x1");
+
+      THEN( "the same error is thrown as on one thread" ) {
+
+        REQUIRE_THROWS_WITH( Areas().populateFromWelshStatsJSON(malformed, cols, nullptr, nullptr, nullptr, 4),
+                             "Year value can not be parsed as a 4 digit year: 19x1" );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "the JSON of a row in the middle of it is malformed" ) {
+
+      std::string malformed = text;
+      malformed.replace(malformed.find("\"Data\": ", malformed.size() / 2), 9, "\"Data\"  ");
+
+      THEN( "the error of the chunk is thrown instead of parsing the file again" ) {
+
+        std::string error;
+        try {
+          Areas().populateFromWelshStatsJSON(malformed, cols, nullptr, nullptr, nullptr, 4);
+        } catch (const std::runtime_error& ex) {
+          error = ex.what();
+        }
+
+        REQUIRE( error.find("Malformed JSON file! ") == 0 );
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "the rows of a StatsWales JSON file imported on several threads are all profiled", "[Areas][Profile]" ) {
+
+  GIVEN( "profiling is turned on and a file large enough to be split" ) {
+
+    BethYw::Profile::enable();
+
+    const std::string text = generatedFile(12000);
+    const std::unordered_set<std::string> areasFilter = {"W06000001", "W06000004"};
+
+    WHEN( "it is imported on one thread and on four threads, each in a phase" ) {
+
+      BethYw::Profile::Phase* oneThread = BethYw::Profile::addPhase("test27 one thread");
+      BethYw::Profile::Phase* fourThreads = BethYw::Profile::addPhase("test27 four threads");
+      REQUIRE( oneThread != nullptr );
+      REQUIRE( fourThreads != nullptr );
+
+      {
+        BethYw::Profile::Scope scope(oneThread);
+        Areas().populateFromWelshStatsJSON(text, BethYw::InputFiles::POPDEN.COLS, &areasFilter, nullptr, nullptr, 1);
+      }
+
+      {
+        BethYw::Profile::Scope scope(fourThreads);
+        Areas().populateFromWelshStatsJSON(text, BethYw::InputFiles::POPDEN.COLS, &areasFilter, nullptr, nullptr, 4);
+      }
+
+      THEN( "the rows parsed on every thread are counted in the phase" ) {
+
+        REQUIRE( oneThread->rowsParsed == 12000 );
+        REQUIRE( fourThreads->rowsParsed == oneThread->rowsParsed );
+        REQUIRE( fourThreads->rowsFilteredOut == oneThread->rowsFilteredOut );
+        REQUIRE( fourThreads->rowsFilteredOut > 0 );
+        REQUIRE( fourThreads->allocations > 0 );
+        REQUIRE( BethYw::Profile::current == nullptr );
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+} // SCENARIO
@@ -0,0 +1,137 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+#include "../areas.h"
+#include "../csv.h"
+#include "../datasets.h"
+
+/*Returns an Authority By Year CSV file with the given number of rows, where every authority comes back every few
+ * hundred rows with other values, and some values are not numbers.*/
+static std::string generatedCsv(unsigned int numRows) {
+  std::string text = "AuthorityCode";
+  for (unsigned int year = 1991; year <= 2020; year++) {
+    text += "," + std::to_string(year);
+  }
+  text += "\r\n";
+
+  for (unsigned int i = 0; i < numRows; i++) {
+    text += "W" + std::to_string(6000000 + i % 997);
+    for (unsigned int year = 1991; year <= 2020; year++) {
+      text += (i + year) % 50 == 0 ? ",n/a" : "," + std::to_string(i * 31 + year) + ".25";
+    }
+    text += i % 2 == 0 ? "\r\n" : "\n";
+  }
+  return text;
+}
+
+SCENARIO( "CSV text can be split into chunks of whole rows", "[CsvTokenizer]" ) {
+
+  GIVEN( "the text of a few rows" ) {
+
+    const std::string text = "a,1\nbb,2\r\nccc,3\ndddd,4";
+
+    WHEN( "it is split into any number of chunks" ) {
+
+      THEN( "the chunks hold every row once, in order" ) {
+
+        for (std::size_t numChunks = 1; numChunks <= 30; numChunks++) {
+          const std::vector<std::string_view> chunks = CsvTokenizer::splitRows(text, numChunks);
+
+          REQUIRE( chunks.size() <= numChunks );
+
+          std::string joined;
+          for (std::size_t i = 0; i < chunks.size(); i++) {
+            if (i + 1 < chunks.size()) {
+              REQUIRE( chunks[i].back() == '\n' );
+            }
+            joined.append(chunks[i]);
+          }
+          REQUIRE( joined == text );
+        }
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "its first row has been read" ) {
+
+      CsvTokenizer csv(text);
+      csv.nextRow();
+
+      THEN( "the position is the beginning of the second row" ) {
+
+        REQUIRE( csv.position() == 4 );
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "an Authority By Year CSV file can be imported on several threads", "[Areas][AuthorityByYearCSV]" ) {
+
+  GIVEN( "a file large enough to be split, whose authorities come back with other values" ) {
+
+    const std::string text = generatedCsv(12000);
+    const BethYw::SourceColumnMapping& cols = BethYw::InputFiles::COMPLETE_POP.COLS;
+
+    WHEN( "it is imported on one thread and on four threads" ) {
+
+      const std::unordered_set<std::string> areasFilter = {"W6000001", "W600009"};
+      const std::tuple<unsigned int, unsigned int> yearsFilter(1995, 2010);
+
+      Areas sequential;
+      sequential.populateFromAuthorityByYearCSV(text, cols, &areasFilter, nullptr, &yearsFilter, 1);
+
+      Areas parallel;
+      parallel.populateFromAuthorityByYearCSV(text, cols, &areasFilter, nullptr, &yearsFilter, 4);
+
+      Areas everything;
+      everything.populateFromAuthorityByYearCSV(text, cols, nullptr, nullptr, nullptr, 4);
+
+      THEN( "the result is the same" ) {
+
+        REQUIRE( sequential.size() > 10 );
+        REQUIRE( parallel.toJSON() == sequential.toJSON() );
+        REQUIRE( everything.size() == 997 );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "a row near the end of it does not have enough values" ) {
+
+      std::string malformed = text;
+      malformed.insert(malformed.size() - 200, "\nW9,1\n");
+
+      THEN( "the same error is thrown as on one thread" ) {
+
+        REQUIRE_THROWS_WITH( Areas().populateFromAuthorityByYearCSV(malformed, cols, nullptr, nullptr, nullptr, 4),
+                             "Not enough values for all years in authority by year CSV file!" );
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+} // SCENARIO
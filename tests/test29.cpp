@@ -0,0 +1,144 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../csv.h"
+
+const CsvTokenizer::Kernel KERNELS[] = {CsvTokenizer::SCALAR, CsvTokenizer::SSE2, CsvTokenizer::AVX2};
+
+/*Returns some text made mostly of short fields and rows, with carriage returns both in line endings and on their
+ * own, empty fields, empty rows and a few rows much longer than the window the tokenizer scans at a time.*/
+static std::string generatedText(std::size_t length) {
+  const char alphabet[] = "ab1.,,,\n\r";
+  std::string text;
+  unsigned long seed = 42;
+  while (text.size() < length) {
+    seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+    if ((seed >> 40) % 5000 == 0) {
+      text += std::string(40000, 'x') + ",y";
+    } else {
+      text += alphabet[(seed >> 33) % (sizeof(alphabet) - 1)];
+    }
+  }
+  return text.substr(0, length);
+}
+
+/*Splits text into rows with std::getline and rows into fields with std::getline, as the CSV parsers used to.*/
+static std::vector<std::vector<std::string>> splitWithGetline(const std::string& text) {
+  std::vector<std::vector<std::string>> rows;
+  std::istringstream lines(text);
+  std::string line;
+  while (std::getline(lines, line)) {
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+
+    std::vector<std::string> fields;
+    std::istringstream row(line);
+    std::string field;
+    while (std::getline(row, field, ',')) {
+      fields.push_back(field);
+    }
+    rows.push_back(fields);
+  }
+  return rows;
+}
+
+/*Splits text into rows and fields with a tokenizer that uses the given kernel.*/
+static std::vector<std::vector<std::string>> splitWithTokenizer(const std::string& text, CsvTokenizer::Kernel kernel) {
+  std::vector<std::vector<std::string>> rows;
+  CsvTokenizer csv(text, kernel);
+  while (csv.nextRow()) {
+    std::vector<std::string> fields;
+    std::string_view field;
+    while (csv.nextField(field)) {
+      fields.push_back(std::string(field));
+    }
+    rows.push_back(fields);
+  }
+  return rows;
+}
+
+SCENARIO( "the vectorised delimiter kernels find the same delimiters as the scalar one", "[CsvTokenizer]" ) {
+
+  GIVEN( "text with delimiters at every offset of a block" ) {
+
+    const std::string text = generatedText(4096);
+
+    THEN( "every kernel the processor supports finds the same positions for any start and length" ) {
+
+      std::vector<std::size_t> expected(text.size());
+      std::vector<std::size_t> positions(text.size());
+
+      for (const CsvTokenizer::Kernel kernel : KERNELS) {
+        if (!CsvTokenizer::supports(kernel)) {
+          continue;
+        }
+
+        for (std::size_t start = 0; start < 70; start++) {
+          for (std::size_t length = 0; length <= 200; length += 7) {
+            const std::size_t numExpected = CsvTokenizer::findDelimiters(text.data() + start, length, 1000,
+                                                                         expected.data(), CsvTokenizer::SCALAR);
+            const std::size_t numFound = CsvTokenizer::findDelimiters(text.data() + start, length, 1000,
+                                                                      positions.data(), kernel);
+
+            REQUIRE( numFound == numExpected );
+            REQUIRE( std::equal(expected.begin(), expected.begin() + numExpected, positions.begin()) );
+          }
+        }
+
+        const std::size_t numFound = CsvTokenizer::findDelimiters(text.data(), text.size(), 0, positions.data(),
+                                                                  kernel);
+        for (std::size_t i = 0; i < numFound; i++) {
+          REQUIRE( (text[positions[i]] == ',' || text[positions[i]] == '\n' || text[positions[i]] == '\r') );
+        }
+
+      }
+
+      REQUIRE( CsvTokenizer::supports(CsvTokenizer::bestKernel()) );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "a CsvTokenizer splits text the same way with every kernel as std::getline did", "[CsvTokenizer]" ) {
+
+  GIVEN( "text with long rows, lone carriage returns, empty fields and empty rows" ) {
+
+    const std::string text = generatedText(300000);
+    const std::vector<std::vector<std::string>> expected = splitWithGetline(text);
+
+    THEN( "the rows and fields are the same" ) {
+
+      REQUIRE( expected.size() > 1000 );
+
+      for (const CsvTokenizer::Kernel kernel : KERNELS) {
+        if (CsvTokenizer::supports(kernel)) {
+          REQUIRE( splitWithTokenizer(text, kernel) == expected );
+          REQUIRE( splitWithTokenizer(text + "\r\n", kernel) == splitWithGetline(text + "\r\n") );
+          REQUIRE( splitWithTokenizer(text.substr(0, 12345), kernel) == splitWithGetline(text.substr(0, 12345)) );
+        }
+      }
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
@@ -0,0 +1,144 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+#include "../areas.h"
+#include "../bethyw.h"
+#include "../datasets.h"
+
+/*A memory resource that counts the allocations made from it, and leaves them to the heap.*/
+class CountingResource : public std::pmr::memory_resource {
+public:
+  std::size_t allocations = 0;
+
+private:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+    allocations++;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+SCENARIO( "an Areas object can allocate everything it holds from an arena", "[Areas][arena]" ) {
+
+  GIVEN( "an arena and an Areas object constructed with it" ) {
+
+    std::pmr::synchronized_pool_resource arena;
+    Areas areas(&arena);
+
+    WHEN( "every dataset is loaded into it and into an Areas object without an arena" ) {
+
+      std::vector<BethYw::InputFileSource> datasets;
+      BethYw::addAllDatasets(datasets);
+      const std::unordered_set<std::string> noFilter;
+      const std::tuple<unsigned int, unsigned int> allYears(0, 0);
+
+      BethYw::loadAreas(areas, "datasets/", noFilter);
+      BethYw::loadDatasets(areas, "datasets/", datasets, noFilter, noFilter, allYears, 2);
+
+      Areas heap;
+      BethYw::loadAreas(heap, "datasets/", noFilter);
+      BethYw::loadDatasets(heap, "datasets/", datasets, noFilter, noFilter, allYears, 2);
+
+      THEN( "the data is the same" ) {
+
+        REQUIRE( areas.size() == heap.size() );
+        REQUIRE( areas.toJSON() == heap.toJSON() );
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+  GIVEN( "an Areas object constructed with a memory resource that counts its allocations" ) {
+
+    CountingResource resource;
+    Areas areas(&resource);
+
+    WHEN( "an Area holding a Measure allocated from the heap is added to it" ) {
+
+      Measure measure("pop", "Population");
+      measure.setValue(2010, 1.5);
+
+      Area area("W06000011");
+      area.setName("eng", "Swansea");
+      area.setMeasure("pop", measure);
+
+      areas.setArea("W06000011", area);
+      const std::size_t afterCopy = resource.allocations;
+
+      Area& copy = areas.getArea("W06000011");
+      for (unsigned int year = 1990; year < 2010; year++) {
+        copy.getMeasure("pop").setValue(year, year);
+      }
+
+      THEN( "its copy, and the values added to it later, are allocated from the resource" ) {
+
+        //the hash table of areas and its node, the map of names, the map of measures and the values of the measure
+        REQUIRE( afterCopy >= 5 );
+        REQUIRE( resource.allocations > afterCopy );
+        REQUIRE( copy.getMeasure("pop").getValue(2010) == 1.5 );
+        REQUIRE( copy.getName("eng") == "Swansea" );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "areas with codes and names too long to be stored inside a string are added to it" ) {
+
+      const std::string longName = "Swansea, the second largest city in Wales";
+
+      std::size_t before = resource.allocations;
+      areas.upsertValue("W06000011", longName, "pop", "Population", 2010, 1);
+      const std::size_t shortCode = resource.allocations - before;
+
+      before = resource.allocations;
+      areas.upsertValue("W06000011-WITH-A-LONG-SUFFIX", longName, "pop", "Population", 2010, 1);
+      const std::size_t longCode = resource.allocations - before;
+
+      Area& area = areas.getArea("W06000011-WITH-A-LONG-SUFFIX");
+      before = resource.allocations;
+      area.setName("cym", "Abertawe, ail ddinas fwyaf Cymru");
+      const std::size_t newName = resource.allocations - before;
+
+      THEN( "the codes and names are allocated from the resource as well" ) {
+
+        //the key of the area and its own code
+        REQUIRE( longCode == shortCode + 2 );
+        //the node of the name and the name itself
+        REQUIRE( newName == 2 );
+        REQUIRE( area.getLocalAuthorityCode() == "W06000011-WITH-A-LONG-SUFFIX" );
+        REQUIRE( area.getName("eng") == longName );
+        REQUIRE( area.getName("cym") == "Abertawe, ail ddinas fwyaf Cymru" );
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+} // SCENARIO
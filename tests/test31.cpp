@@ -0,0 +1,163 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <memory_resource>
+#include <string>
+#include <utility>
+
+#include "../areas.h"
+
+/*Returns an Area with an English name and a measure with a value for each of the given years, which are the year
+ * plus the offset.*/
+static Area areaWithValues(const std::string& code, const std::string& name, const std::string& measureCode,
+                           unsigned int firstYear, unsigned int lastYear, double offset,
+                           const Area::allocator_type& alloc = Area::allocator_type()) {
+  Area area(code, alloc);
+  area.setName("eng", name);
+
+  Measure measure(measureCode, "Label of " + measureCode, alloc);
+  for (unsigned int year = firstYear; year <= lastYear; year++) {
+    measure.setValue(year, year + offset);
+  }
+  area.setMeasure(measureCode, std::move(measure));
+
+  return area;
+}
+
+SCENARIO( "Area and Measure objects can be merged by moving instead of copying", "[Area][Measure][merge]" ) {
+
+  GIVEN( "two Measure objects with overlapping years" ) {
+
+    Measure first("pop", "Population");
+    first.setValue(2000, 1);
+    first.setValue(2001, 2);
+
+    Measure second("pop", "Population");
+    second.setValue(2001, 20);
+    second.setValue(2002, 30);
+
+    WHEN( "one is merged into the other by moving and by copying" ) {
+
+      Measure copied = first;
+      copied = second;
+
+      Measure moved = first;
+      moved.mergeFrom(std::move(second));
+
+      Measure empty("pop", "Population");
+      empty.mergeFrom(Measure(moved));
+
+      THEN( "the result is the same" ) {
+
+        REQUIRE( moved == copied );
+        REQUIRE( empty == copied );
+        REQUIRE( empty.getValue(2001) == 20 );
+        REQUIRE( empty.size() == 3 );
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+  GIVEN( "two Area objects with a measure in common and a measure each" ) {
+
+    std::pmr::synchronized_pool_resource arena;
+
+    WHEN( "one is merged into the other by moving, with the same and with other allocators, and by copying" ) {
+
+      Area copied = areaWithValues("W06000011", "Swansea", "pop", 1990, 2000, 0);
+      copied.setMeasure("area", Measure("area", "Area"));
+      copied = areaWithValues("W06000011", "Abertawe", "pop", 1995, 2005, 0.5);
+
+      Area sameAllocator = areaWithValues("W06000011", "Swansea", "pop", 1990, 2000, 0, &arena);
+      sameAllocator.setMeasure("area", Measure("area", "Area"));
+      Area source = areaWithValues("W06000011", "Abertawe", "pop", 1995, 2005, 0.5, &arena);
+      source.setMeasure("dens", Measure("dens", "Density"));
+      const Measure* density = &source.getMeasure("dens");
+      sameAllocator.mergeFrom(std::move(source));
+
+      Area otherAllocator = areaWithValues("W06000011", "Swansea", "pop", 1990, 2000, 0);
+      otherAllocator.setMeasure("area", Measure("area", "Area"));
+      otherAllocator.mergeFrom(areaWithValues("W06000011", "Abertawe", "pop", 1995, 2005, 0.5, &arena));
+
+      copied.setMeasure("dens", Measure("dens", "Density"));
+      otherAllocator.setMeasure("dens", Measure("dens", "Density"));
+
+      THEN( "the result is the same, and the measures are moved over as they are when they can be" ) {
+
+        REQUIRE( sameAllocator == copied );
+        REQUIRE( otherAllocator == copied );
+        REQUIRE( copied.getName("eng") == "Abertawe" );
+        REQUIRE( copied.getMeasure("pop").getValue(1992) == 1992 );
+        REQUIRE( copied.getMeasure("pop").getValue(1998) == 1998.5 );
+        REQUIRE( &sameAllocator.getMeasure("dens") == density );
+        REQUIRE( source.size() == 0 );
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "Areas objects can be merged by moving instead of copying", "[Areas][merge]" ) {
+
+  GIVEN( "a target and a shard that allocate from the same arena, with an area in common" ) {
+
+    std::pmr::synchronized_pool_resource arena;
+    Areas target(&arena);
+    target.setArea("W06000011", areaWithValues("W06000011", "Swansea", "pop", 1990, 2000, 0));
+
+    Areas shard = std::move(target.makeShards(1)[0]);
+    shard.setArea("W06000011", areaWithValues("W06000011", "Abertawe", "pop", 1995, 2005, 0.5));
+    shard.setArea("W06000015", areaWithValues("W06000015", "Cardiff", "pop", 1990, 2000, 0));
+
+    Areas expected;
+    expected.merge(target);
+    expected.merge(shard);
+
+    WHEN( "the shard is moved into the target" ) {
+
+      const Area* cardiff = &shard.getArea("W06000015");
+      target.merge(std::move(shard));
+
+      THEN( "the result is the same as copying it, and the new area is moved over as it is" ) {
+
+        REQUIRE( target.toJSON() == expected.toJSON() );
+        REQUIRE( &target.getArea("W06000015") == cardiff );
+        REQUIRE( shard.size() == 0 );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "an Area is moved into the target with setArea()" ) {
+
+      Area area = areaWithValues("W06000015", "Cardiff", "pop", 1990, 2000, 0, &arena);
+      const Measure* measure = &area.getMeasure("pop");
+      target.setArea("W06000015", std::move(area));
+
+      THEN( "its measures are moved over as they are" ) {
+
+        REQUIRE( &target.getArea("W06000015").getMeasure("pop") == measure );
+        REQUIRE( target.size() == 2 );
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+} // SCENARIO
@@ -0,0 +1,186 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../areas.h"
+#include "../stats.h"
+
+const StatsTable::Kernel STATS_KERNELS[] = {StatsTable::SCALAR, StatsTable::AVX2};
+
+SCENARIO( "the statistics of a series of values can be computed", "[StatsTable]" ) {
+
+  GIVEN( "a series of three years with a growth of 10% a year" ) {
+
+    const double years[] = {2010, 2011, 2012};
+    const double values[] = {100, 110, 121};
+
+    THEN( "every kernel the processor supports computes its statistics" ) {
+
+      for (const StatsTable::Kernel kernel : STATS_KERNELS) {
+        if (!StatsTable::supports(kernel)) {
+          continue;
+        }
+
+        const MeasureStats stats = StatsTable::computeSeries(years, values, 3, kernel);
+
+        REQUIRE( stats.min == 100 );
+        REQUIRE( stats.max == 121 );
+        REQUIRE( stats.variance == Approx(662.0 / 9) );
+        REQUIRE( stats.standardDeviation == Approx(8.5764535) );
+        REQUIRE( stats.growth == Approx(10) );
+        REQUIRE( stats.slope == Approx(10.5) );
+      }
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "series with no values and with a single value" ) {
+
+    const double years[] = {2010};
+    const double values[] = {-5};
+
+    THEN( "the statistics that can not be computed are 0" ) {
+
+      const MeasureStats empty = StatsTable::computeSeries(years, values, 0, StatsTable::bestKernel());
+      const MeasureStats single = StatsTable::computeSeries(years, values, 1, StatsTable::bestKernel());
+
+      REQUIRE( empty.min == 0 );
+      REQUIRE( empty.max == 0 );
+      REQUIRE( empty.variance == 0 );
+      REQUIRE( single.min == -5 );
+      REQUIRE( single.max == -5 );
+      REQUIRE( single.variance == 0 );
+      REQUIRE( single.growth == 0 );
+      REQUIRE( single.slope == 0 );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "series of every length up to a few registers, with gaps between the years" ) {
+
+    std::vector<double> years;
+    std::vector<double> values;
+    unsigned long seed = 3;
+    for (int i = 0; i < 40; i++) {
+      seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+      years.push_back(1990 + i * 2 + (seed >> 62));
+      values.push_back(((seed >> 20) % 1000000) / 3.0);
+    }
+
+    THEN( "every kernel the processor supports gives exactly the same results as the scalar one" ) {
+
+      for (const StatsTable::Kernel kernel : STATS_KERNELS) {
+        if (!StatsTable::supports(kernel)) {
+          continue;
+        }
+
+        for (std::size_t count = 0; count <= years.size(); count++) {
+          const MeasureStats expected = StatsTable::computeSeries(years.data(), values.data(), count,
+                                                                  StatsTable::SCALAR);
+          const MeasureStats stats = StatsTable::computeSeries(years.data(), values.data(), count, kernel);
+
+          REQUIRE( std::memcmp(&stats, &expected, sizeof(MeasureStats)) == 0 );
+        }
+      }
+
+      REQUIRE( StatsTable::supports(StatsTable::bestKernel()) );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "the statistics of every Measure in an Areas object can be added to the output", "[StatsTable][Areas]" ) {
+
+  GIVEN( "an Areas object with two areas and a measure with a gap between its years" ) {
+
+    Areas areas;
+    areas.upsertValue("W06000011", "Swansea", "pop", "Population", 2010, 100);
+    areas.upsertValue("W06000011", "Swansea", "pop", "Population", 2012, 121);
+    areas.upsertValue("W06000011", "Swansea", "dens", "Density", 2012, 5);
+    areas.upsertValue("W06000015", "Cardiff", "pop", "Population", 2011, 300);
+
+    StatsTable stats;
+    stats.add(areas);
+    stats.compute();
+
+    WHEN( "the statistics of every measure are computed at once" ) {
+
+      THEN( "they are those of the years that have a value" ) {
+
+        const MeasureStats* popStats = stats.find(areas.getArea("W06000011").getMeasure("pop"));
+
+        REQUIRE( stats.size() == 3 );
+        REQUIRE( popStats != nullptr );
+        REQUIRE( popStats->min == 100 );
+        REQUIRE( popStats->max == 121 );
+        REQUIRE( popStats->growth == Approx(10) );
+        REQUIRE( popStats->slope == Approx(10.5) );
+        REQUIRE( stats.find(Measure("pop", "Population")) == nullptr );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "the areas are output as JSON with the statistics" ) {
+
+      std::ostringstream withStats;
+      areas.writeJSON(withStats, &stats);
+
+      THEN( "every area has the statistics of its measures after its names" ) {
+
+        const json parsed = json::parse(withStats.str());
+
+        REQUIRE( parsed["W06000011"]["stats"]["pop"]["min"] == 100 );
+        REQUIRE( parsed["W06000011"]["stats"]["dens"]["sd"] == 0 );
+        REQUIRE( parsed["W06000015"]["stats"]["pop"]["max"] == 300 );
+        REQUIRE( parsed["W06000011"]["measures"] == json::parse(areas.toJSON())["W06000011"]["measures"] );
+        REQUIRE( withStats.str().find("\"names\":{\"eng\":\"Swansea\"},\"stats\":{\"dens\":{\"cagr\":0") !=
+                 std::string::npos );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "the areas are output as tables with the statistics" ) {
+
+      std::ostringstream withStats;
+      areas.writeTables(withStats, &stats);
+
+      std::ostringstream withoutStats;
+      withoutStats << areas;
+
+      THEN( "the tables have a column for each statistic after the differences" ) {
+
+        const std::string expected =
+            "Population (pop) \n"
+            "      2011    Average    Diff.  % Diff.        Min        Max Variance  Std Dev % Growth    Slope \n"
+            "300.000000 300.000000 0.000000 0.000000 300.000000 300.000000 0.000000 0.000000 0.000000 0.000000 \n";
+
+        REQUIRE( withStats.str().find(expected) != std::string::npos );
+        REQUIRE( withoutStats.str().find("% Growth") == std::string::npos );
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+} // SCENARIO
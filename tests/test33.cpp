@@ -0,0 +1,303 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../lib_cxxopts.hpp"
+#include "../lib_cxxopts_argv.hpp"
+
+#include "../areas.h"
+#include "../bethyw.h"
+#include "../intern.h"
+#include "../query.h"
+
+SCENARIO( "the areas can be ranked and their values combined across areas", "[QueryIndex]" ) {
+
+  GIVEN( "a QueryIndex of four areas, one of which has no value for the last year" ) {
+
+    Areas areas;
+    areas.upsertValue("W06000001", "Anglesey", "pop", "Population", 2011, 100);
+    areas.upsertValue("W06000001", "Anglesey", "pop", "Population", 2019, 150);
+    areas.upsertValue("W06000002", "Gwynedd", "pop", "Population", 2011, 400);
+    areas.upsertValue("W06000002", "Gwynedd", "pop", "Population", 2019, 500);
+    areas.upsertValue("W06000003", "Conwy", "pop", "Population", 2011, 200);
+    areas.upsertValue("W06000003", "Conwy", "pop", "Population", 2019, 300);
+    areas.upsertValue("W06000004", "Denbighshire", "pop", "Population", 2011, 1000);
+    areas.upsertValue("W06000004", "Denbighshire", "dens", "Density", 2015, 7);
+
+    QueryIndex index(areas);
+
+    WHEN( "the top areas are found" ) {
+
+      const std::vector<RankedArea> byValue = index.top("pop", Query::VALUE, 2);
+      const std::vector<RankedArea> byChange = index.top("pop", Query::CHANGE, 10);
+      const std::vector<RankedArea> byGrowth = index.top("pop", Query::GROWTH, 1);
+
+      THEN( "they are those with the highest values, leaving out areas without a value" ) {
+
+        REQUIRE( byValue.size() == 2 );
+        REQUIRE( *byValue[0].code == "W06000002" );
+        REQUIRE( byValue[0].value == 500 );
+        REQUIRE( *byValue[1].code == "W06000003" );
+        REQUIRE( byValue[1].rank == 2 );
+        REQUIRE( byValue[1].outOf == 3 );
+
+        REQUIRE( byChange.size() == 3 );
+        REQUIRE( *byChange[0].code == "W06000002" );
+        REQUIRE( *byChange[1].code == "W06000003" );
+        REQUIRE( byChange[1].rank == 1 );
+        REQUIRE( *byChange[2].name == "Anglesey" );
+        REQUIRE( byChange[2].rank == 3 );
+
+        REQUIRE( byGrowth.size() == 1 );
+        REQUIRE( *byGrowth[0].code == "W06000001" );
+        REQUIRE( byGrowth[0].value == 50 );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "an area's value for the first year is 0" ) {
+
+      areas.upsertValue("W06000005", "Flintshire", "pop", "Population", 2011, 0);
+      areas.upsertValue("W06000005", "Flintshire", "pop", "Population", 2019, 80);
+      QueryIndex withZero(areas);
+
+      const std::vector<RankedArea> byGrowth = withZero.top("pop", Query::GROWTH, 10);
+      const std::vector<RankedArea> growthRanks = withZero.rank("pop", Query::GROWTH, {"W06000001", "W06000005"});
+
+      THEN( "it has no percentage change, so it is not ranked by it" ) {
+
+        REQUIRE( byGrowth.size() == 3 );
+        REQUIRE( *byGrowth[0].code == "W06000001" );
+        REQUIRE( byGrowth[0].value == 50 );
+        REQUIRE( byGrowth[0].outOf == 3 );
+
+        REQUIRE( growthRanks.size() == 1 );
+        REQUIRE( *growthRanks[0].code == "W06000001" );
+        REQUIRE( growthRanks[0].rank == 1 );
+        REQUIRE( growthRanks[0].percentile == Approx(200.0 / 3) );
+
+        REQUIRE( withZero.top("pop", Query::CHANGE, 10).size() == 4 );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "the ranks of some areas are found" ) {
+
+      const std::vector<RankedArea> ranks = index.rank("pop", Query::CHANGE, {"W06000001", "W06000003", "W06000004"});
+
+      THEN( "they are ranked among all areas with a value, with equal values sharing a rank" ) {
+
+        REQUIRE( ranks.size() == 2 );
+        REQUIRE( *ranks[0].code == "W06000001" );
+        REQUIRE( ranks[0].rank == 3 );
+        REQUIRE( ranks[0].percentile == Approx(100.0 / 6) );
+        REQUIRE( *ranks[1].code == "W06000003" );
+        REQUIRE( ranks[1].rank == 1 );
+        REQUIRE( ranks[1].percentile == Approx(200.0 / 3) );
+
+        REQUIRE( index.rank("pop", Query::VALUE, {}).size() == 3 );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "the areas are filtered by parts of their codes or names" ) {
+
+      const std::vector<RankedArea> ranks = index.rank("pop", Query::VALUE, {"GWYN", "ONW"});
+      const std::vector<RankedArea> top = index.top("pop", Query::VALUE, 10, {"W06000001", "CONWY"});
+      const Measure sum = index.aggregate("pop", Query::SUM, 50, {"000002", "ANGLESEY"});
+
+      THEN( "the ranks of those areas are found among all areas" ) {
+
+        REQUIRE( ranks.size() == 2 );
+        REQUIRE( *ranks[0].name == "Gwynedd" );
+        REQUIRE( ranks[0].rank == 1 );
+        REQUIRE( *ranks[1].name == "Conwy" );
+        REQUIRE( ranks[1].rank == 2 );
+        REQUIRE( ranks[1].outOf == 3 );
+
+      } // THEN
+
+      THEN( "the top areas and combined values are those of only the areas of the filter" ) {
+
+        REQUIRE( top.size() == 2 );
+        REQUIRE( *top[0].code == "W06000003" );
+        REQUIRE( top[0].rank == 1 );
+        REQUIRE( *top[1].code == "W06000001" );
+        REQUIRE( top[1].outOf == 2 );
+
+        REQUIRE( sum.getValue(2011) == 500 );
+        REQUIRE( sum.getValue(2019) == 650 );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "the values are combined across areas" ) {
+
+      const Measure sum = index.aggregate("pop", Query::SUM);
+      const Measure mean = index.aggregate("pop", Query::MEAN);
+      const Measure median = index.aggregate("pop", Query::PERCENTILE, 50);
+      const Measure p90 = index.aggregate("pop", Query::PERCENTILE, 90);
+
+      THEN( "each year combines the areas that have a value for it" ) {
+
+        REQUIRE( sum.getValue(2011) == 1700 );
+        REQUIRE( sum.getValue(2019) == 950 );
+        REQUIRE( sum.size() == 2 );
+        REQUIRE( mean.getValue(2011) == 425 );
+        REQUIRE( median.getValue(2011) == 300 );
+        REQUIRE( median.getValue(2019) == 300 );
+        REQUIRE( p90.getValue(2011) == Approx(820) );
+        REQUIRE( p90.getValue(2019) == Approx(460) );
+        REQUIRE( sum.getCodename() == "pop" );
+
+      } // THEN
+
+    } // WHEN
+
+    THEN( "a measure no area has can not be queried" ) {
+
+      REQUIRE( index.numAreas() == 4 );
+      REQUIRE( index.codenames() == std::vector<std::string>({"dens", "pop"}) );
+      REQUIRE_THROWS_AS( index.top("area", Query::VALUE, 3), std::out_of_range );
+
+    } // THEN
+
+    WHEN( "the answers are written as JSON" ) {
+
+      Query query;
+      query.top = 1;
+      query.aggregation = Query::SUM;
+
+      std::ostringstream json;
+      index.write(json, query, true);
+
+      THEN( "they are keyed by query and measure" ) {
+
+        REQUIRE( json.str() == "{\"aggregate\":{\"dens\":{\"2015\":7.0},\"pop\":{\"2011\":1700.0,\"2019\":950.0}},"
+                               "\"top\":{\"dens\":[{\"area\":\"W06000004\",\"name\":\"Denbighshire\",\"of\":1,"
+                               "\"percentile\":50.0,\"rank\":1,\"value\":7.0}],"
+                               "\"pop\":[{\"area\":\"W06000002\",\"name\":\"Gwynedd\",\"of\":3,"
+                               "\"percentile\":83.33333333333334,\"rank\":1,\"value\":500.0}]}}" );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "the combined values are written as tables" ) {
+
+      Query query;
+      query.aggregation = Query::PERCENTILE;
+
+      std::ostringstream first;
+      std::ostringstream second;
+      query.percentile = 25;
+      index.write(first, query, false);
+      const std::size_t interned = BethYw::Intern::size();
+      query.percentile = 75;
+      index.write(second, query, false);
+
+      THEN( "each table is headed with how its values were combined, without interning a new label" ) {
+
+        REQUIRE( first.str().rfind("Percentile 25 of Density across areas (dens) \n", 0) == 0 );
+        REQUIRE( second.str().find("Percentile 75 of Population across areas (pop) \n") != std::string::npos );
+        REQUIRE( BethYw::Intern::size() == interned );
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "the query program arguments can be parsed", "[args][QueryIndex]" ) {
+
+  GIVEN( "valid --top, --rank, --aggregate and --by arguments" ) {
+
+    Argv argv({"test", "--top", "10", "--rank", "-a", "w06000011", "--aggregate", "P99.5", "--by", "Growth"});
+    auto** actual_argv = argv.argv();
+    auto argc          = argv.argc();
+
+    auto cxxopts = BethYw::cxxoptsSetup();
+    auto args    = cxxopts.parse(argc, actual_argv);
+
+    THEN( "the queries are parsed" ) {
+
+      const Query query = BethYw::parseQueryArgs(args);
+
+      REQUIRE( query.any() );
+      REQUIRE( query.top == 10 );
+      REQUIRE( query.rank );
+      REQUIRE( query.areas.count("W06000011") == 1 );
+      REQUIRE( query.aggregation == Query::PERCENTILE );
+      REQUIRE( query.percentile == 99.5 );
+      REQUIRE( query.metric == Query::GROWTH );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "invalid query arguments" ) {
+
+    const std::vector<std::vector<std::string>> invalid = {{"test", "--top", "0"}, {"test", "--top", "-3"},
+                                                           {"test", "--aggregate", "p101"},
+                                                           {"test", "--aggregate", "total"},
+                                                           {"test", "--by", "size"}};
+
+    THEN( "an exception is thrown for each of them" ) {
+
+      for (auto it = invalid.begin(); it != invalid.end(); it++) {
+        std::vector<char*> pointers;
+        std::vector<std::string> copies(*it);
+        for (auto copy = copies.begin(); copy != copies.end(); copy++) {
+          pointers.push_back(&(*copy)[0]);
+        }
+        int argc = pointers.size();
+        char** argvData = pointers.data();
+
+        auto cxxopts = BethYw::cxxoptsSetup();
+        auto args    = cxxopts.parse(argc, argvData);
+
+        REQUIRE_THROWS_AS( BethYw::parseQueryArgs(args), std::invalid_argument );
+      }
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "no query arguments" ) {
+
+    Argv argv({"test", "-j"});
+    auto** actual_argv = argv.argv();
+    auto argc          = argv.argc();
+
+    auto cxxopts = BethYw::cxxoptsSetup();
+    auto args    = cxxopts.parse(argc, actual_argv);
+
+    THEN( "no query is asked for" ) {
+
+      REQUIRE_FALSE( BethYw::parseQueryArgs(args).any() );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
@@ -0,0 +1,150 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+#include "../areas.h"
+#include "../bethyw.h"
+#include "../datasets.h"
+#include "../parallel.h"
+
+SCENARIO( "datasets loaded on several threads give the same data as loaded on one", "[parallel][Areas]" ) {
+
+  GIVEN( "every dataset, with and without filters" ) {
+
+    std::vector<BethYw::InputFileSource> datasets;
+    BethYw::addAllDatasets(datasets);
+    const std::unordered_set<std::string> noFilter;
+    const std::unordered_set<std::string> areasFilter = {"W06000011", "W06000024", "W06000015"};
+    const std::unordered_set<std::string> measuresFilter = {"pop", "dens", "all", "rail"};
+    const std::tuple<unsigned int, unsigned int> allYears(0, 0);
+    const std::tuple<unsigned int, unsigned int> someYears(2010, 2015);
+
+    WHEN( "they are loaded in order on one thread and into shards on four threads" ) {
+
+      Areas serial;
+      BethYw::loadAreas(serial, "datasets/", noFilter);
+      BethYw::loadDatasets(serial, "datasets/", datasets, noFilter, noFilter, allYears, 1);
+
+      Areas parallel;
+      BethYw::loadAreas(parallel, "datasets/", noFilter);
+      BethYw::loadDatasets(parallel, "datasets/", datasets, noFilter, noFilter, allYears, 4);
+
+      Areas serialFiltered;
+      BethYw::loadDatasets(serialFiltered, "datasets/", datasets, areasFilter, measuresFilter, someYears, 1);
+
+      Areas parallelFiltered;
+      BethYw::loadDatasets(parallelFiltered, "datasets/", datasets, areasFilter, measuresFilter, someYears, 4);
+
+      THEN( "the merged shards hold the same areas, names, measures and values" ) {
+
+        REQUIRE( serial.size() > 0 );
+        REQUIRE( parallel.size() == serial.size() );
+        REQUIRE( parallel.toJSON() == serial.toJSON() );
+
+        REQUIRE( serialFiltered.size() == 3 );
+        REQUIRE( parallelFiltered.toJSON() == serialFiltered.toJSON() );
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "parallelFor runs every task and rethrows the error of the first failing one", "[parallel]" ) {
+
+  GIVEN( "a hundred tasks, two of which throw an exception" ) {
+
+    const std::size_t count = 100;
+
+    auto run = [&](unsigned int threads, std::vector<std::atomic<int>>& calls) {
+      BethYw::parallelFor(count, threads, [&](std::size_t i) {
+        calls[i]++;
+        if (i == 17 || i == 63) {
+          throw std::runtime_error("task " + std::to_string(i));
+        }
+      });
+    };
+
+    for (unsigned int threads : {1u, 4u}) {
+
+      WHEN( "they are run on " + std::to_string(threads) + " threads" ) {
+
+        std::vector<std::atomic<int>> calls(count);
+        std::string error;
+        try {
+          run(threads, calls);
+        } catch (const std::runtime_error& ex) {
+          error = ex.what();
+        }
+
+        THEN( "the error of the task with the lowest index is the one rethrown" ) {
+
+          REQUIRE( error == "task 17" );
+
+        } // THEN
+
+        THEN( "every task is called once, except those after the error when run in order" ) {
+
+          const std::size_t last = threads == 1 ? 17 : count - 1;
+          for (std::size_t i = 0; i < count; i++) {
+            REQUIRE( calls[i] == (i <= last ? 1 : 0) );
+          }
+
+        } // THEN
+
+      } // WHEN
+
+    }
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "the number of threads is clamped to the number of tasks", "[parallel]" ) {
+
+  GIVEN( "a number of tasks and of threads asked for" ) {
+
+    THEN( "there are never more threads than tasks, and always at least one" ) {
+
+      REQUIRE( BethYw::threadsFor(10, 4) == 4 );
+      REQUIRE( BethYw::threadsFor(3, 8) == 3 );
+      REQUIRE( BethYw::threadsFor(1, 8) == 1 );
+      REQUIRE( BethYw::threadsFor(0, 8) == 1 );
+      REQUIRE( BethYw::threadsFor(0, 0) == 1 );
+
+    } // THEN
+
+    THEN( "asking for 0 threads uses one per core, up to the number of tasks" ) {
+
+      const unsigned int cores = std::thread::hardware_concurrency();
+      const unsigned int expected = cores == 0 ? 1 : cores;
+
+      REQUIRE( BethYw::threadsFor(SIZE_MAX, 0) == expected );
+      REQUIRE( BethYw::threadsFor(1, 0) == 1 );
+      REQUIRE( BethYw::threadsFor(2, 0) == (expected < 2 ? expected : 2) );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
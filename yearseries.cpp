@@ -0,0 +1,469 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains the implementation of the YearSeries class.
+
+  The array always spans exactly from the first to the last year that has a
+  value, as it only grows to cover years that are set, and years without a
+  value hold 0. This keeps front() and back() simple array accesses.
+
+  The sum is the sum of the whole array in ascending order of year, as it was
+  when it was added up on every call. Adding a value after the last year
+  extends that sum by exactly one addition, so the running total is updated
+  in place. Any other change (replacing a value, or a year before the last
+  one) would give a different rounding if the old value were subtracted, so
+  the array is added up again instead, which is no slower than the insertion
+  into the array it comes with.
+*/
+
+#include <cstddef>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "yearseries.h"
+
+/*
+  Construct an empty YearSeries.
+*/
+YearSeries::YearSeries() noexcept : baseYear(0), values(), present(), count(0), total(0) {
+
+}
+
+/*
+  Construct an empty YearSeries whose arrays will be allocated with the given
+  allocator.
+
+  @param alloc
+    The allocator of the arrays
+*/
+YearSeries::YearSeries(const allocator_type& alloc) noexcept : baseYear(0),
+                                                                values(alloc),
+                                                                present(alloc),
+                                                                count(0),
+                                                                total(0) {
+
+}
+
+/*
+  Construct a copy of a YearSeries whose arrays are allocated with the given
+  allocator, e.g. when a Measure is copied into an Area stored in an arena.
+
+  @param other
+    The YearSeries to copy
+
+  @param alloc
+    The allocator of the arrays of the copy
+*/
+YearSeries::YearSeries(const YearSeries& other, const allocator_type& alloc) : baseYear(other.baseYear),
+                                                                               values(other.values, alloc),
+                                                                               present(other.present, alloc),
+                                                                               count(other.count),
+                                                                               total(other.total) {
+
+}
+
+/*
+  Construct a YearSeries by taking over the arrays of another one, which is
+  left empty.
+
+  @param other
+    The YearSeries to move from
+*/
+YearSeries::YearSeries(YearSeries&& other) noexcept : baseYear(other.baseYear),
+                                                      values(std::move(other.values)),
+                                                      present(std::move(other.present)),
+                                                      count(other.count),
+                                                      total(other.total) {
+    other.count = 0;
+    other.total = 0;
+}
+
+/*
+  Construct a YearSeries from another one with the given allocator. The arrays
+  are taken over if the other YearSeries uses the same allocator, and copied
+  otherwise. The other YearSeries is left empty either way.
+
+  @param other
+    The YearSeries to move from
+
+  @param alloc
+    The allocator of the arrays of the new YearSeries
+*/
+YearSeries::YearSeries(YearSeries&& other, const allocator_type& alloc) : baseYear(other.baseYear),
+                                                                          values(std::move(other.values), alloc),
+                                                                          present(std::move(other.present), alloc),
+                                                                          count(other.count),
+                                                                          total(other.total) {
+    other.values.clear();
+    other.present.clear();
+    other.count = 0;
+    other.total = 0;
+}
+
+/*
+  Replace the values of this YearSeries with those of another one, which is
+  left empty. As with the constructor above, the arrays are only taken over
+  if both use the same allocator.
+
+  @param other
+    The YearSeries to move from
+
+  @return
+    A reference to this YearSeries
+*/
+YearSeries& YearSeries::operator=(YearSeries&& other) {
+    if (this != &other) {
+        baseYear = other.baseYear;
+        values = std::move(other.values);
+        present = std::move(other.present);
+        count = other.count;
+        total = other.total;
+
+        other.values.clear();
+        other.present.clear();
+        other.count = 0;
+        other.total = 0;
+    }
+
+    return *this;
+}
+
+/*
+  Check if there is a value for the given year.
+
+  @param year
+    The year to look for
+
+  @return
+    true if a value was set for the year
+*/
+bool YearSeries::contains(int year) const noexcept {
+    return find(year) != nullptr;
+}
+
+/*
+  Find the value for the given year.
+
+  @param year
+    The year to look for
+
+  @return
+    A pointer to the value, or nullptr if no value was set for the year
+*/
+const double* YearSeries::find(int year) const noexcept {
+    /*Subtracting in a wider type, as years far from the base year would overflow an int. Years before the base year
+     * wrap around to very large indexes, which are then out of range too.*/
+    std::size_t index = static_cast<std::size_t>(static_cast<long long>(year) - baseYear);
+
+    if (index < values.size() && present[index]) {
+        return &values[index];
+    }
+
+    return nullptr;
+}
+
+/*
+  Set the value for the given year, replacing any value already set for it.
+  The array is extended at the front or back if the year is outside of it.
+
+  @param year
+    The year to set the value for, from MIN_YEAR to MAX_YEAR
+
+  @param value
+    The value for the year
+
+  @throws
+    std::out_of_range if the year is before MIN_YEAR or after MAX_YEAR, with
+    the message Invalid year <year>
+*/
+void YearSeries::set(int year, double value) {
+    if (year < MIN_YEAR || year > MAX_YEAR) {
+        throw std::out_of_range(std::string("Invalid year ") + std::to_string(year));
+    }
+
+    if (place(year, value)) {
+        total += value;
+    } else {
+        total = addUp();
+    }
+}
+
+/*
+  Set the values of another YearSeries in this one, replacing the values of
+  the years both have. The sum is added up again at most once, rather than
+  for each value that is not appended.
+
+  @param other
+    The YearSeries whose values to set
+*/
+void YearSeries::merge(const YearSeries& other) {
+    bool appendedAll = true;
+
+    for (auto it = other.begin(); it != other.end(); it++) {
+        if (place(it->first, it->second)) {
+            total += it->second;
+        } else {
+            appendedAll = false;
+        }
+    }
+
+    if (!appendedAll) {
+        total = addUp();
+    }
+}
+
+/*Stores the value in the array without updating the sum. Returns true if the year is after the last one (or the
+ * series was empty, in which case the sum is reset to 0), so the sum only needs the value added to it.*/
+bool YearSeries::place(int year, double value) {
+    if (values.empty()) {
+        baseYear = year;
+        values.push_back(value);
+        present.push_back(true);
+        count = 1;
+        total = 0;
+        return true;
+    }
+
+    bool appended = false;
+
+    if (year < baseYear) {
+        std::size_t missing = static_cast<long long>(baseYear) - year;
+        values.insert(values.begin(), missing, 0);
+        present.insert(present.begin(), missing, false);
+        baseYear = year;
+    } else if (static_cast<std::size_t>(static_cast<long long>(year) - baseYear) >= values.size()) {
+        std::size_t newSize = static_cast<long long>(year) - baseYear + 1;
+        values.resize(newSize, 0);
+        present.resize(newSize, false);
+        appended = true;
+    }
+
+    std::size_t index = static_cast<long long>(year) - baseYear;
+    values[index] = value;
+
+    if (!present[index]) {
+        present[index] = true;
+        count++;
+    }
+
+    return appended;
+}
+
+/*
+  Retrieve the number of years that have a value.
+
+  @return
+    The number of years with a value
+*/
+std::size_t YearSeries::size() const noexcept {
+    return count;
+}
+
+/*
+  Check if no year has a value.
+
+  @return
+    true if the series is empty
+*/
+bool YearSeries::empty() const noexcept {
+    return count == 0;
+}
+
+/*
+  Retrieve the earliest year with a value. Must not be called on an empty
+  series.
+
+  @return
+    The earliest year
+*/
+int YearSeries::firstYear() const noexcept {
+    return baseYear;
+}
+
+/*
+  Retrieve the latest year with a value. Must not be called on an empty
+  series.
+
+  @return
+    The latest year
+*/
+int YearSeries::lastYear() const noexcept {
+    return baseYear + static_cast<int>(values.size()) - 1;
+}
+
+/*
+  Retrieve the value of the earliest year. Must not be called on an empty
+  series.
+
+  @return
+    The value of the earliest year
+*/
+double YearSeries::front() const noexcept {
+    return values.front();
+}
+
+/*
+  Retrieve the value of the latest year. Must not be called on an empty
+  series.
+
+  @return
+    The value of the latest year
+*/
+double YearSeries::back() const noexcept {
+    return values.back();
+}
+
+/*
+  Retrieve the sum of the values of all years, as if they were added up in
+  ascending order of year. It is kept up to date by set() and merge(), so
+  this does not walk the array.
+
+  @return
+    The sum of the values, or 0 if the series is empty
+*/
+double YearSeries::sum() const noexcept {
+    return total;
+}
+
+/*
+  Copy the years that have a value and their values into two arrays, in
+  ascending order of year, e.g. for the kernels in stats.cpp. This is the
+  same as iterating over the series, without building a pair for every year.
+
+  @param yearsOut
+    Set to the years; there must be room for size() years
+
+  @param valuesOut
+    Set to the values of the years; there must be room for size() values
+*/
+void YearSeries::copyTo(double* yearsOut, double* valuesOut) const noexcept {
+    std::size_t copied = 0;
+
+    for (std::size_t i = 0; i < values.size(); i++) {
+        if (present[i]) {
+            yearsOut[copied] = baseYear + static_cast<int>(i);
+            valuesOut[copied] = values[i];
+            copied++;
+        }
+    }
+}
+
+/*Adds up the whole array in ascending order of year. Years without a value hold 0, so the array can be added up
+ * without checking the bitmap, giving exactly the same result as adding up only the values.*/
+double YearSeries::addUp() const noexcept {
+    double sum = 0;
+
+    for (std::size_t i = 0; i < values.size(); i++) {
+        sum += values[i];
+    }
+
+    return sum;
+}
+
+/*Returns the first index from the given one (inclusive) that has a value, or the size of the array if there is none.*/
+std::size_t YearSeries::nextPresent(std::size_t index) const noexcept {
+    while (index < present.size() && !present[index]) {
+        index++;
+    }
+
+    return index;
+}
+
+/*
+  Retrieve an iterator to the earliest year with a value.
+
+  @return
+    An iterator to the first (year, value) pair
+*/
+YearSeries::const_iterator YearSeries::begin() const noexcept {
+    return const_iterator(this, 0);
+}
+
+/*
+  Retrieve an iterator past the latest year with a value.
+
+  @return
+    The end iterator
+*/
+YearSeries::const_iterator YearSeries::end() const noexcept {
+    return const_iterator(this, values.size());
+}
+
+/*
+  Overload the == operator for two YearSeries objects. They are equal when
+  they have values for the same years, and these are equal. How far the
+  arrays extend does not matter, so two series filled in a different order
+  still compare equal.
+
+  @param lhs
+    A YearSeries object
+
+  @param rhs
+    A second YearSeries object
+
+  @return
+    true if both have the same years and values
+*/
+bool operator==(const YearSeries& lhs, const YearSeries& rhs) noexcept {
+    if (lhs.count != rhs.count) {
+        return false;
+    }
+
+    for (auto lhsIt = lhs.begin(), rhsIt = rhs.begin(); lhsIt != lhs.end(); lhsIt++, rhsIt++) {
+        if (lhsIt->first != rhsIt->first || lhsIt->second != rhsIt->second) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+YearSeries::const_iterator::const_iterator(const YearSeries* series, std::size_t index) noexcept
+        : series(series),
+          index(series->nextPresent(index)),
+          current() {
+    load();
+}
+
+/*Copies the year and value at the current index into the pair the iterator hands out.*/
+void YearSeries::const_iterator::load() noexcept {
+    if (index < series->values.size()) {
+        current.first = series->baseYear + static_cast<int>(index);
+        current.second = series->values[index];
+    }
+}
+
+YearSeries::const_iterator::reference YearSeries::const_iterator::operator*() const noexcept {
+    return current;
+}
+
+YearSeries::const_iterator::pointer YearSeries::const_iterator::operator->() const noexcept {
+    return &current;
+}
+
+YearSeries::const_iterator& YearSeries::const_iterator::operator++() noexcept {
+    index = series->nextPresent(index + 1);
+    load();
+    return *this;
+}
+
+YearSeries::const_iterator YearSeries::const_iterator::operator++(int) noexcept {
+    const_iterator copy = *this;
+    ++(*this);
+    return copy;
+}
+
+bool YearSeries::const_iterator::operator==(const const_iterator& other) const noexcept {
+    return series == other.series && index == other.index;
+}
+
+bool YearSeries::const_iterator::operator!=(const const_iterator& other) const noexcept {
+    return !(*this == other);
+}
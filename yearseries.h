@@ -0,0 +1,125 @@
+#ifndef YEARSERIES_H_
+#define YEARSERIES_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 965337
+
+  This file contains the declaration of the YearSeries class, the container
+  Measure uses to store its values by year.
+ */
+
+#include <cstddef>
+#include <iterator>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+/*
+  A YearSeries maps years to values, like a std::map<int, double> would, but
+  stores the values in one contiguous array indexed by (year - first year),
+  with a bitmap marking which years actually have a value. The years in the
+  datasets are small contiguous ranges, so this needs 8 bytes and one bit per
+  year instead of a tree node per year, and reading the values in order is a
+  walk over an array rather than over pointers.
+
+  The array grows at either end to cover any year that is set, so its size is
+  the span between the first and last year, not the number of values. Only
+  years from MIN_YEAR to MAX_YEAR can be set, which bounds the array to 10000
+  values however far apart the years are.
+
+  The sum of the values is kept up to date as values are set, so that the
+  summary statistics of a Measure (see measure.cpp) do not have to walk the
+  array every time they are printed.
+
+  The arrays are allocated with a polymorphic allocator, so that a YearSeries
+  in a Measure stored in an arena (see areas.h) is allocated from it too.
+*/
+class YearSeries {
+private:
+    //the year stored at index 0, only meaningful when values is not empty
+    int baseYear;
+    std::pmr::vector<double> values;
+    std::pmr::vector<bool> present;
+    std::size_t count;
+    //the sum of the values, always exactly what addUp() would return
+    double total;
+
+    std::size_t nextPresent(std::size_t index) const noexcept;
+    bool place(int year, double value);
+    double addUp() const noexcept;
+
+public:
+    //the range of years that can be set, i.e. any year of up to 4 digits
+    static constexpr int MIN_YEAR = 0;
+    static constexpr int MAX_YEAR = 9999;
+
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+    /*
+      Iterates over the years that have a value in ascending order, giving
+      std::pair<int, double> (year, value) like iterating a map would. As the
+      pairs are not stored anywhere, the iterator keeps a copy of the current
+      one, and the values can not be changed through it.
+    */
+    class const_iterator {
+    private:
+        const YearSeries* series;
+        std::size_t index;
+        std::pair<int, double> current;
+
+        void load() noexcept;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::pair<int, double>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = const value_type&;
+
+        const_iterator(const YearSeries* series, std::size_t index) noexcept;
+
+        reference operator*() const noexcept;
+        pointer operator->() const noexcept;
+        const_iterator& operator++() noexcept;
+        const_iterator operator++(int) noexcept;
+
+        bool operator==(const const_iterator& other) const noexcept;
+        bool operator!=(const const_iterator& other) const noexcept;
+    };
+
+    YearSeries() noexcept;
+    explicit YearSeries(const allocator_type& alloc) noexcept;
+    YearSeries(const YearSeries& other) = default;
+    YearSeries(const YearSeries& other, const allocator_type& alloc);
+    YearSeries(YearSeries&& other) noexcept;
+    YearSeries(YearSeries&& other, const allocator_type& alloc);
+
+    YearSeries& operator=(const YearSeries& other) = default;
+    YearSeries& operator=(YearSeries&& other);
+
+    bool contains(int year) const noexcept;
+    const double* find(int year) const noexcept;
+    void set(int year, double value);
+    void merge(const YearSeries& other);
+
+    std::size_t size() const noexcept;
+    bool empty() const noexcept;
+
+    int firstYear() const noexcept;
+    int lastYear() const noexcept;
+    double front() const noexcept;
+    double back() const noexcept;
+    double sum() const noexcept;
+    void copyTo(double* yearsOut, double* valuesOut) const noexcept;
+
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+
+    friend bool operator==(const YearSeries& lhs, const YearSeries& rhs) noexcept;
+};
+
+#endif // YEARSERIES_H_